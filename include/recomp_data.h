@@ -2,7 +2,9 @@
 #define __RECOMP_DATA_H__
 
 namespace recomputil {
-    // void init_extended_actor_data();
+    // Registers the object extension exports.
+    void init_extended_actor_data();
+    // Zeroes the extension data of every object slot.
     void reset_actor_data();
 
     void register_data_api_exports();
@@ -160,6 +160,22 @@ namespace recomp {
     InputField& get_input_binding(GameInput input, size_t binding_index, InputDevice device);
     void set_input_binding(GameInput input, size_t binding_index, InputDevice device, InputField value);
 
+    // State of the N64 pad produced by the compiled bindings. The controller and keyboard sticks are kept apart so the
+    // joystick deadzone can be applied to the controller only.
+    struct N64PadState {
+        uint16_t buttons;
+        float joystick_x;
+        float joystick_y;
+        float keyboard_x;
+        float keyboard_y;
+    };
+
+    // Rebuilds the flat table that evaluate_n64_bindings runs from the current N64 button and axis bindings.
+    // Called whenever a binding changes.
+    void compile_n64_bindings();
+    // Evaluates every N64 binding against the latest input snapshot in a single pass.
+    N64PadState evaluate_n64_bindings();
+
     bool get_n64_input(int controller_num, uint16_t* buttons_out, float* x_out, float* y_out);
     void set_rumble(int controller_num, bool);
     void update_rumble();
@@ -178,6 +194,10 @@ namespace recomp {
     void set_gyro_sensitivity(int strength);
     void set_mouse_sensitivity(int strength);
     void set_joystick_deadzone(int strength);
+    // Whether gyro aiming is independent of how often the controller reports gyro samples. On by default. Turning it
+    // off in the config restores the old per-sample behavior.
+    bool get_gyro_rate_independent();
+    void set_gyro_rate_independent(bool enabled);
     void apply_joystick_deadzone(float x_in, float y_in, float* x_out, float* y_out);
     void set_right_analog_suppressed(bool suppressed);
 
@@ -0,0 +1,120 @@
+#ifndef __RECOMP_PROFILER_H__
+#define __RECOMP_PROFILER_H__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct recomp_context;
+
+namespace recomputil {
+    // Cost attribution for everything mods can run on the game thread: the recomputil data API exports, the recompui
+    // exports, UI callbacks and mod events. Every export and event gets a counter that accumulates calls and time for
+    // the current game frame, and the totals of the last ProfilerFrameCount frames are kept in a ring buffer.
+    // Scopes nest, e.g. an export called from a UI callback inside an event, and each counter only gets the time that
+    // wasn't spent in a nested scope so that the counters of a frame add up to the time mods actually took.
+    // Profiling is off by default, in which case a counter costs a single relaxed load per call.
+    enum class ProfileCategory {
+        DataApi,
+        UiApi,
+        UiCallback,
+        Event,
+    };
+
+    constexpr size_t ProfilerFrameCount = 240;
+
+    using ProfileCounterId = uint32_t;
+
+    // Registers a counter for the given export or event name. Counters are never unregistered.
+    ProfileCounterId register_profile_counter(ProfileCategory category, const char* name);
+
+    bool is_profiling_enabled();
+    void set_profiling_enabled(bool enabled);
+
+    // Adds one call that took the given amount of time to a counter in the current frame.
+    void record_profile_sample(ProfileCounterId counter, uint64_t nanoseconds);
+
+    // Moves the totals of the current frame into the ring buffer. Called once per game frame by the patches.
+    void end_profile_frame();
+
+    struct ProfileSummary {
+        std::string name;
+        ProfileCategory category;
+        // Statistics over the frames in the ring buffer.
+        uint32_t frame_count;
+        uint64_t total_calls;
+        uint64_t total_ns;
+        uint64_t max_frame_calls;
+        uint64_t max_frame_ns;
+    };
+
+    // Returns the counters that were called at least once in the ring buffer, sorted by total time.
+    std::vector<ProfileSummary> get_profile_summary();
+
+    // Writes one line per frame and counter that was called in that frame to a CSV file.
+    bool export_profile_csv(const std::filesystem::path& path);
+
+    const char* get_profile_category_name(ProfileCategory category);
+
+    class ProfileScope {
+    private:
+        ProfileCounterId counter;
+        bool active;
+        std::chrono::steady_clock::time_point start;
+        // Time spent in scopes nested in this one, which is left out of this one's counter.
+        uint64_t nested_ns = 0;
+        ProfileScope* parent = nullptr;
+
+        // The innermost active scope of the thread.
+        static inline thread_local ProfileScope* current = nullptr;
+    public:
+        ProfileScope(ProfileCounterId counter) : counter(counter), active(is_profiling_enabled()) {
+            if (active) {
+                parent = current;
+                current = this;
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~ProfileScope() {
+            if (active) {
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                uint64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+                record_profile_sample(counter, elapsed_ns - std::min(nested_ns, elapsed_ns));
+                if (parent != nullptr) {
+                    parent->nested_ns += elapsed_ns;
+                }
+                current = parent;
+            }
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+    };
+
+    // Wraps an export so that every call to it is recorded in its counter. Each export gets its own instantiation,
+    // which means the counter ID is a static instead of having to be looked up on every call.
+    template <void (*Func)(uint8_t* rdram, recomp_context* ctx)>
+    struct ProfiledExport {
+        static inline ProfileCounterId counter = 0;
+
+        static void call(uint8_t* rdram, recomp_context* ctx) {
+            ProfileScope scope{counter};
+            Func(rdram, ctx);
+        }
+    };
+
+    // Registers the counters for the mod events.
+    void init_profiler();
+}
+
+// Registers an export with the runtime, routing calls to it through its profiling counter.
+#define REGISTER_PROFILED_FUNC(category, name)                                                          \
+    recomputil::ProfiledExport<name>::counter = recomputil::register_profile_counter(category, #name); \
+    recomp::overlays::register_base_export(#name, recomputil::ProfiledExport<name>::call)
+
+#endif
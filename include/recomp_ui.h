@@ -115,6 +115,9 @@ namespace recompui {
     void close_prompt();
     bool is_prompt_open();
     void update_mod_list(bool scan_mods = true);
+    // Adds the extension of a mod container format registered with the runtime, e.g. "rtz", to the mod index.
+    // Must be called before the UI is initialized.
+    void register_mod_index_container_type(const std::string& extension);
     void process_game_started();
 
     void apply_color_hack();
@@ -2,12 +2,21 @@
 #define __ZELDA_GAME_H__
 
 #include <cstdint>
+#include <filesystem>
 #include <span>
 #include <vector>
 
 namespace zelda64 {
+    constexpr uint64_t rom_hash = 0x163fd3fc3813f54eULL;
+
     void quicksave_save();
     void quicksave_load();
+    // Takes a rewind point every few frames while enabled. Rewinding past the last quicksave isn't possible.
+    void set_rewind_enabled(bool enabled);
+    void rewind(uint32_t steps);
+    // Savestate files hold the same state as a quicksave, but are written to disk in the background.
+    void savestate_save(const std::filesystem::path& path);
+    void savestate_load(const std::filesystem::path& path);
     std::vector<uint8_t> decompress_sf64(std::span<const uint8_t> compressed_rom);
 };
 
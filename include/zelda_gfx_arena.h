@@ -0,0 +1,29 @@
+#ifndef __ZELDA_GFX_ARENA_H__
+#define __ZELDA_GFX_ARENA_H__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace zelda64 {
+    // Host side of the graphics arena in the patches. The master display list and the matrices of a frame are built in
+    // chunks of RDRAM that the patches request from here as a frame needs more of them, and the display list branches
+    // from one chunk into the next. Chunks are never freed, the patches keep them for every other frame, so what's
+    // allocated is what the heaviest frame so far needed. The patches report how much of the arena every frame used.
+    struct GfxArenaStats {
+        // Bytes of the master display list and matrices used by the last frame.
+        uint32_t frame_dl_bytes;
+        uint32_t frame_mtx_bytes;
+        // The most either of them used in any single frame.
+        uint32_t peak_dl_bytes;
+        uint32_t peak_mtx_bytes;
+        // Chunks allocated so far and their total size.
+        size_t chunk_count;
+        size_t reserved_bytes;
+        // Frames reported since the game started.
+        uint64_t frame_count;
+    };
+
+    GfxArenaStats get_gfx_arena_stats();
+}
+
+#endif
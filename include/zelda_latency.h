@@ -0,0 +1,73 @@
+#ifndef __ZELDA_LATENCY_H__
+#define __ZELDA_LATENCY_H__
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "recomp_input.h"
+
+namespace zelda64 {
+    // End-to-end latency probe that follows a single input from the OS event all the way to the present of the frame
+    // that first reacted to it. A probe is started by a watched input in the event filter and then advanced by each
+    // stage as the input travels through the runtime, the game thread and the renderer. Only one probe is in flight at
+    // a time, so stages never have to figure out which input they're looking at. Probing is off by default, in which
+    // case marking a stage costs a single relaxed load.
+    //
+    // Must be kept in sync with RecompLatencyStage in patches/misc_funcs.h!
+    enum class LatencyStage : uint32_t {
+        // The OS timestamp of the input event. Only has millisecond precision.
+        Event,
+        // The event filter received the event.
+        Filter,
+        // The game's controller read happened while the probed input was held.
+        GameRead,
+        // The graphics thread picked up the new controller state for its next frame.
+        FrameInput,
+        // The graphics thread queued the display list for the frame.
+        TaskQueued,
+        // The renderer started processing that display list.
+        Submit,
+        // The renderer presented the frame.
+        Present,
+        Count
+    };
+
+    constexpr size_t LatencyStageCount = size_t(LatencyStage::Count);
+    constexpr size_t LatencySampleCount = 512;
+
+    bool is_latency_probe_enabled();
+    void set_latency_probe_enabled(bool enabled);
+
+    // Starts a new probe for an event of the given input that happened the given number of milliseconds ago, unless
+    // one is already in flight. Called from the event filter.
+    void begin_latency_probe(uint32_t event_age_ms, const recomp::InputField& input);
+
+    // Gets the input of the probe in flight if it's waiting on the game to read that input. Returns false otherwise.
+    bool get_latency_probe_input(recomp::InputField& input);
+
+    // Advances the probe in flight if it's waiting on the given stage.
+    void mark_latency_stage(LatencyStage stage);
+
+    struct LatencyStageSummary {
+        std::string name;
+        // Time from the previous stage to this one, or the total time for the last summary.
+        double min_ms;
+        double median_ms;
+        double p95_ms;
+        double max_ms;
+    };
+
+    // Returns one summary per stage transition plus one for the total, over the completed probes in the ring buffer.
+    // Empty if no probe completed yet.
+    std::vector<LatencyStageSummary> get_latency_summary();
+    size_t get_latency_sample_count();
+    void clear_latency_samples();
+
+    // Writes one line per completed probe with the time of every stage relative to the input event.
+    bool export_latency_csv(const std::filesystem::path& path);
+}
+
+#endif
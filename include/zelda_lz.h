@@ -0,0 +1,21 @@
+#ifndef __ZELDA_LZ_H__
+#define __ZELDA_LZ_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace zelda64 {
+    // Small LZ77 codec in the style of LZ4's block format, for data that has to be compressed quickly rather than
+    // tightly, like RDRAM deltas. Long runs of zeroes, which is most of an XOR delta, compress into a few bytes.
+
+    // Appends the compressed form of input to output.
+    void lz_compress(std::span<const uint8_t> input, std::vector<uint8_t>& output);
+
+    // Decompresses input into output, which must be exactly the size of the original data. Returns false if the
+    // input is corrupt or doesn't decompress to exactly that size.
+    bool lz_decompress(std::span<const uint8_t> input, std::span<uint8_t> output);
+}
+
+#endif
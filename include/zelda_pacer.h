@@ -0,0 +1,47 @@
+#ifndef __ZELDA_PACER_H__
+#define __ZELDA_PACER_H__
+
+#include <chrono>
+#include <cstdint>
+
+namespace zelda64 {
+    // Frame pacer for the graphics thread. By default the game counts VIs from the runtime's timer thread as it always
+    // has, and the pacer only measures how evenly the frames come out. On Linux the host frame pacing option makes the
+    // game wait for an absolute deadline on the host's monotonic clock instead. The wait sleeps until shortly before the
+    // deadline with clock_nanosleep and TIMER_ABSTIME, so the deadline doesn't drift with the time spent going to sleep,
+    // and then spins for the rest. How late the sleeps wake up is measured on every frame, and the spin margin follows
+    // it, so it stays as short as the OS allows. The host clock isn't tied to the runtime's VI timer, so the two can
+    // drift apart over time, which is why this is opt-in.
+    constexpr uint32_t pacer_vi_rate = 60;
+    constexpr std::chrono::microseconds min_pacer_spin_margin{ 100 };
+    constexpr std::chrono::microseconds max_pacer_spin_margin{ 2000 };
+
+    // Host frame pacing can only be enabled on Linux, elsewhere enabling it does nothing.
+    bool get_host_frame_pacing();
+    void set_host_frame_pacing(bool enabled);
+
+    // With host frame pacing, waits until the end of a frame that lasts the given number of VIs. A frame that ran over
+    // its deadline by more than a whole frame starts a new schedule instead of rushing to catch up. Without it, this
+    // is called once the game has counted the frame's VIs and only records when the frame ended.
+    void pace_frame(uint32_t vis_per_frame);
+
+    struct FramePacingStats {
+        // Time between the ends of consecutive frames over the last second or so.
+        double mean_frame_ms;
+        double frame_stddev_ms;
+        // How late the sleeps wake up on average, and the spin margin derived from it.
+        double sleep_overshoot_us;
+        double spin_margin_us;
+        // The rate the game is actually producing frames at.
+        double measured_rate;
+    };
+
+    FramePacingStats get_frame_pacing_stats();
+
+    // The rate the game is running at for a frame of the given number of VIs. This is the nominal rate unless frames
+    // are consistently taking longer than that, in which case it's the measured rate rounded to the nearest whole
+    // number, so the renderer interpolates for the rate the game is actually delivering.
+    uint32_t get_paced_refresh_rate(uint32_t vis_per_frame);
+}
+
+#endif
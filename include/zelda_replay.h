@@ -0,0 +1,37 @@
+#ifndef __ZELDA_REPLAY_H__
+#define __ZELDA_REPLAY_H__
+
+#include <cstdint>
+#include <filesystem>
+
+namespace zelda64 {
+    // Deterministic input recordings for performance regression runs. A recording holds the pad state the game read on
+    // every frame, run-length encoded, along with the RNG seeds the game takes from the clock when it boots. Replaying
+    // it from boot feeds those back to the game instead of the real inputs, so the same run can be played unattended
+    // on every build. When a replay runs out of inputs it writes a report with the total wall time and the frame times
+    // of every level next to the recording, and then quits. Builds with RECOMP_COUNT_ALLOCATIONS also report the number
+    // of operator new calls per level.
+    enum class InputReplayMode {
+        None,
+        Record,
+        Replay,
+    };
+
+    // Must be called before the game starts. Returns false if the file couldn't be opened or isn't a valid recording.
+    bool start_input_recording(const std::filesystem::path& path);
+    bool start_input_replay(const std::filesystem::path& path);
+
+    // Writes out the last inputs of a recording. Called on shutdown.
+    void finish_input_recording();
+
+    InputReplayMode get_input_replay_mode();
+
+    // Called with the pad state the game is about to read. Records it when recording, or replaces it with the recorded
+    // one when replaying.
+    void process_input_replay_pad(uint16_t* buttons, float* x, float* y);
+
+    // Whether a replay ran out of inputs and the game should be closed.
+    bool is_input_replay_finished();
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef __ZELDA_REWIND_H__
+#define __ZELDA_REWIND_H__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace zelda64 {
+    // Rewind history built on the RDRAM snapshot engine. Every rewind point is stored as the XOR delta of the pages that
+    // changed since the previous point, compressed with the built-in LZ codec. The deltas are mostly zeroes, so a point
+    // usually takes a few kilobytes. Points live in a ring of fixed size, and the oldest ones are dropped to make room
+    // for new ones. The game thread only pays for computing the deltas, since compression happens on a background
+    // thread.
+    //
+    // Like the snapshot engine itself, capturing and rewinding must only happen while every game thread is stopped.
+    // The history shares the engine's snapshot with quicksaves, so it has to be cleared whenever a quicksave is taken.
+    constexpr size_t default_rewind_budget = 48 * 1024 * 1024;
+    // Number of VIs between rewind points.
+    constexpr uint32_t default_rewind_interval = 2;
+
+    void set_rewind_budget(size_t bytes);
+    size_t get_rewind_budget();
+    void set_rewind_interval(uint32_t vis);
+    uint32_t get_rewind_interval();
+
+    // Captures a new rewind point and returns its ID. IDs count up from 0 and start over when the history is cleared.
+    uint64_t capture_rewind_point(uint8_t* rdram);
+
+    // Takes RDRAM back to the given number of rewind points before the latest one, or to the latest one if steps is 0.
+    // The points that were stepped over are removed from the history. Returns false if the history doesn't go back that
+    // far, in which case nothing is changed. On success, point_id is set to the ID of the point RDRAM is now at.
+    bool rewind_rdram(uint8_t* rdram, size_t steps, uint64_t& point_id);
+
+    struct RewindStats {
+        // Number of points that can be rewound to, including the latest one.
+        size_t points;
+        // Memory used by the compressed deltas.
+        size_t bytes_used;
+        // Deltas that are still waiting to be compressed.
+        size_t pending;
+    };
+
+    RewindStats get_rewind_stats();
+
+    // Drops the whole history. The next capture starts a new one.
+    void clear_rewind_history();
+
+    // Stops the compression thread. Must be called before shutting down.
+    void shutdown_rewind();
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef __ZELDA_SAVE_H__
+#define __ZELDA_SAVE_H__
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace zelda64 {
+    // Host backend for the game's EEPROM save. The game hands over its whole save file instead of writing it block by
+    // block through the emulated EEPROM. The backend compares it against a copy of what was last saved, one 8 byte
+    // EEPROM block at a time, and only if any block changed does it schedule a write. Writes are delayed a little so the
+    // game saving several times in a row only results in one, and happen on a background thread. The file is written
+    // to a temporary file and renamed over the old one, and the previous versions are kept as backups.
+    // This file is the only place the game saves to. The emulated EEPROM is only read once, to carry over a save made
+    // before the host backend existed.
+    constexpr size_t eeprom_block_size = 8;
+    constexpr size_t eeprom_block_count = 64;
+    constexpr size_t eeprom_save_size = eeprom_block_size * eeprom_block_count;
+    static_assert(eeprom_block_count <= 64, "Dirty blocks are tracked in a 64-bit mask");
+
+    constexpr std::chrono::milliseconds save_flush_delay{ 500 };
+    constexpr size_t save_backup_count = 2;
+
+    // Reads the save file, or the newest backup that can be read if it's missing or damaged. Returns false if there's
+    // no save yet, e.g. on the first boot after switching from the emulated EEPROM.
+    bool read_save_data(std::span<uint8_t, eeprom_save_size> data);
+
+    // Updates the save and schedules writing it out. Never waits on file I/O, so it's safe to call from the game
+    // thread. Returns false if no block changed since the last write, in which case nothing is scheduled.
+    bool write_save_data(std::span<const uint8_t, eeprom_save_size> data);
+
+    // Writes out any scheduled save right away and stops the save thread. Must be called from the shutdown path once
+    // the game has stopped running.
+    void shutdown_save_backend();
+}
+
+#endif
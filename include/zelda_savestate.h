@@ -0,0 +1,79 @@
+#ifndef __ZELDA_SAVESTATE_H__
+#define __ZELDA_SAVESTATE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace zelda64 {
+    // Savestate files. A file holds a header that identifies the ROM, the saved context of every game thread, and RDRAM
+    // split into chunks that are compressed and checksummed on their own:
+    //
+    //   SavestateHeader
+    //   For every thread: int32 thread ID, uint32 context size, context bytes
+    //   For every chunk: SavestateChunk
+    //   Chunk data
+    //
+    // Writing a state only costs the game thread a copy of RDRAM. Compression and the file I/O happen on a background
+    // thread. Loading maps the file and only decompresses the chunks whose checksum doesn't match what's already in
+    // RDRAM, so loading a state taken shortly before only touches what changed since.
+    constexpr uint32_t savestate_version = 1;
+    constexpr size_t savestate_chunk_size = 64 * 1024;
+
+    struct SavestateHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t thread_count;
+        uint64_t rom_hash;
+        uint32_t rdram_size;
+        uint32_t chunk_size;
+    };
+
+    struct SavestateChunk {
+        uint64_t offset;
+        // A chunk that didn't compress is stored as is, in which case this is the chunk size.
+        uint32_t compressed_size;
+        uint32_t reserved;
+        // Checksum of the uncompressed chunk.
+        uint64_t checksum;
+    };
+
+    // Contexts are stored as they're given, so the file doesn't depend on how the caller represents them.
+    struct SavestateThread {
+        int32_t thread_id;
+        std::vector<uint8_t> context;
+    };
+
+    enum class SavestateError {
+        Success,
+        FailedToOpen,
+        NotASavestate,
+        WrongVersion,
+        WrongRom,
+        Corrupt,
+    };
+
+    // Starts the savestate thread ahead of the first save, which faults in the memory used for copying RDRAM.
+    void init_savestates();
+
+    // Copies RDRAM and queues the state to be written to the given path. The file is replaced once the whole state has
+    // been written, with the previous one kept as a backup.
+    void queue_savestate_write(const std::filesystem::path& path, uint64_t rom_hash, const uint8_t* rdram, std::vector<SavestateThread>&& threads);
+
+    // Whether any queued states haven't been written yet.
+    bool is_savestate_write_pending();
+
+    // Blocks until every queued state has been written. Returns false if any of them failed since the last call.
+    bool wait_for_savestate_writes();
+
+    // Loads a state into RDRAM and returns the contexts it holds. Contexts that aren't context_size bytes long make the
+    // file count as corrupt. RDRAM is only changed if the whole file is valid.
+    SavestateError load_savestate(const std::filesystem::path& path, uint64_t rom_hash, size_t context_size, uint8_t* rdram, std::vector<SavestateThread>& threads);
+
+    // Finishes the queued writes and stops the savestate thread. Must be called before shutting down.
+    void shutdown_savestates();
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef __ZELDA_SNAPSHOT_H__
+#define __ZELDA_SNAPSHOT_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zelda64 {
+    // Incremental RDRAM snapshots. The engine keeps a single copy of RDRAM as of the last capture, and tracks which
+    // pages have been written since then by write protecting them and catching the first write fault on each one. A
+    // capture then only copies the pages that were written into the copy, and a restore only copies those same pages
+    // back, so both cost as much as what changed rather than the whole of RDRAM. Only the first capture copies
+    // everything.
+    //
+    // Platforms where RDRAM can't be write protected fall back to comparing every page against the copy, which still
+    // only copies what changed but has to read all of RDRAM to find it.
+    //
+    // Captures and restores must only happen while every game thread is stopped, e.g. during a quicksave action.
+    // Host code that hands RDRAM to the OS directly (e.g. reading a file straight into it) must not run while
+    // tracking is active, since the kernel doesn't take write faults on behalf of a syscall.
+
+    // Copies every page that changed since the previous capture into the snapshot. The indices of the copied pages are
+    // appended to changed_pages if it isn't null. Returns the number of pages that were copied.
+    size_t capture_rdram_snapshot(uint8_t* rdram, std::vector<uint32_t>* changed_pages = nullptr);
+
+    // Same as capture_rdram_snapshot, but also appends the XOR of the previous and new contents of every copied page to
+    // deltas, in the order of changed_pages. The first capture has nothing to compare against, so it doesn't return any.
+    size_t capture_rdram_snapshot_delta(uint8_t* rdram, std::vector<uint32_t>& changed_pages, std::vector<uint8_t>& deltas);
+
+    // XORs a delta from capture_rdram_snapshot_delta into a page of the snapshot. Applying the deltas of the last capture
+    // takes the snapshot back to its contents before that capture. The page is copied over RDRAM by the next restore.
+    void apply_rdram_snapshot_delta(uint8_t* rdram, uint32_t page, const uint8_t* delta);
+
+    // Copies the snapshot back over every page that changed since it was captured. Returns the number of pages that
+    // were copied, or 0 if there's no snapshot.
+    size_t restore_rdram_snapshot(uint8_t* rdram);
+
+    bool has_rdram_snapshot();
+
+    // The RDRAM contents as of the last capture, valid while a snapshot exists.
+    const uint8_t* get_rdram_snapshot_data();
+
+    // The granularity of the change tracking, which is the OS page size when write protection is available.
+    size_t get_rdram_snapshot_page_size();
+
+    // Whether changes are tracked through write faults rather than by comparing pages.
+    bool is_rdram_write_tracking_active();
+
+    // Removes the write protection, stops tracking and frees the snapshot.
+    void discard_rdram_snapshot(uint8_t* rdram);
+}
+
+#endif
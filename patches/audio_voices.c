@@ -1264,10 +1264,12 @@ RECOMP_PATCH void Game_Update(void) {
         }
 
         Game_Draw(0);
+        Graphics_ArenaCheckpoint(); // @recomp
 
         if (gCamCount == 2) {
             Game_InitViewport(&gMasterDisp, gCamCount, 1);
             Game_Draw(1);
+            Graphics_ArenaCheckpoint(); // @recomp
 
             gDPPipeSync(gMasterDisp++);
             gDPSetScissor(gMasterDisp++, G_SC_NON_INTERLACE, SCREEN_MARGIN, SCREEN_MARGIN, SCREEN_WIDTH - SCREEN_MARGIN,
@@ -1275,12 +1277,15 @@ RECOMP_PATCH void Game_Update(void) {
         } else if ((gCamCount == 4) && (gDrawMode != DRAW_NONE)) {
             Game_InitViewport(&gMasterDisp, gCamCount, 3);
             Game_Draw(3);
+            Graphics_ArenaCheckpoint(); // @recomp
 
             Game_InitViewport(&gMasterDisp, gCamCount, 2);
             Game_Draw(2);
+            Graphics_ArenaCheckpoint(); // @recomp
 
             Game_InitViewport(&gMasterDisp, gCamCount, 1);
             Game_Draw(1);
+            Graphics_ArenaCheckpoint(); // @recomp
 
             gDPPipeSync(gMasterDisp++);
             gDPSetScissor(gMasterDisp++, G_SC_NON_INTERLACE, SCREEN_MARGIN, SCREEN_MARGIN, SCREEN_WIDTH - SCREEN_MARGIN,
@@ -1317,11 +1322,14 @@ RECOMP_PATCH void Game_Update(void) {
                                    gPlayerGlareGreens[0], gPlayerGlareBlues[0], gPlayerGlareAlphas[0]);
             if ((gDrawMode == DRAW_PLAY) || (gDrawMode == DRAW_ENDING)) {
                 Radio_Draw();
+                Graphics_ArenaCheckpoint(); // @recomp
                 if (gShowHud) {
                     HUD_Draw();
                     HUD_EdgeArrows_Update();
+                    Graphics_ArenaCheckpoint(); // @recomp
                 }
                 HUD_DrawBossHealth();
+                Graphics_ArenaCheckpoint(); // @recomp
             }
         } else {
             for (i = 0; i < gCamCount; i++) {
@@ -1341,6 +1349,7 @@ RECOMP_PATCH void Game_Update(void) {
 
         Background_dummy_80040CDC();
         HUD_DrawStatusScreens();
+        Graphics_ArenaCheckpoint(); // @recomp
         AllRange_DrawCountdown();
 
         if ((gGameState == GSTATE_PLAY) && gVersusMode) {
@@ -1,6 +1,7 @@
 
 #include "patches.h"
 #include "sf64audio_external.h"
+#include "misc_funcs.h"
 
 #if 1 // Global scope
 
@@ -708,6 +709,9 @@ RECOMP_PATCH void Play_InitLevel(void) {
     s32 i;
     f32* fptr;
 
+    // @recomp Objects of the previous level are gone, so any extension data mods kept for them is stale.
+    recomputil_reset_object_extension_data();
+
     switch (gCurrentLevel) {
         case LEVEL_TRAINING:
             AUDIO_SET_SPEC(SFX_LAYOUT_DEFAULT, AUDIOSPEC_TR);
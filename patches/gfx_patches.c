@@ -39,24 +39,53 @@ typedef struct AssetInfo {
     /* 0x71 */ u8 unk_71;
 } AssetInfo; // size = 0x72
 
-// @recomp make GfxPool larger
+// @recomp make GfxPool larger, with the master display list and the matrices moved out into the GfxArena
 typedef struct {
     /* 0x00000 */ SPTask task;
     /* 0x000500 */ Vp viewports[0x10 * 0x10];
-    /* 0x001500 */ Mtx mtx[0x480 * 0x10];
-    /* 0x121500 */ Gfx unkDL1[0x180 * 0x10];
-    /* 0x12D500 */ Gfx masterDL[0x1380 * 0x10];
-    /* 0x1C9500 */ Gfx unkDL2[0xD80 * 0x10];
-    /* 0x235500 */ Lightsn lights[0x100 * 0x10];
-} ExGfxPool; // size = 0x2AD500, 0x8 aligned
+    /* 0x001500 */ Gfx unkDL1[0x180 * 0x10];
+    /* 0x00D500 */ Gfx unkDL2[0xD80 * 0x10];
+    /* 0x079500 */ Lightsn lights[0x100 * 0x10];
+} ExGfxPool; // size = 0xF1500, 0x8 aligned
+
+// @recomp The master display list and the matrices of a frame are built in chunks that are requested from the host
+// as the frame needs them. Graphics_ArenaCheckpoint moves on to the next chunk when the current one is running out,
+// ending the display list in the old chunk with a branch to the new one. It's only called where the game is between
+// two draws, so a single draw never spans two chunks and has to fit in the headroom. Every frame has its own list of
+// chunks, which are reused when the frame's ExGfxPool comes around again.
+// The headroom is what's left when a checkpoint passes on a chunk, so it bounds everything drawn between two
+// checkpoints. The matrix headroom is the game's own per-frame matrix pool.
+#define GFX_ARENA_DL_CHUNK_LEN 0x2000 // 64 KiB
+#define GFX_ARENA_DL_HEADROOM 0x1000
+#define GFX_ARENA_MTX_CHUNK_LEN 0x800 // 128 KiB
+#define GFX_ARENA_MTX_HEADROOM 0x480
+#define GFX_ARENA_MAX_CHUNKS 64
+
+typedef struct {
+    Gfx* dlChunks[GFX_ARENA_MAX_CHUNKS];
+    Mtx* mtxChunks[GFX_ARENA_MAX_CHUNKS];
+    s32 dlChunkCount;
+    s32 mtxChunkCount;
+    // The chunks the frame is currently building in.
+    s32 dlChunk;
+    s32 mtxChunk;
+    // How much of the chunks before the current ones the frame used.
+    u32 dlBytes;
+    u32 mtxBytes;
+} GfxArena;
 
 extern OSMesgQueue gControllerMesgQueue;
 extern OSContPad gControllerPress[4];
 extern FrameBuffer gFrameBuffers[3];
 extern Gfx gRcpInitDL[];
+extern s32 sRandSeed1;
+extern s32 sRandSeed2;
+extern s32 sRandSeed3;
 
 ExGfxPool gExGfxPools[2];
 ExGfxPool* gExGfxPool;
+GfxArena gGfxArenas[2];
+GfxArena* gGfxArena;
 
 extern void Graphics_InitializeTask(u32 frameCount);
 extern void Graphics_SetTask(void);
@@ -64,6 +93,107 @@ extern void Main_SetVIMode(void);
 extern int recomp_printf(const char* fmt, ...);
 extern void DrawBorders(void);
 
+// Returns the chunk at the given index of the list, requesting a new one from the host if the list ends right before
+// it. Returns NULL if there's no such chunk and none can be added.
+static void* GfxArena_GetChunk(void** chunks, s32* chunkCount, s32 index, u32 size) {
+    if (index < *chunkCount) {
+        return chunks[index];
+    }
+
+    if ((index != *chunkCount) || (index >= GFX_ARENA_MAX_CHUNKS)) {
+        return NULL;
+    }
+
+    chunks[index] = recomp_alloc_gfx_arena_chunk(size);
+    if (chunks[index] == NULL) {
+        return NULL;
+    }
+
+    (*chunkCount)++;
+    return chunks[index];
+}
+
+static Gfx* GfxArena_GetDLChunk(GfxArena* arena, s32 index) {
+    return GfxArena_GetChunk((void**) arena->dlChunks, &arena->dlChunkCount, index,
+                             GFX_ARENA_DL_CHUNK_LEN * sizeof(Gfx));
+}
+
+static Mtx* GfxArena_GetMtxChunk(GfxArena* arena, s32 index) {
+    return GfxArena_GetChunk((void**) arena->mtxChunks, &arena->mtxChunkCount, index,
+                             GFX_ARENA_MTX_CHUNK_LEN * sizeof(Mtx));
+}
+
+static void GfxArena_Reset(GfxArena* arena) {
+    arena->dlChunk = 0;
+    arena->mtxChunk = 0;
+    arena->dlBytes = 0;
+    arena->mtxBytes = 0;
+
+    gMasterDisp = GfxArena_GetDLChunk(arena, 0);
+    gGfxMtx = GfxArena_GetMtxChunk(arena, 0);
+    if ((gMasterDisp == NULL) || (gGfxMtx == NULL)) {
+        // CRASH
+        *(volatile int*) 0 = 0;
+    }
+}
+
+void Graphics_ArenaCheckpoint(void) {
+    GfxArena* arena = gGfxArena;
+    Gfx* dlStart = arena->dlChunks[arena->dlChunk];
+    Mtx* mtxStart = arena->mtxChunks[arena->mtxChunk];
+    Gfx* nextDL;
+    Mtx* nextMtx;
+
+    // A draw that didn't fit in the headroom has already written past the chunk.
+    if ((gMasterDisp > dlStart + GFX_ARENA_DL_CHUNK_LEN) && (gMasterDisp <= dlStart + 2 * GFX_ARENA_DL_CHUNK_LEN)) {
+        // CRASH
+        *(volatile int*) 0 = 0;
+    }
+    if ((gGfxMtx > mtxStart + GFX_ARENA_MTX_CHUNK_LEN) && (gGfxMtx <= mtxStart + 2 * GFX_ARENA_MTX_CHUNK_LEN)) {
+        // CRASH
+        *(volatile int*) 0 = 0;
+    }
+
+    // Nothing to do if the game is building a display list somewhere else at the moment.
+    if ((gMasterDisp >= dlStart) && (gMasterDisp <= dlStart + GFX_ARENA_DL_CHUNK_LEN) &&
+        (dlStart + GFX_ARENA_DL_CHUNK_LEN - gMasterDisp < GFX_ARENA_DL_HEADROOM)) {
+        nextDL = GfxArena_GetDLChunk(arena, arena->dlChunk + 1);
+        // If no chunk can be added, keep going in this one and let the check at the end of the frame catch it.
+        if ((nextDL != NULL) && (gMasterDisp < dlStart + GFX_ARENA_DL_CHUNK_LEN)) {
+            gSPBranchList(gMasterDisp++, nextDL);
+            arena->dlBytes += (gMasterDisp - dlStart) * sizeof(Gfx);
+            arena->dlChunk++;
+            gMasterDisp = nextDL;
+        }
+    }
+
+    // Matrices are referenced by address, so switching chunks only takes moving the pointer.
+    if ((gGfxMtx >= mtxStart) && (gGfxMtx <= mtxStart + GFX_ARENA_MTX_CHUNK_LEN) &&
+        (mtxStart + GFX_ARENA_MTX_CHUNK_LEN - gGfxMtx < GFX_ARENA_MTX_HEADROOM)) {
+        nextMtx = GfxArena_GetMtxChunk(arena, arena->mtxChunk + 1);
+        if (nextMtx != NULL) {
+            arena->mtxBytes += (gGfxMtx - mtxStart) * sizeof(Mtx);
+            arena->mtxChunk++;
+            gGfxMtx = nextMtx;
+        }
+    }
+}
+
+// Returns whether the frame stayed within its chunks, and reports how much of the arena it used.
+static s32 GfxArena_EndFrame(GfxArena* arena) {
+    Gfx* dlStart = arena->dlChunks[arena->dlChunk];
+    Mtx* mtxStart = arena->mtxChunks[arena->mtxChunk];
+
+    if ((gMasterDisp < dlStart) || (gMasterDisp > dlStart + GFX_ARENA_DL_CHUNK_LEN) || (gGfxMtx < mtxStart) ||
+        (gGfxMtx > mtxStart + GFX_ARENA_MTX_CHUNK_LEN)) {
+        return 0;
+    }
+
+    recomp_report_gfx_arena_usage(arena->dlBytes + (gMasterDisp - dlStart) * sizeof(Gfx),
+                                  arena->mtxBytes + (gGfxMtx - mtxStart) * sizeof(Mtx));
+    return 1;
+}
+
 // @recomp FPS fix, pass Vi's per frame to RT64 for interpolated frames
 RECOMP_PATCH void Graphics_ThreadEntry(void* arg0) {
     u8 i;
@@ -71,12 +201,15 @@ RECOMP_PATCH void Graphics_ThreadEntry(void* arg0) {
     u8 validVIsPerFrame;
 
     Game_Initialize();
+    // @recomp Record or restore the RNG seeds, which Rand_Init takes from the clock, for input replays.
+    recomp_sync_input_replay_seeds(&sRandSeed1, &sRandSeed2, &sRandSeed3);
     osSendMesg(&gSerialThreadMesgQueue, (OSMesg) SI_READ_CONTROLLER, OS_MESG_NOBLOCK);
     Graphics_InitializeTask(gSysFrameCount);
     {
         gSPSegment(gUnkDisp1++, 0, 0);
         gSPDisplayList(gMasterDisp++, gExGfxPool->unkDL1); // @recomp
         Game_Update();
+        Graphics_ArenaCheckpoint(); // @recomp
         gSPEndDisplayList(gUnkDisp1++);
         gSPEndDisplayList(gUnkDisp2++);
         gSPDisplayList(gMasterDisp++, gExGfxPool->unkDL2); // @recomp
@@ -85,10 +218,10 @@ RECOMP_PATCH void Graphics_ThreadEntry(void* arg0) {
         gSPEndDisplayList(gMasterDisp++);
     }
 
-    // @recomp Crash the game if any GfxPool goes out of bounds.
-    if ((gViewport > END_OF_ARRAY(gExGfxPool->viewports)) || (gGfxMtx > END_OF_ARRAY(gExGfxPool->mtx)) ||
-        (gUnkDisp1 > END_OF_ARRAY(gExGfxPool->unkDL1)) || (gMasterDisp > END_OF_ARRAY(gExGfxPool->masterDL)) ||
-        (gUnkDisp2 > END_OF_ARRAY(gExGfxPool->unkDL2)) || (gLight > END_OF_ARRAY(gExGfxPool->lights))) {
+    // @recomp Crash the game if any GfxPool or the GfxArena goes out of bounds.
+    if ((gViewport > END_OF_ARRAY(gExGfxPool->viewports)) || (gUnkDisp1 > END_OF_ARRAY(gExGfxPool->unkDL1)) ||
+        (gUnkDisp2 > END_OF_ARRAY(gExGfxPool->unkDL2)) || (gLight > END_OF_ARRAY(gExGfxPool->lights)) ||
+        !GfxArena_EndFrame(gGfxArena)) {
         // CRASH
         *(volatile int*) 0 = 0;
     }
@@ -101,6 +234,8 @@ RECOMP_PATCH void Graphics_ThreadEntry(void* arg0) {
         MQ_WAIT_FOR_MESG(&gControllerMesgQueue, NULL);
         osSendMesg(&gSerialThreadMesgQueue, (OSMesg) SI_RUMBLE, OS_MESG_NOBLOCK);
         Controller_UpdateInput();
+        // @recomp Mark the frame that picked up the new controller state for the latency probe.
+        recomp_mark_input_latency(RECOMP_LATENCY_STAGE_FRAME_INPUT);
         osSendMesg(&gSerialThreadMesgQueue, (OSMesg) SI_READ_CONTROLLER, OS_MESG_NOBLOCK);
         if (gControllerPress[3].button & U_JPAD) {
             Main_SetVIMode();
@@ -115,13 +250,14 @@ RECOMP_PATCH void Graphics_ThreadEntry(void* arg0) {
             if (gStartNMI == 1) {
                 Graphics_NMIWipe();
             }
+            Graphics_ArenaCheckpoint(); // @recomp
             gSPEndDisplayList(gUnkDisp1++);
             gSPEndDisplayList(gUnkDisp2++);
             gSPDisplayList(gMasterDisp++, gExGfxPool->unkDL2); // @recomp
 
             visPerFrame = MIN(gVIsPerFrame, 4);                                  // @recomp
             validVIsPerFrame = MAX(visPerFrame, gGfxVImesgQueue.validCount + 1); // @recomp
-            gEXSetRefreshRate(gMasterDisp++, 60 / validVIsPerFrame);             // @recomp
+            gEXSetRefreshRate(gMasterDisp++, recomp_get_paced_refresh_rate(validVIsPerFrame)); // @recomp
 
 #if 1
             // Noise
@@ -141,14 +277,19 @@ RECOMP_PATCH void Graphics_ThreadEntry(void* arg0) {
 
         MQ_WAIT_FOR_MESG(&gGfxTaskMesgQueue, NULL);
 
-        // @recomp Crash the game if any GfxPool goes out of bounds.
-        if ((gViewport > END_OF_ARRAY(gExGfxPool->viewports)) || (gGfxMtx > END_OF_ARRAY(gExGfxPool->mtx)) ||
-            (gUnkDisp1 > END_OF_ARRAY(gExGfxPool->unkDL1)) || (gMasterDisp > END_OF_ARRAY(gExGfxPool->masterDL)) ||
-            (gUnkDisp2 > END_OF_ARRAY(gExGfxPool->unkDL2)) || (gLight > END_OF_ARRAY(gExGfxPool->lights))) {
+        // @recomp Stop here for quicksave actions, since the frame's task is done and the next one hasn't started.
+        recomp_handle_quicksave_actions(&gQuicksaveEnterMesgQueue, &gQuicksaveExitMesgQueue);
+
+        // @recomp Crash the game if any GfxPool or the GfxArena goes out of bounds.
+        if ((gViewport > END_OF_ARRAY(gExGfxPool->viewports)) || (gUnkDisp1 > END_OF_ARRAY(gExGfxPool->unkDL1)) ||
+            (gUnkDisp2 > END_OF_ARRAY(gExGfxPool->unkDL2)) || (gLight > END_OF_ARRAY(gExGfxPool->lights)) ||
+            !GfxArena_EndFrame(gGfxArena)) {
             // CRASH
             *(volatile int*) 0 = 0;
         }
         Graphics_SetTask();
+        // @recomp Mark the display list of that frame being handed to the renderer.
+        recomp_mark_input_latency(RECOMP_LATENCY_STAGE_TASK_QUEUED);
 
         if (!gFillScreen) {
             osViSwapBuffer(&gFrameBuffers[(gSysFrameCount - 1) % 3]);
@@ -159,25 +300,41 @@ RECOMP_PATCH void Graphics_ThreadEntry(void* arg0) {
         visPerFrame = MIN(gVIsPerFrame, 4);
         validVIsPerFrame = MAX(visPerFrame, gGfxVImesgQueue.validCount + 1);
 
-        for (i = 0; i < validVIsPerFrame; i++) {
-            MQ_WAIT_FOR_MESG(&gGfxVImesgQueue, NULL);
+        // @recomp Count VIs from the timer thread as usual, unless host frame pacing is enabled. In that case wait for
+        // the end of the frame on the host's frame pacer and drop the VIs that came in meanwhile so they don't count
+        // towards the next frame.
+        if (recomp_get_host_frame_pacing()) {
+            recomp_pace_frame(validVIsPerFrame);
+            while (osRecvMesg(&gGfxVImesgQueue, NULL, OS_MESG_NOBLOCK) != -1) {
+            }
+        } else {
+            for (i = 0; i < validVIsPerFrame; i++) {
+                MQ_WAIT_FOR_MESG(&gGfxVImesgQueue, NULL);
+            }
+            recomp_pace_frame(validVIsPerFrame);
         }
 
         Audio_Update();
+
+        // @recomp Close the profiler's frame for the mod cost counters.
+        recomp_profile_end_frame();
+
+        // @recomp Attribute the frame time to the current level when replaying inputs.
+        recomp_input_replay_end_frame((gGameState == GSTATE_PLAY) ? gCurrentLevel : -1);
     }
 }
 
 // @recomp use gExGfxPool instead of the original GfxPool
 RECOMP_PATCH void Graphics_InitializeTask(u32 frameCount) {
     gExGfxPool = &gExGfxPools[frameCount % 2]; // @recomp
+    gGfxArena = &gGfxArenas[frameCount % 2];   // @recomp
 
-    gGfxTask = &gExGfxPool->task;       // @recomp
-    gViewport = gExGfxPool->viewports;  // @recomp
-    gGfxMtx = gExGfxPool->mtx;          // @recomp
-    gUnkDisp1 = gExGfxPool->unkDL1;     // @recomp
-    gMasterDisp = gExGfxPool->masterDL; // @recomp
-    gUnkDisp2 = gExGfxPool->unkDL2;     // @recomp
+    gGfxTask = &gExGfxPool->task;      // @recomp
+    gViewport = gExGfxPool->viewports; // @recomp
+    gUnkDisp1 = gExGfxPool->unkDL1;    // @recomp
+    gUnkDisp2 = gExGfxPool->unkDL2;    // @recomp
     gLight = gExGfxPool->lights;
+    GfxArena_Reset(gGfxArena); // @recomp Sets gMasterDisp and gGfxMtx
 
     gFrameBuffer = &gFrameBuffers[frameCount % 3];
     gTextureRender = &gTextureRenderBuffer[0];
@@ -204,7 +361,7 @@ RECOMP_PATCH void Graphics_SetTask(void) {
     // Initialize the bootstrap DL to enable the extended gbi and extended rdram
     gEXEnable(bootstrapDLHead++);
     gEXSetRDRAMExtended(bootstrapDLHead++, 1);
-    gSPBranchList(bootstrapDLHead++, gExGfxPool->masterDL);
+    gSPBranchList(bootstrapDLHead++, gGfxArena->dlChunks[0]);
 
     gGfxTask->mesgQueue = &gGfxTaskMesgQueue;
     gGfxTask->msg = (OSMesg) TASK_MESG_2;
@@ -222,7 +379,8 @@ RECOMP_PATCH void Graphics_SetTask(void) {
     gGfxTask->task.t.output_buff_size = (u64*) gAudioHeap;
     // gGfxTask->task.t.data_ptr = (u64*) gExGfxPool->masterDL;                         // @recomp
     gGfxTask->task.t.data_ptr = (u64*) bootstrapDL;                                  // @recomp
-    gGfxTask->task.t.data_size = (gMasterDisp - gExGfxPool->masterDL) * sizeof(Gfx); // @recomp
+    gGfxTask->task.t.data_size =
+        gGfxArena->dlBytes + (gMasterDisp - gGfxArena->dlChunks[gGfxArena->dlChunk]) * sizeof(Gfx); // @recomp
     gGfxTask->task.t.yield_data_ptr = (u64*) &gOSYieldData;
     gGfxTask->task.t.yield_data_size = OS_YIELD_DATA_SIZE;
     osWritebackDCacheAll();
@@ -958,6 +958,7 @@ RECOMP_PATCH void Map_Draw(void) {
 
             // @recomp Pop the transform id.
             gEXPopMatrixGroup(gMasterDisp++, G_MTX_MODELVIEW);
+            Graphics_ArenaCheckpoint(); // @recomp
         }
     }
 
@@ -969,6 +970,7 @@ RECOMP_PATCH void Map_Draw(void) {
 
     for (ptr = D_menu_801CD8A0, i = 0; i < 15; i++, ptr++) {
         Map_Planet_Draw(*ptr);
+        Graphics_ArenaCheckpoint(); // @recomp
     }
 
     // @recomp Tag the transform.
@@ -991,6 +993,7 @@ RECOMP_PATCH void Map_Draw(void) {
         gEXPopMatrixGroup(gMasterDisp++, G_MTX_MODELVIEW);
     }
 
+    Graphics_ArenaCheckpoint(); // @recomp
     Map_BriefingRadio_Update();
 
     if (D_menu_801CEFC4) {
@@ -7,9 +7,37 @@ DECLARE_FUNC(void, recomp_load_overlays, u32 rom, void* ram, u32 size);
 DECLARE_FUNC(void, recomp_puts, const char* data, u32 size);
 DECLARE_FUNC(void, recomp_exit);
 DECLARE_FUNC(void, recomp_handle_quicksave_actions, OSMesgQueue* enter_mq, OSMesgQueue* exit_mq);
-DECLARE_FUNC(void, recomp_handle_quicksave_actions_main, OSMesgQueue* enter_mq, OSMesgQueue* exit_mq);
+DECLARE_FUNC(s32, recomp_handle_quicksave_actions_main, OSMesgQueue* enter_mq, OSMesgQueue* exit_mq);
 DECLARE_FUNC(u16, recomp_get_pending_warp);
 DECLARE_FUNC(u32, recomp_get_pending_set_time);
 DECLARE_FUNC(s32, recomp_get_film_grain_enabled);
+DECLARE_FUNC(void, recomputil_clear_object_extension_data, u32 object_type, u32 index);
+DECLARE_FUNC(void, recomputil_reset_object_extension_data);
+
+// Mod events that are timed by the profiler. Must be kept in sync with profile_event_names in src/game/recomp_profiler.cpp!
+typedef enum {
+    RECOMP_PROFILE_EVENT_ON_INIT,
+} RecompProfileEvent;
+
+DECLARE_FUNC(void, recomp_profile_event_begin, u32 event);
+DECLARE_FUNC(void, recomp_profile_event_end, u32 event);
+DECLARE_FUNC(void, recomp_profile_end_frame);
+
+// Stages of the input latency probe that happen in the patches. Must be kept in sync with LatencyStage in include/zelda_latency.h!
+typedef enum {
+    RECOMP_LATENCY_STAGE_FRAME_INPUT = 3,
+    RECOMP_LATENCY_STAGE_TASK_QUEUED = 4,
+} RecompLatencyStage;
+
+DECLARE_FUNC(void, recomp_mark_input_latency, u32 stage);
+DECLARE_FUNC(void, recomp_sync_input_replay_seeds, s32* seed1, s32* seed2, s32* seed3);
+DECLARE_FUNC(void, recomp_input_replay_end_frame, s32 level);
+DECLARE_FUNC(s32, recomp_read_save_file, void* save);
+DECLARE_FUNC(void, recomp_write_save_file, void* save);
+DECLARE_FUNC(void, recomp_pace_frame, u32 vis_per_frame);
+DECLARE_FUNC(s32, recomp_get_host_frame_pacing);
+DECLARE_FUNC(s32, recomp_get_paced_refresh_rate, u32 vis_per_frame);
+DECLARE_FUNC(void*, recomp_alloc_gfx_arena_chunk, u32 size);
+DECLARE_FUNC(void, recomp_report_gfx_arena_usage, u32 dl_bytes, u32 mtx_bytes);
 
 #endif
@@ -0,0 +1,112 @@
+#include "patches.h"
+#include "misc_funcs.h"
+
+// Keeps the object extension data from recomputil in sync with the game's object arrays. Every object is set up by
+// its *_Initialize function when it spawns and most objects are removed through Object_Kill, so clearing the extension
+// data in both places ensures mods never see data left behind by a previous occupant of the slot.
+
+// Must be kept in sync with object_slot_counts in src/game/recomp_actor_api.cpp!
+_Static_assert(ARRAY_COUNT(gActors) == 60, "gActors size changed");
+_Static_assert(ARRAY_COUNT(gBosses) == 4, "gBosses size changed");
+_Static_assert(ARRAY_COUNT(gEffects) == 100, "gEffects size changed");
+_Static_assert(ARRAY_COUNT(gItems) == 20, "gItems size changed");
+_Static_assert(ARRAY_COUNT(gScenery) == 50, "gScenery size changed");
+
+typedef enum {
+    /* 0 */ OBJECT_EXTENSION_ACTOR,
+    /* 1 */ OBJECT_EXTENSION_BOSS,
+    /* 2 */ OBJECT_EXTENSION_EFFECT,
+    /* 3 */ OBJECT_EXTENSION_ITEM,
+    /* 4 */ OBJECT_EXTENSION_SCENERY,
+} ObjectExtensionType;
+
+#define CLEAR_IF_IN_ARRAY(type, array, obj)                                             \
+    if (((u32) (obj) >= (u32) &array[0].obj) &&                                         \
+        ((u32) (obj) < (u32) &array[ARRAY_COUNT(array)])) {                             \
+        recomputil_clear_object_extension_data(                                         \
+            type, ((u32) (obj) - (u32) &array[0].obj) / sizeof(array[0]));              \
+        return;                                                                         \
+    }
+
+static void Object_ClearExtensionData(Object* obj) {
+    CLEAR_IF_IN_ARRAY(OBJECT_EXTENSION_ACTOR, gActors, obj);
+    CLEAR_IF_IN_ARRAY(OBJECT_EXTENSION_BOSS, gBosses, obj);
+    CLEAR_IF_IN_ARRAY(OBJECT_EXTENSION_EFFECT, gEffects, obj);
+    CLEAR_IF_IN_ARRAY(OBJECT_EXTENSION_ITEM, gItems, obj);
+    CLEAR_IF_IN_ARRAY(OBJECT_EXTENSION_SCENERY, gScenery, obj);
+}
+
+RECOMP_PATCH void Object_Kill(Object* obj, f32* sfxSrc) {
+    obj->status = OBJ_FREE;
+    Audio_KillSfxBySource(sfxSrc);
+
+    // @recomp Clear the extension data of the object.
+    Object_ClearExtensionData(obj);
+}
+
+RECOMP_PATCH void Scenery_Initialize(Scenery* this) {
+    s32 i;
+    u8* ptr = (u8*) this;
+
+    for (i = 0; i < sizeof(Scenery); i++, ptr++) {
+        *ptr = 0;
+    }
+
+    // @recomp Clear the extension data of the object.
+    Object_ClearExtensionData(&this->obj);
+}
+
+RECOMP_PATCH void Actor_Initialize(Actor* this) {
+    s32 i;
+    u8* ptr = (u8*) this;
+
+    for (i = 0; i < sizeof(Actor); i++, ptr++) {
+        *ptr = 0;
+    }
+
+    this->scale = 1.0f;
+
+    // @recomp Clear the extension data of the object.
+    Object_ClearExtensionData(&this->obj);
+}
+
+RECOMP_PATCH void Boss_Initialize(Boss* this) {
+    s32 i;
+    u8* ptr = (u8*) this;
+
+    for (i = 0; i < sizeof(Boss); i++, ptr++) {
+        *ptr = 0;
+    }
+
+    this->scale = 1.0f;
+
+    // @recomp Clear the extension data of the object.
+    Object_ClearExtensionData(&this->obj);
+}
+
+RECOMP_PATCH void Item_Initialize(Item* this) {
+    s32 i;
+    u8* ptr = (u8*) this;
+
+    for (i = 0; i < sizeof(Item); i++, ptr++) {
+        *ptr = 0;
+    }
+
+    // @recomp Clear the extension data of the object.
+    Object_ClearExtensionData(&this->obj);
+}
+
+RECOMP_PATCH void Effect_Initialize(Effect* this) {
+    s32 i;
+    u8* ptr = (u8*) this;
+
+    for (i = 0; i < sizeof(Effect); i++, ptr++) {
+        *ptr = 0;
+    }
+
+    this->scale2 = 1.0f;
+    this->scale1 = 1.0f;
+
+    // @recomp Clear the extension data of the object.
+    Object_ClearExtensionData(&this->obj);
+}
@@ -79,6 +79,7 @@ RECOMP_PATCH void Object_DrawAll(s32 cullDirection) {
 
                 // @recomp Pop the transform id.
                 gEXPopMatrixGroup(gMasterDisp++, G_MTX_MODELVIEW);
+                Graphics_ArenaCheckpoint(); // @recomp
             }
         }
     } else {
@@ -107,6 +108,7 @@ RECOMP_PATCH void Object_DrawAll(s32 cullDirection) {
 
                 // @recomp Pop the transform id.
                 gEXPopMatrixGroup(gMasterDisp++, G_MTX_MODELVIEW);
+                Graphics_ArenaCheckpoint(); // @recomp
 
                 Object_UpdateSfxSource(scenery->sfxSource);
             }
@@ -141,6 +143,7 @@ RECOMP_PATCH void Object_DrawAll(s32 cullDirection) {
 
             // @recomp Pop the transform id.
             gEXPopMatrixGroup(gMasterDisp++, G_MTX_MODELVIEW);
+            Graphics_ArenaCheckpoint(); // @recomp
 
             if (boss->drawShadow && (D_edisplay_801615D0.y > 0.0f)) {
                 Matrix_Push(&gGfxMatrix);
@@ -180,6 +183,7 @@ RECOMP_PATCH void Object_DrawAll(s32 cullDirection) {
 
             // @recomp Pop the transform id.
             gEXPopMatrixGroup(gMasterDisp++, G_MTX_MODELVIEW);
+            Graphics_ArenaCheckpoint(); // @recomp
         }
     }
 
@@ -248,6 +252,7 @@ RECOMP_PATCH void Object_DrawAll(s32 cullDirection) {
             }
             // @recomp Pop the transform id.
             gEXPopMatrixGroup(gMasterDisp++, G_MTX_MODELVIEW);
+            Graphics_ArenaCheckpoint(); // @recomp
         }
     }
 
@@ -276,6 +281,7 @@ RECOMP_PATCH void Object_DrawAll(s32 cullDirection) {
             Matrix_Pop(&gGfxMatrix);
             // @recomp Pop the transform id.
             gEXPopMatrixGroup(gMasterDisp++, G_MTX_MODELVIEW);
+            Graphics_ArenaCheckpoint(); // @recomp
         }
     }
 
@@ -372,6 +378,7 @@ RECOMP_PATCH void Effect_DrawAll(s32 arg0) {
             }
             // @recomp Pop the transform id.
             gEXPopMatrixGroup(gMasterDisp++, G_MTX_MODELVIEW);
+            Graphics_ArenaCheckpoint(); // @recomp
         }
     }
 
@@ -401,6 +408,7 @@ RECOMP_PATCH void Effect_DrawAll(s32 arg0) {
 
             // @recomp Pop the transform id.
             gEXPopMatrixGroup(gMasterDisp++, G_MTX_MODELVIEW);
+            Graphics_ArenaCheckpoint(); // @recomp
         }
     }
 }
@@ -166,5 +166,11 @@ float recomp_get_target_aspect_ratio(float);
 // bool camera_was_skipped();
 
 void recomp_crash(const char* err);
+void Graphics_ArenaCheckpoint(void);
+
+extern OSMesgQueue gQuicksaveEnterMesgQueue;
+extern OSMesgQueue gQuicksaveExitMesgQueue;
+void Quicksave_InitMesgQueues(void);
+void Quicksave_WakeThreads(void);
 
 #endif
@@ -0,0 +1,109 @@
+#include "patches.h"
+#include "misc_funcs.h"
+
+// @recomp Quicksaves need every permanent thread stopped at a known point, so each thread loop calls
+// recomp_handle_quicksave_actions once per iteration at a point where it isn't waiting on another thread or on an RSP
+// task. The main thread calls recomp_handle_quicksave_actions_main from its own loop and keeps forwarding VIs and task
+// completions until all of them have entered, since the audio and graphics threads need those to get there.
+// The graphics thread's call is in Graphics_ThreadEntry and the main thread's in Main_ThreadEntry.
+
+// Sent to the serial thread to wake it up for a quicksave action. It isn't one of the SI_ messages, so the thread
+// doesn't do anything else with it.
+#define SI_QUICKSAVE_WAKE 0x7F
+
+void Timer_CompleteTask(void* task);
+
+OSMesgQueue gQuicksaveEnterMesgQueue;
+OSMesg gQuicksaveEnterMesgBuf[8];
+OSMesgQueue gQuicksaveExitMesgQueue;
+OSMesg gQuicksaveExitMesgBuf[8];
+
+void Quicksave_InitMesgQueues(void) {
+    osCreateMesgQueue(&gQuicksaveEnterMesgQueue, gQuicksaveEnterMesgBuf, ARRAY_COUNT(gQuicksaveEnterMesgBuf));
+    osCreateMesgQueue(&gQuicksaveExitMesgQueue, gQuicksaveExitMesgBuf, ARRAY_COUNT(gQuicksaveExitMesgBuf));
+}
+
+// Called by the main thread when it starts gathering the other threads for a quicksave action. The audio and
+// graphics threads get there on their own every frame, but the timer and serial threads only run when they're sent
+// something, so they get a message that only takes them to their handlers.
+void Quicksave_WakeThreads(void) {
+    osSendMesg(&gTimerTaskMesgQueue, (OSMesg) NULL, OS_MESG_NOBLOCK);
+    osSendMesg(&gSerialThreadMesgQueue, (OSMesg) SI_QUICKSAVE_WAKE, OS_MESG_NOBLOCK);
+}
+
+RECOMP_PATCH void Audio_ThreadEntry(void* arg0) {
+    SPTask* task;
+
+    AudioLoad_Init();
+    Audio_InitSounds();
+
+    task = AudioThread_CreateTask();
+    if (task != NULL) {
+        task->mesgQueue = &gAudioTaskMesgQueue;
+        task->msg = (OSMesg) TASK_MESG_1;
+        osWritebackDCacheAll();
+        osSendMesg(&gTaskMesgQueue, task, OS_MESG_NOBLOCK);
+    }
+    while (true) {
+        // @recomp Stop here for quicksave actions. The previous task was sent a VI ago, so it's done by now.
+        recomp_handle_quicksave_actions(&gQuicksaveEnterMesgQueue, &gQuicksaveExitMesgQueue);
+
+        task = AudioThread_CreateTask();
+        if (task != NULL) {
+            task->mesgQueue = &gAudioTaskMesgQueue;
+            task->msg = (OSMesg) TASK_MESG_1;
+            osWritebackDCacheAll();
+        }
+        MQ_GET_MESG(&gAudioTaskMesgQueue, NULL);
+        if (task != NULL) {
+            osSendMesg(&gTaskMesgQueue, task, OS_MESG_NOBLOCK);
+        }
+        MQ_WAIT_FOR_MESG(&gAudioVImesgQueue, NULL);
+    }
+}
+
+RECOMP_PATCH void Timer_ThreadEntry(void* arg0) {
+    void* task;
+
+    while (true) {
+        // @recomp Stop here for quicksave actions.
+        recomp_handle_quicksave_actions(&gQuicksaveEnterMesgQueue, &gQuicksaveExitMesgQueue);
+
+        MQ_WAIT_FOR_MESG(&gTimerTaskMesgQueue, &task);
+        // @recomp A NULL task is only sent to wake the thread up for a quicksave action.
+        if (task != NULL) {
+            Timer_CompleteTask(task);
+        }
+    }
+}
+
+RECOMP_PATCH void SerialInterface_ThreadEntry(void* arg0) {
+    OSMesg mesg;
+
+    Controller_Init();
+    while (true) {
+        // @recomp Stop here for quicksave actions.
+        recomp_handle_quicksave_actions(&gQuicksaveEnterMesgQueue, &gQuicksaveExitMesgQueue);
+
+        MQ_WAIT_FOR_MESG(&gSerialThreadMesgQueue, &mesg);
+
+        switch ((s32) mesg) {
+            case SI_READ_CONTROLLER:
+                Controller_ReadData();
+                break;
+            case SI_READ_SAVE:
+                Save_ReadData();
+                break;
+            case SI_WRITE_SAVE:
+                Save_WriteData();
+                break;
+            case SI_RUMBLE:
+                Controller_Rumble();
+                break;
+            case SI_INIT_CONTROLLERS:
+                Controller_Init();
+                break;
+            // @recomp SI_QUICKSAVE_WAKE only brings the thread back around to its quicksave handler.
+        }
+    }
+}
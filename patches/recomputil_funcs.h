@@ -0,0 +1,108 @@
+#ifndef __RECOMPUTIL_FUNCS_H__
+#define __RECOMPUTIL_FUNCS_H__
+
+#include "patch_helpers.h"
+
+typedef u32 collection_key_t;
+typedef u32 U32ValueHashmapHandle;
+typedef u32 U32MemoryHashmapHandle;
+typedef u32 U32HashsetHandle;
+typedef u32 U32SlotmapHandle;
+typedef u32 MemorySlotmapHandle;
+
+// Fragmentation statistics for the allocator backing a memory hashmap or memory slotmap.
+// Must be kept in sync with write_slab_stats in src/game/recomp_data_api.cpp!
+typedef struct {
+    u32 cell_size;
+    u32 live_cells;
+    u32 free_cells;
+    u32 chunk_count;
+    u32 reserved_bytes;
+} RecomputilSlabStats;
+
+// u32 -> u32 value hashmap.
+DECLARE_FUNC(U32ValueHashmapHandle, recomputil_create_u32_value_hashmap);
+DECLARE_FUNC(void, recomputil_destroy_u32_value_hashmap, U32ValueHashmapHandle handle);
+DECLARE_FUNC(int, recomputil_u32_value_hashmap_contains, U32ValueHashmapHandle handle, collection_key_t key);
+DECLARE_FUNC(int, recomputil_u32_value_hashmap_insert, U32ValueHashmapHandle handle, collection_key_t key, u32 value);
+DECLARE_FUNC(int, recomputil_u32_value_hashmap_get, U32ValueHashmapHandle handle, collection_key_t key, u32* out);
+DECLARE_FUNC(int, recomputil_u32_value_hashmap_erase, U32ValueHashmapHandle handle, collection_key_t key);
+DECLARE_FUNC(u32, recomputil_u32_value_hashmap_size, U32ValueHashmapHandle handle);
+
+// Batched variants that process `count` keys in one call. Each returns the number of keys that were found, newly
+// inserted or erased. contains_many writes 1 or 0 for each key to `results_out`. get_many leaves the entries of
+// `values_out` whose key isn't in the map untouched, so they can be pre-filled with a default.
+DECLARE_FUNC(u32, recomputil_u32_value_hashmap_contains_many, U32ValueHashmapHandle handle, const collection_key_t* keys, u8* results_out, u32 count);
+DECLARE_FUNC(u32, recomputil_u32_value_hashmap_insert_many, U32ValueHashmapHandle handle, const collection_key_t* keys, const u32* values, u32 count);
+DECLARE_FUNC(u32, recomputil_u32_value_hashmap_get_many, U32ValueHashmapHandle handle, const collection_key_t* keys, u32* values_out, u32 count);
+DECLARE_FUNC(u32, recomputil_u32_value_hashmap_erase_many, U32ValueHashmapHandle handle, const collection_key_t* keys, u32 count);
+
+// u32 -> memory hashmap. Elements are zeroed when created.
+DECLARE_FUNC(U32MemoryHashmapHandle, recomputil_create_u32_memory_hashmap, u32 element_size);
+DECLARE_FUNC(void, recomputil_destroy_u32_memory_hashmap, U32MemoryHashmapHandle handle);
+DECLARE_FUNC(int, recomputil_u32_memory_hashmap_contains, U32MemoryHashmapHandle handle, collection_key_t key);
+DECLARE_FUNC(int, recomputil_u32_memory_hashmap_create, U32MemoryHashmapHandle handle, collection_key_t key);
+DECLARE_FUNC(void*, recomputil_u32_memory_hashmap_get, U32MemoryHashmapHandle handle, collection_key_t key);
+DECLARE_FUNC(int, recomputil_u32_memory_hashmap_erase, U32MemoryHashmapHandle handle, collection_key_t key);
+DECLARE_FUNC(u32, recomputil_u32_memory_hashmap_size, U32MemoryHashmapHandle handle);
+DECLARE_FUNC(void, recomputil_u32_memory_hashmap_get_stats, U32MemoryHashmapHandle handle, RecomputilSlabStats* stats_out);
+
+// u32 hashset.
+DECLARE_FUNC(U32HashsetHandle, recomputil_create_u32_hashset);
+DECLARE_FUNC(void, recomputil_destroy_u32_hashset, U32HashsetHandle handle);
+DECLARE_FUNC(int, recomputil_u32_hashset_contains, U32HashsetHandle handle, u32 key);
+DECLARE_FUNC(int, recomputil_u32_hashset_insert, U32HashsetHandle handle, u32 key);
+DECLARE_FUNC(int, recomputil_u32_hashset_erase, U32HashsetHandle handle, u32 key);
+DECLARE_FUNC(u32, recomputil_u32_hashset_size, U32HashsetHandle handle);
+DECLARE_FUNC(u32, recomputil_u32_hashset_contains_many, U32HashsetHandle handle, const u32* keys, u8* results_out, u32 count);
+DECLARE_FUNC(u32, recomputil_u32_hashset_insert_many, U32HashsetHandle handle, const u32* keys, u32 count);
+DECLARE_FUNC(u32, recomputil_u32_hashset_erase_many, U32HashsetHandle handle, const u32* keys, u32 count);
+
+// u32 value slotmap.
+DECLARE_FUNC(U32SlotmapHandle, recomputil_create_u32_slotmap);
+DECLARE_FUNC(void, recomputil_destroy_u32_slotmap, U32SlotmapHandle handle);
+DECLARE_FUNC(int, recomputil_u32_slotmap_contains, U32SlotmapHandle handle, collection_key_t key);
+DECLARE_FUNC(collection_key_t, recomputil_u32_slotmap_create, U32SlotmapHandle handle);
+DECLARE_FUNC(int, recomputil_u32_slotmap_get, U32SlotmapHandle handle, collection_key_t key, u32* out);
+DECLARE_FUNC(int, recomputil_u32_slotmap_set, U32SlotmapHandle handle, collection_key_t key, u32 value);
+DECLARE_FUNC(int, recomputil_u32_slotmap_erase, U32SlotmapHandle handle, collection_key_t key);
+DECLARE_FUNC(u32, recomputil_u32_slotmap_size, U32SlotmapHandle handle);
+// create_many writes the created keys to `keys_out`. A key of 0 means the slotmap is full.
+DECLARE_FUNC(u32, recomputil_u32_slotmap_contains_many, U32SlotmapHandle handle, const collection_key_t* keys, u8* results_out, u32 count);
+DECLARE_FUNC(u32, recomputil_u32_slotmap_create_many, U32SlotmapHandle handle, collection_key_t* keys_out, u32 count);
+DECLARE_FUNC(u32, recomputil_u32_slotmap_get_many, U32SlotmapHandle handle, const collection_key_t* keys, u32* values_out, u32 count);
+DECLARE_FUNC(u32, recomputil_u32_slotmap_set_many, U32SlotmapHandle handle, const collection_key_t* keys, const u32* values, u32 count);
+DECLARE_FUNC(u32, recomputil_u32_slotmap_erase_many, U32SlotmapHandle handle, const collection_key_t* keys, u32 count);
+
+// Memory slotmap. Elements are zeroed when created.
+DECLARE_FUNC(MemorySlotmapHandle, recomputil_create_memory_slotmap, u32 element_size);
+DECLARE_FUNC(void, recomputil_destroy_memory_slotmap, MemorySlotmapHandle handle);
+DECLARE_FUNC(int, recomputil_memory_slotmap_contains, MemorySlotmapHandle handle, collection_key_t key);
+DECLARE_FUNC(collection_key_t, recomputil_memory_slotmap_create, MemorySlotmapHandle handle);
+DECLARE_FUNC(void, recomputil_memory_slotmap_get, MemorySlotmapHandle handle, collection_key_t key, void** out);
+DECLARE_FUNC(int, recomputil_memory_slotmap_erase, MemorySlotmapHandle handle, collection_key_t key);
+DECLARE_FUNC(u32, recomputil_memory_slotmap_size, MemorySlotmapHandle handle);
+DECLARE_FUNC(void, recomputil_memory_slotmap_get_stats, MemorySlotmapHandle handle, RecomputilSlabStats* stats_out);
+
+// Object extension data. Each extension reserves a zeroed block of `size` bytes for every slot of one of the game's
+// object arrays, which is cleared again whenever an object in that slot is spawned or killed. The block for the object
+// at index i of the array is at base + i * RECOMPUTIL_OBJECT_EXTENSION_STRIDE(size). The base never changes, so it can
+// be fetched once after registering instead of going through the runtime every frame.
+typedef enum {
+    RECOMPUTIL_OBJECT_ACTOR,   // gActors
+    RECOMPUTIL_OBJECT_BOSS,    // gBosses
+    RECOMPUTIL_OBJECT_EFFECT,  // gEffects
+    RECOMPUTIL_OBJECT_ITEM,    // gItems
+    RECOMPUTIL_OBJECT_SCENERY, // gScenery
+} RecomputilObjectType;
+
+typedef u32 ObjectExtensionHandle;
+
+#define RECOMPUTIL_OBJECT_EXTENSION_STRIDE(size) (((size) + 7) & ~7)
+
+DECLARE_FUNC(ObjectExtensionHandle, recomputil_register_object_extension, RecomputilObjectType object_type, u32 size);
+DECLARE_FUNC(void*, recomputil_get_object_extension_base, RecomputilObjectType object_type, ObjectExtensionHandle extension);
+DECLARE_FUNC(void*, recomputil_get_object_extension_data, RecomputilObjectType object_type, ObjectExtensionHandle extension, u32 index);
+DECLARE_FUNC(u32, recomputil_get_object_slot_count, RecomputilObjectType object_type);
+
+#endif
@@ -84,7 +84,12 @@ RECOMP_PATCH void Main_ThreadEntry(void* arg0) {
     u8 mesg;
 
     // @recomp_event recomp_on_init(): Allow mods to initialize themselves once.
+    recomp_profile_event_begin(RECOMP_PROFILE_EVENT_ON_INIT);
     recomp_on_init();
+    recomp_profile_event_end(RECOMP_PROFILE_EVENT_ON_INIT);
+
+    // @recomp The permanent threads use these as soon as they start.
+    Quicksave_InitMesgQueues();
 
     osCreateThread(&gAudioThread, THREAD_ID_AUDIO, Audio_ThreadEntry, arg0,
                    gAudioThreadStack + sizeof(gAudioThreadStack), 80);
@@ -124,6 +129,12 @@ RECOMP_PATCH void Main_ThreadEntry(void* arg0) {
         if (gStopTasks == 0) {
             Main_StartNextTask();
         }
+        // @recomp Gather the other permanent threads for a quicksave action once one is requested. This only happens
+        // on VIs, which is also what the interval between rewind points is counted in.
+        if ((mesg == EVENT_MESG_VI) &&
+            recomp_handle_quicksave_actions_main(&gQuicksaveEnterMesgQueue, &gQuicksaveExitMesgQueue)) {
+            Quicksave_WakeThreads();
+        }
     }
 }
 #endif
@@ -1,5 +1,4 @@
 #define RECOMP_PATCH __attribute__((section(".recomp_patch")))
-#define osEepromWrite osEepromWrite_recomp
 #define osEepromRead osEepromRead_recomp
 #define osEepromProbe osEepromProbe_recomp
 
@@ -9,98 +8,41 @@
 #include "sf64save.h"
 #include "macros.h"
 #include "patches.h"
+#include "misc_funcs.h"
 
 
-// On hold until memcpy and __udivdi3 issues are sorted
+// The game's saves go to a file on the host instead of the emulated EEPROM. The host compares the save against what
+// it last wrote and writes the file out in the background, so saving never waits on the EEPROM or on file I/O.
+// This also avoids the copies of the whole SaveFile that the original functions do.
 
-#if 0 // Global scope
-
-s32 Save_WriteBlock(s32 arg0, u8* arg1);
-s32 Save_ReadBlock(s32 arg0, u8* arg1);
-
-#if 1
-RECOMP_PATCH s32 Save_ReadBlock(s32 arg0, u8* arg1) {
-    if (osEepromRead(&gSerialEventQueue, arg0, arg1)) {
-        PRINTF("ＥＥＰＲＯＭ インターフェース回路反応なし (ＲＥＡＤ)\n");
-        return -1;
-    } else {
-        PRINTF("EEPROM READ  %02X: %02X %02X %02X %02X %02X %02X %02X %02X\n");
-        return 0;
-    }
-}
-#endif
-
-#if 1
-RECOMP_PATCH s32 Save_WriteBlock(s32 arg0, u8* arg1) {
-    //recomp_printf("osEepromWrite(%x, %d, %x)\n", &gSerialEventQueue, arg0, arg1);
-
-    if (osEepromWrite(&gSerialEventQueue, arg0, arg1)) {
-        PRINTF("ＥＥＰＲＯＭ インターフェース回路反応なし (ＷＲＩＴＥ)\n");
-        return -1;
-    } else {
-        PRINTF("EEPROM WRITE %02X: %02X %02X %02X %02X %02X %02X %02X %02X\n");
-        return 0;
-    }
-}
-#endif
-
-#if 1
 RECOMP_PATCH s32 Save_WriteEeprom(SaveFile* arg0) {
-    s32 var_a2;
-    s32 i;
-    s32 j;
-
-    if (osEepromProbe(&gSerialEventQueue) != 1) { // @recomp
-        PRINTF("ＥＥＰＲＯＭ が ありません\n");
-        return -1;
-    }
-
-    for (i = 0; i < EEPROM_MAXBLOCKS; i++) {
-        var_a2 = 0;
-        for (j = 0; j < EEPROM_BLOCK_SIZE; j++) {
-            if (((char*) &sPrevSaveData)[EEPROM_BLOCK_SIZE * i + j] != ((char*) arg0)[EEPROM_BLOCK_SIZE * i + j]) {
-                ((char*) &sPrevSaveData)[EEPROM_BLOCK_SIZE * i + j] = ((char*) arg0)[EEPROM_BLOCK_SIZE * i + j];
-                var_a2 = 1;
-            }
-        }
-        if ((var_a2 == 1) && Save_WriteBlock(i, &((u8*) arg0)[EEPROM_BLOCK_SIZE * i])) {
-            return -1;
-        }
-    }
+    // @recomp Hand the whole save to the host.
+    recomp_write_save_file(arg0);
     return 0;
 }
-#endif
 
-void* my_memcpy(void* dest, const void* src, u32 n) {
-    // Cast src and dest to char* to perform byte-wise copy
-    char* d = (char*) dest;
-    const char* s = (const char*) src;
-
-    // Copy n bytes from src to dest
-    while (n--) {
-        *d++ = *s++;
-    }
-
-    return dest;
-}
-
-#if 1
 RECOMP_PATCH s32 Save_ReadEeprom(SaveFile* arg0) {
     s32 i;
 
+    // @recomp Read the host save if there is one.
+    if (recomp_read_save_file(arg0)) {
+        return 0;
+    }
+
+    // @recomp Otherwise this is either a new save or one made before the host saves existed, which is still in the
+    // emulated EEPROM.
     if (osEepromProbe(&gSerialEventQueue) != 1) {
         PRINTF("ＥＥＰＲＯＭ が ありません\n");
         return -1;
     }
     for (i = 0; i < EEPROM_MAXBLOCKS; i++) {
-        if (Save_ReadBlock(i, &((u8*) arg0)[EEPROM_BLOCK_SIZE * i]) != 0) {
+        if (osEepromRead(&gSerialEventQueue, i, &((u8*) arg0)[EEPROM_BLOCK_SIZE * i]) != 0) {
+            PRINTF("ＥＥＰＲＯＭ インターフェース回路反応なし (ＲＥＡＤ)\n");
             return -1;
         }
     }
-    //sPrevSaveData = *arg0;
-    my_memcpy((void*) &sPrevSaveData, (const void*) &arg0, sizeof(SaveFile));
+
+    // @recomp Carry the save over to the host, which is where it's saved from now on.
+    recomp_write_save_file(arg0);
     return 0;
 }
-#endif
-
-#endif
@@ -191,6 +191,7 @@ RECOMP_PATCH void Title_CorneriaExplosions_Draw(void) {
 
         // @recomp Pop the transform id.
         gEXPopMatrixGroup(gMasterDisp++, G_MTX_MODELVIEW);
+        Graphics_ArenaCheckpoint(); // @recomp
     }
 }
 #endif
@@ -357,6 +358,7 @@ RECOMP_PATCH void Title_EngineGlowParticles_Draw(TitleTeam teamIdx) {
         gEXPopMatrixGroup(gMasterDisp++, G_MTX_MODELVIEW);
 
         Matrix_Pop(&gGfxMatrix);
+        Graphics_ArenaCheckpoint(); // @recomp
     }
 }
 
@@ -4,6 +4,113 @@
 #include "patch_helpers.h"
 #include "recompui_event_structs.h"
 
+// These two enums must be kept in sync with src/ui/elements/ui_types.h!
+typedef enum {
+    UI_STYLE_VISIBILITY,
+    UI_STYLE_POSITION,
+    UI_STYLE_LEFT,
+    UI_STYLE_TOP,
+    UI_STYLE_RIGHT,
+    UI_STYLE_BOTTOM,
+    UI_STYLE_WIDTH,
+    UI_STYLE_WIDTH_AUTO,
+    UI_STYLE_HEIGHT,
+    UI_STYLE_HEIGHT_AUTO,
+    UI_STYLE_MIN_WIDTH,
+    UI_STYLE_MIN_HEIGHT,
+    UI_STYLE_MAX_WIDTH,
+    UI_STYLE_MAX_HEIGHT,
+    UI_STYLE_PADDING,
+    UI_STYLE_PADDING_LEFT,
+    UI_STYLE_PADDING_TOP,
+    UI_STYLE_PADDING_RIGHT,
+    UI_STYLE_PADDING_BOTTOM,
+    UI_STYLE_MARGIN,
+    UI_STYLE_MARGIN_LEFT,
+    UI_STYLE_MARGIN_TOP,
+    UI_STYLE_MARGIN_RIGHT,
+    UI_STYLE_MARGIN_BOTTOM,
+    UI_STYLE_MARGIN_AUTO,
+    UI_STYLE_MARGIN_LEFT_AUTO,
+    UI_STYLE_MARGIN_TOP_AUTO,
+    UI_STYLE_MARGIN_RIGHT_AUTO,
+    UI_STYLE_MARGIN_BOTTOM_AUTO,
+    UI_STYLE_BORDER_WIDTH,
+    UI_STYLE_BORDER_LEFT_WIDTH,
+    UI_STYLE_BORDER_TOP_WIDTH,
+    UI_STYLE_BORDER_RIGHT_WIDTH,
+    UI_STYLE_BORDER_BOTTOM_WIDTH,
+    UI_STYLE_BORDER_RADIUS,
+    UI_STYLE_BORDER_TOP_LEFT_RADIUS,
+    UI_STYLE_BORDER_TOP_RIGHT_RADIUS,
+    UI_STYLE_BORDER_BOTTOM_LEFT_RADIUS,
+    UI_STYLE_BORDER_BOTTOM_RIGHT_RADIUS,
+    UI_STYLE_BACKGROUND_COLOR,
+    UI_STYLE_BORDER_COLOR,
+    UI_STYLE_BORDER_LEFT_COLOR,
+    UI_STYLE_BORDER_TOP_COLOR,
+    UI_STYLE_BORDER_RIGHT_COLOR,
+    UI_STYLE_BORDER_BOTTOM_COLOR,
+    UI_STYLE_COLOR,
+    UI_STYLE_CURSOR,
+    UI_STYLE_OPACITY,
+    UI_STYLE_DISPLAY,
+    UI_STYLE_JUSTIFY_CONTENT,
+    UI_STYLE_FLEX_GROW,
+    UI_STYLE_FLEX_SHRINK,
+    UI_STYLE_FLEX_BASIS_AUTO,
+    UI_STYLE_FLEX_BASIS,
+    UI_STYLE_FLEX_DIRECTION,
+    UI_STYLE_ALIGN_ITEMS,
+    UI_STYLE_OVERFLOW,
+    UI_STYLE_OVERFLOW_X,
+    UI_STYLE_OVERFLOW_Y,
+    UI_STYLE_FONT_SIZE,
+    UI_STYLE_LETTER_SPACING,
+    UI_STYLE_LINE_HEIGHT,
+    UI_STYLE_FONT_STYLE,
+    UI_STYLE_FONT_WEIGHT,
+    UI_STYLE_TEXT_ALIGN,
+    UI_STYLE_GAP,
+    UI_STYLE_ROW_GAP,
+    UI_STYLE_COLUMN_GAP,
+    UI_STYLE_DRAG,
+    UI_STYLE_TAB_INDEX,
+    UI_STYLE_COUNT
+} RecompuiStyleProperty;
+
+typedef enum {
+    UI_UNIT_PX,
+    UI_UNIT_DP,
+    UI_UNIT_PERCENT
+} RecompuiUnit;
+
+// One entry of a style block passed to recompui_apply_style_block. Lengths and numbers use the float value,
+// enums and font weights use the integer value, and colors are packed as 0xRRGGBBAA.
+typedef struct {
+    u32 property;
+    u32 unit;
+    union {
+        float f;
+        u32 u;
+    } value;
+} RecompuiStyleRecord;
+
+#define UI_STYLE_RECORD_LENGTH(property, length, unit) { (property), (unit), { .f = (length) } }
+#define UI_STYLE_RECORD_NUMBER(property, number) { (property), UI_UNIT_DP, { .f = (number) } }
+#define UI_STYLE_RECORD_ENUM(property, enum_value) { (property), UI_UNIT_DP, { .u = (u32)(enum_value) } }
+#define UI_STYLE_RECORD_COLOR(property, r, g, b, a) \
+    { (property), UI_UNIT_DP, { .u = ((u32)(r) << 24) | ((u32)(g) << 16) | ((u32)(b) << 8) | (u32)(a) } }
+
+// Applies a list of UI_STYLE_RECORD_* entries to a resource with a single call, e.g.
+// UI_APPLY_STYLES(element, UI_STYLE_RECORD_LENGTH(UI_STYLE_WIDTH, 100.0f, UI_UNIT_PERCENT), UI_STYLE_RECORD_COLOR(UI_STYLE_COLOR, 255, 255, 255, 255));
+#define UI_APPLY_STYLES(resource, ...) \
+    do { \
+        RecompuiStyleRecord ui_style_records__[] = { __VA_ARGS__ }; \
+        recompui_apply_style_block((resource), ui_style_records__, sizeof(ui_style_records__) / sizeof(ui_style_records__[0])); \
+    } while (0)
+
 DECLARE_FUNC(void, recomp_run_ui_callbacks);
+DECLARE_FUNC(void, recompui_apply_style_block, u32 resource, const RecompuiStyleRecord* records, u32 count);
 
 #endif
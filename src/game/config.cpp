@@ -3,6 +3,7 @@
 #include "zelda_sound.h"
 #include "zelda_render.h"
 #include "zelda_support.h"
+#include "zelda_pacer.h"
 #include "ultramodern/config.hpp"
 #include "librecomp/files.hpp"
 #include <filesystem>
@@ -235,6 +236,7 @@ bool save_general_config(const std::filesystem::path& path) {
     recomp::to_json(config_json["background_input_mode"], recomp::get_background_input_mode());
     config_json["rumble_strength"] = recomp::get_rumble_strength();
     config_json["gyro_sensitivity"] = recomp::get_gyro_sensitivity();
+    config_json["gyro_rate_independent"] = recomp::get_gyro_rate_independent();
     config_json["mouse_sensitivity"] = recomp::get_mouse_sensitivity();
     config_json["joystick_deadzone"] = recomp::get_joystick_deadzone();
     config_json["film_grain_mode"] = zelda64::get_film_grain_mode();
@@ -242,6 +244,7 @@ bool save_general_config(const std::filesystem::path& path) {
     config_json["invert_y_axis_mode"] = zelda64::get_invert_y_axis_mode();
     config_json["analog_camera_invert_mode"] = zelda64::get_analog_camera_invert_mode();
     config_json["debug_mode"] = zelda64::get_debug_mode_enabled();
+    config_json["host_frame_pacing"] = zelda64::get_host_frame_pacing();
 
     return save_json_with_backups(path, config_json);
 }
@@ -251,6 +254,7 @@ void set_general_settings_from_json(const nlohmann::json& config_json) {
     recomp::set_background_input_mode(from_or_default(config_json, "background_input_mode", recomp::BackgroundInputMode::On));
     recomp::set_rumble_strength(from_or_default(config_json, "rumble_strength", 50));
     recomp::set_gyro_sensitivity(from_or_default(config_json, "gyro_sensitivity", 50));
+    recomp::set_gyro_rate_independent(from_or_default(config_json, "gyro_rate_independent", true));
     recomp::set_mouse_sensitivity(from_or_default(config_json, "mouse_sensitivity", is_steam_deck ? 50 : 0));
     recomp::set_joystick_deadzone(from_or_default(config_json, "joystick_deadzone", 0));
     zelda64::set_film_grain_mode(from_or_default(config_json, "film_grain_mode", zelda64::FilmGrainMode::On));
@@ -258,6 +262,8 @@ void set_general_settings_from_json(const nlohmann::json& config_json) {
     zelda64::set_invert_y_axis_mode(from_or_default(config_json, "invert_y_axis_mode", zelda64::AimInvertMode::On));
     zelda64::set_analog_camera_invert_mode(from_or_default(config_json, "analog_camera_invert_mode", zelda64::AimInvertMode::On));
     zelda64::set_debug_mode_enabled(from_or_default(config_json, "debug_mode", false));
+    // Linux only and not in the menus. Set to true in general.json to pace frames with the host clock, see zelda_pacer.h.
+    zelda64::set_host_frame_pacing(from_or_default(config_json, "host_frame_pacing", false));
 }
 
 bool load_general_config(const std::filesystem::path& path) {
@@ -2,6 +2,8 @@
 
 #include "librecomp/helpers.hpp"
 #include "recomp_input.h"
+#include "zelda_latency.h"
+#include "zelda_replay.h"
 #include "ultramodern/ultramodern.hpp"
 
 // Arrays that hold the mappings for every input for keyboard and controller respectively.
@@ -10,13 +12,6 @@ using input_mapping_array = std::array<input_mapping, static_cast<size_t>(recomp
 static input_mapping_array keyboard_input_mappings{};
 static input_mapping_array controller_input_mappings{};
 
-// Make the button value array, which maps a button index to its bit field.
-#define DEFINE_INPUT(name, value, readable) uint16_t(value##u),
-static const std::array n64_button_values = {
-    DEFINE_N64_BUTTON_INPUTS()
-};
-#undef DEFINE_INPUT
-
 // Make the input name array.
 #define DEFINE_INPUT(name, value, readable) readable,
 static const std::vector<std::string> input_names = {
@@ -72,6 +67,7 @@ void recomp::set_input_binding(recomp::GameInput input, size_t binding_index, re
 
     if (binding_index < cur_input_mapping.size()) {
         cur_input_mapping[binding_index] = value;
+        recomp::compile_n64_bindings();
     }
 }
 
@@ -84,33 +80,31 @@ bool recomp::get_n64_input(int controller_num, uint16_t* buttons_out, float* x_o
         return false;
     }
 
-    if (!recomp::game_input_disabled()) {
-        for (size_t i = 0; i < n64_button_values.size(); i++) {
-            size_t input_index = (size_t)GameInput::N64_BUTTON_START + i;
-            cur_buttons |= recomp::get_input_digital(keyboard_input_mappings[input_index]) ? n64_button_values[i] : 0;
-            cur_buttons |= recomp::get_input_digital(controller_input_mappings[input_index]) ? n64_button_values[i] : 0;
-        }
-
-        float joystick_deadzone = recomp::get_joystick_deadzone() / 100.0f;
-
-        float joystick_x = recomp::get_input_analog(controller_input_mappings[(size_t)GameInput::X_AXIS_POS])
-                        - recomp::get_input_analog(controller_input_mappings[(size_t)GameInput::X_AXIS_NEG]);
+    // Replays supply the whole pad state themselves.
+    bool live_input = !recomp::game_input_disabled() && zelda64::get_input_replay_mode() != zelda64::InputReplayMode::Replay;
+    if (live_input) {
+        recomp::N64PadState pad_state = recomp::evaluate_n64_bindings();
+        cur_buttons = pad_state.buttons;
 
-        float joystick_y = recomp::get_input_analog(controller_input_mappings[(size_t)GameInput::Y_AXIS_POS])
-                        - recomp::get_input_analog(controller_input_mappings[(size_t)GameInput::Y_AXIS_NEG]);
+        float joystick_x;
+        float joystick_y;
+        recomp::apply_joystick_deadzone(pad_state.joystick_x, pad_state.joystick_y, &joystick_x, &joystick_y);
 
-        recomp::apply_joystick_deadzone(joystick_x, joystick_y, &joystick_x, &joystick_y);
-
-        cur_x = recomp::get_input_analog(keyboard_input_mappings[(size_t)GameInput::X_AXIS_POS])
-                - recomp::get_input_analog(keyboard_input_mappings[(size_t)GameInput::X_AXIS_NEG]) + joystick_x;
-
-        cur_y = recomp::get_input_analog(keyboard_input_mappings[(size_t)GameInput::Y_AXIS_POS])
-                - recomp::get_input_analog(keyboard_input_mappings[(size_t)GameInput::Y_AXIS_NEG]) + joystick_y;
+        cur_x = pad_state.keyboard_x + joystick_x;
+        cur_y = pad_state.keyboard_y + joystick_y;
     }
 
     *buttons_out = cur_buttons;
     *x_out = std::clamp(cur_x * 0.65f, -1.0f, 1.0f);
     *y_out = std::clamp(cur_y * 0.65f, -1.0f, 1.0f);
+    zelda64::process_input_replay_pad(buttons_out, x_out, y_out);
+
+    // The first read that sees the probed input held is the one that picked it up. Other changes to the pad state, like
+    // stick noise, don't count.
+    recomp::InputField probed_input;
+    if (live_input && zelda64::get_latency_probe_input(probed_input) && recomp::get_input_digital(probed_input)) {
+        zelda64::mark_latency_stage(zelda64::LatencyStage::GameRead);
+    }
 
     return true;
 }
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <thread>
+
+#include "zelda_pacer.h"
+#include "librecomp/helpers.hpp"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <time.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace zelda64 {
+    using pacer_clock = std::chrono::steady_clock;
+
+    // Number of frames the frame time statistics are taken over.
+    constexpr size_t pacer_history_size = 64;
+    // Weight of each new sleep overshoot in its running mean and variance.
+    constexpr double pacer_overshoot_weight = 1.0 / 16.0;
+    // Margin for the spin on top of the expected overshoot, in standard deviations of the overshoot.
+    constexpr double pacer_overshoot_deviations = 3.0;
+    constexpr double pacer_spin_slack_us = 50.0;
+    // Frames have to take this much longer than their nominal length on average for the measured rate to be used.
+    constexpr double pacer_slow_frame_ratio = 1.1;
+
+    struct FramePacerState {
+        std::atomic_bool host_pacing = false;
+
+        // Only touched by the graphics thread.
+        pacer_clock::time_point deadline{};
+        pacer_clock::time_point last_frame_end{};
+        bool scheduled = false;
+        uint32_t vis_per_frame = 0;
+        pacer_clock::duration spin_margin = std::chrono::microseconds{ 500 };
+
+        // Read by the UI and the renderer.
+        std::mutex stats_mutex;
+        std::array<double, pacer_history_size> frame_ms{};
+        size_t frame_count = 0;
+        size_t next_frame = 0;
+        double overshoot_mean_us = 0.0;
+        double overshoot_variance_us = 0.0;
+    };
+
+    static FramePacerState pacer_state{};
+
+    static void sleep_until(pacer_clock::time_point wake_time) {
+#if defined(__linux__)
+        // The steady clock is CLOCK_MONOTONIC on Linux, so its time points can be handed to clock_nanosleep as they are.
+        auto since_epoch = wake_time.time_since_epoch();
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+        timespec wake_spec{
+            .tv_sec = time_t(seconds.count()),
+            .tv_nsec = long(std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch - seconds).count()),
+        };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake_spec, nullptr) == EINTR) {}
+#else
+        std::this_thread::sleep_until(wake_time);
+#endif
+    }
+
+    static void cpu_relax() {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__)
+        __asm__ __volatile__("yield");
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    static void record_overshoot(pacer_clock::duration overshoot) {
+        double sample_us = std::chrono::duration<double, std::micro>(overshoot).count();
+
+        std::lock_guard lock{pacer_state.stats_mutex};
+        double delta = sample_us - pacer_state.overshoot_mean_us;
+        pacer_state.overshoot_mean_us += pacer_overshoot_weight * delta;
+        pacer_state.overshoot_variance_us = (1.0 - pacer_overshoot_weight) * (pacer_state.overshoot_variance_us + pacer_overshoot_weight * delta * delta);
+
+        double margin_us = pacer_state.overshoot_mean_us + pacer_overshoot_deviations * std::sqrt(pacer_state.overshoot_variance_us) + pacer_spin_slack_us;
+        margin_us = std::clamp(margin_us, double(min_pacer_spin_margin.count()), double(max_pacer_spin_margin.count()));
+        pacer_state.spin_margin = std::chrono::duration_cast<pacer_clock::duration>(std::chrono::duration<double, std::micro>(margin_us));
+    }
+
+    static void record_frame_end(pacer_clock::time_point frame_end, uint32_t vis_per_frame) {
+        std::lock_guard lock{pacer_state.stats_mutex};
+        // Frames of different lengths aren't comparable, so the statistics start over when the frame length changes.
+        if (vis_per_frame != pacer_state.vis_per_frame) {
+            pacer_state.frame_count = 0;
+            pacer_state.next_frame = 0;
+            pacer_state.vis_per_frame = vis_per_frame;
+        }
+        else {
+            pacer_state.frame_ms[pacer_state.next_frame] = std::chrono::duration<double, std::milli>(frame_end - pacer_state.last_frame_end).count();
+            pacer_state.next_frame = (pacer_state.next_frame + 1) % pacer_history_size;
+            pacer_state.frame_count = std::min(pacer_state.frame_count + 1, pacer_history_size);
+        }
+        pacer_state.last_frame_end = frame_end;
+    }
+
+    // Must be called with the stats mutex held.
+    static FramePacingStats summarize_frames() {
+        FramePacingStats stats{
+            .mean_frame_ms = 0.0,
+            .frame_stddev_ms = 0.0,
+            .sleep_overshoot_us = pacer_state.overshoot_mean_us,
+            .spin_margin_us = std::chrono::duration<double, std::micro>(pacer_state.spin_margin).count(),
+            .measured_rate = 0.0,
+        };
+
+        if (pacer_state.frame_count == 0) {
+            return stats;
+        }
+
+        double total = 0.0;
+        for (size_t i = 0; i < pacer_state.frame_count; i++) {
+            total += pacer_state.frame_ms[i];
+        }
+        stats.mean_frame_ms = total / pacer_state.frame_count;
+
+        double squared_deviations = 0.0;
+        for (size_t i = 0; i < pacer_state.frame_count; i++) {
+            double deviation = pacer_state.frame_ms[i] - stats.mean_frame_ms;
+            squared_deviations += deviation * deviation;
+        }
+        stats.frame_stddev_ms = std::sqrt(squared_deviations / pacer_state.frame_count);
+        stats.measured_rate = 1000.0 / stats.mean_frame_ms;
+        return stats;
+    }
+}
+
+bool zelda64::get_host_frame_pacing() {
+    return pacer_state.host_pacing.load();
+}
+
+void zelda64::set_host_frame_pacing(bool enabled) {
+#if defined(__linux__)
+    pacer_state.host_pacing.store(enabled);
+#else
+    (void)enabled;
+#endif
+}
+
+void zelda64::pace_frame(uint32_t vis_per_frame) {
+    if (!pacer_state.host_pacing.load(std::memory_order_relaxed)) {
+        // The game already waited for the VIs, so the schedule starts over if host pacing gets enabled later.
+        pacer_state.scheduled = false;
+        record_frame_end(pacer_clock::now(), vis_per_frame);
+        return;
+    }
+
+    auto period = std::chrono::duration_cast<pacer_clock::duration>(std::chrono::duration<double>(double(vis_per_frame) / pacer_vi_rate));
+    pacer_clock::time_point now = pacer_clock::now();
+    pacer_clock::time_point deadline = pacer_state.deadline + period;
+
+    // Frames that end up less than a frame late keep the schedule, so the next ones make up for it.
+    if (!pacer_state.scheduled || now - deadline > period) {
+        deadline = now;
+        pacer_state.scheduled = true;
+    }
+
+    pacer_clock::time_point wake_time = deadline - pacer_state.spin_margin;
+    if (now < wake_time) {
+        sleep_until(wake_time);
+        record_overshoot(pacer_clock::now() - wake_time);
+    }
+
+    while (pacer_clock::now() < deadline) {
+        cpu_relax();
+    }
+
+    pacer_state.deadline = deadline;
+    record_frame_end(pacer_clock::now(), vis_per_frame);
+}
+
+zelda64::FramePacingStats zelda64::get_frame_pacing_stats() {
+    std::lock_guard lock{pacer_state.stats_mutex};
+    return summarize_frames();
+}
+
+uint32_t zelda64::get_paced_refresh_rate(uint32_t vis_per_frame) {
+    uint32_t nominal_rate = pacer_vi_rate / std::max<uint32_t>(vis_per_frame, 1);
+
+    std::lock_guard lock{pacer_state.stats_mutex};
+    FramePacingStats stats = summarize_frames();
+
+    // Only trust a full history, since the first frames after a load are usually slow.
+    if (pacer_state.frame_count != pacer_history_size || stats.mean_frame_ms * nominal_rate < 1000.0 * pacer_slow_frame_ratio) {
+        return nominal_rate;
+    }
+
+    return std::clamp<uint32_t>(uint32_t(std::lround(stats.measured_rate)), 1, nominal_rate);
+}
+
+extern "C" void recomp_pace_frame(uint8_t* rdram, recomp_context* ctx) {
+    u32 vis_per_frame = _arg<0, u32>(rdram, ctx);
+
+    zelda64::pace_frame(std::max<u32>(vis_per_frame, 1));
+}
+
+extern "C" void recomp_get_host_frame_pacing(uint8_t* rdram, recomp_context* ctx) {
+    _return(ctx, s32(zelda64::get_host_frame_pacing()));
+}
+
+extern "C" void recomp_get_paced_refresh_rate(uint8_t* rdram, recomp_context* ctx) {
+    u32 vis_per_frame = _arg<0, u32>(rdram, ctx);
+
+    _return(ctx, s32(zelda64::get_paced_refresh_rate(vis_per_frame)));
+}
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include "zelda_gfx_arena.h"
+#include "librecomp/helpers.hpp"
+#include "librecomp/addresses.hpp"
+
+namespace zelda64 {
+    // Chunks larger than this are a bug in the patches rather than a heavy frame.
+    constexpr uint32_t max_gfx_arena_chunk_size = 4 * 1024 * 1024;
+
+    struct GfxArenaState {
+        std::mutex mutex;
+        GfxArenaStats stats{};
+    };
+
+    static GfxArenaState arena_state{};
+}
+
+zelda64::GfxArenaStats zelda64::get_gfx_arena_stats() {
+    std::lock_guard lock{arena_state.mutex};
+    return arena_state.stats;
+}
+
+// void* recomp_alloc_gfx_arena_chunk(u32 size)
+// Returns a new chunk for the graphics arena, or NULL if the size isn't valid or it can't be allocated. The chunk stays
+// allocated for the rest of the game.
+extern "C" void recomp_alloc_gfx_arena_chunk(uint8_t* rdram, recomp_context* ctx) {
+    u32 size = _arg<0, u32>(rdram, ctx);
+
+    if (size == 0 || size > zelda64::max_gfx_arena_chunk_size) {
+        _return<PTR(void)>(ctx, NULLPTR);
+        return;
+    }
+
+    void* mem = recomp::alloc(rdram, size);
+    if (mem == nullptr) {
+        _return<PTR(void)>(ctx, NULLPTR);
+        return;
+    }
+
+    // Display lists that run past what the game wrote should hit an end command rather than stale commands.
+    memset(mem, 0, size);
+
+    {
+        std::lock_guard lock{zelda64::arena_state.mutex};
+        zelda64::arena_state.stats.chunk_count++;
+        zelda64::arena_state.stats.reserved_bytes += size;
+    }
+
+    gpr addr = (reinterpret_cast<uint8_t*>(mem) - rdram) + 0xFFFFFFFF80000000ULL;
+    _return<PTR(void)>(ctx, addr);
+}
+
+// void recomp_report_gfx_arena_usage(u32 dl_bytes, u32 mtx_bytes)
+extern "C" void recomp_report_gfx_arena_usage(uint8_t* rdram, recomp_context* ctx) {
+    u32 dl_bytes = _arg<0, u32>(rdram, ctx);
+    u32 mtx_bytes = _arg<1, u32>(rdram, ctx);
+
+    std::lock_guard lock{zelda64::arena_state.mutex};
+    zelda64::GfxArenaStats& stats = zelda64::arena_state.stats;
+    stats.frame_dl_bytes = dl_bytes;
+    stats.frame_mtx_bytes = mtx_bytes;
+    stats.peak_dl_bytes = std::max(stats.peak_dl_bytes, dl_bytes);
+    stats.peak_mtx_bytes = std::max(stats.peak_mtx_bytes, mtx_bytes);
+    stats.frame_count++;
+}
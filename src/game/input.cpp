@@ -5,6 +5,9 @@
 #include "recomp.h"
 #include "recomp_input.h"
 #include "zelda_config.h"
+#include "zelda_game.h"
+#include "zelda_latency.h"
+#include "zelda_replay.h"
 #include "recomp_ui.h"
 #include "SDL.h"
 #include "promptfont.h"
@@ -16,7 +19,8 @@ struct ControllerState {
     SDL_GameController* controller;
     std::array<float, 3> latest_accelerometer;
     GamepadMotion motion;
-    uint32_t prev_gyro_timestamp;
+    // Timestamp of the previous gyro sample in microseconds.
+    uint64_t prev_gyro_timestamp;
     ControllerState() : controller{}, latest_accelerometer{}, motion{}, prev_gyro_timestamp{} {
         motion.Reset();
         motion.SetCalibrationMode(GamepadMotionHelpers::CalibrationMode::Stillness | GamepadMotionHelpers::CalibrationMode::SensorFusion);
@@ -24,9 +28,6 @@ struct ControllerState {
 };
 
 static struct {
-    const Uint8* keys = nullptr;
-    SDL_Keymod keymod = SDL_Keymod::KMOD_NONE;
-    int numkeys = 0;
     std::atomic_int32_t mouse_wheel_pos = 0;
     std::mutex cur_controllers_mutex;
     std::vector<SDL_GameController*> cur_controllers{};
@@ -34,9 +35,10 @@ static struct {
     
     std::array<float, 2> rotation_delta{};
     std::array<float, 2> mouse_delta{};
-    std::mutex pending_input_mutex;
-    std::array<float, 2> pending_rotation_delta{};
-    std::array<float, 2> pending_mouse_delta{};
+    // Accumulated by the event thread and swapped out by poll_inputs. Rotation is in fixed point so it can be added
+    // atomically, and mouse motion is always a whole number of pixels.
+    std::array<std::atomic<int64_t>, 2> pending_rotation_delta{};
+    std::array<std::atomic<int64_t>, 2> pending_mouse_delta{};
 
     float cur_rumble;
     bool rumble_active;
@@ -46,6 +48,58 @@ static struct {
     std::list<std::filesystem::path> files_dropped;
 } DropState;
 
+// Fractional bits of the pending rotation delta.
+constexpr float rotation_fixed_point_scale = 65536.0f;
+
+// Gyro samples are integrated over their own interval and scaled by this rate, which feels the same as the old
+// per-sample deltas on a controller reporting at this rate and the same on every other controller. The old behavior,
+// where every sample adds its angular velocity as is and aiming scales with the controller's report rate, is kept
+// behind the gyro_rate_independent config key for players whose sensitivity was tuned for it.
+constexpr float gyro_reference_rate = 250.0f;
+
+static std::atomic_bool gyro_rate_independent = true;
+
+// Caps the interval of a single gyro sample, so the first sample after the sensor was idle doesn't cause a jump.
+constexpr float max_gyro_sample_interval = 0.05f;
+
+static_assert(SDL_GameControllerButton::SDL_CONTROLLER_BUTTON_MAX <= 32, "Controller buttons must fit in the snapshot's button mask");
+
+// Everything the binding queries need from SDL, sampled by handle_events every time it pumps SDL's events. Queries read
+// it through a seqlock instead of taking a mutex and calling into SDL for every binding. Only handle_events writes to
+// it. Every field is a relaxed atomic so that a read racing with a write is merely retried, never undefined.
+static struct {
+    std::atomic<uint32_t> sequence = 0;
+    std::array<std::atomic<uint8_t>, SDL_NUM_SCANCODES> keys{};
+    std::atomic<uint32_t> keymod = SDL_Keymod::KMOD_NONE;
+    // Buttons held on any controller.
+    std::atomic<uint32_t> buttons = 0;
+    // Each axis direction combined across all controllers, indexed by axis and then by whether it's the negative range.
+    std::array<std::array<std::atomic<float>, 2>, SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_MAX> axes{};
+} InputSnapshot;
+
+// Runs read_func until it completes without the data guarded by the given sequence being written in the meantime.
+template <typename F>
+static auto read_seqlocked(const std::atomic<uint32_t>& sequence_counter, F&& read_func) {
+    while (true) {
+        uint32_t sequence = sequence_counter.load(std::memory_order_acquire);
+        // An odd sequence means the writer is in the middle of an update.
+        if (sequence & 1) {
+            continue;
+        }
+
+        auto ret = read_func();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_counter.load(std::memory_order_relaxed) == sequence) {
+            return ret;
+        }
+    }
+}
+
+template <typename F>
+static auto read_input_snapshot(F&& read_func) {
+    return read_seqlocked(InputSnapshot.sequence, std::forward<F>(read_func));
+}
+
 std::atomic<recomp::InputDevice> scanning_device = recomp::InputDevice::COUNT;
 std::atomic<recomp::InputField> scanned_input;
 
@@ -83,6 +137,18 @@ void queue_if_enabled(SDL_Event* event) {
     }
 }
 
+// Starts a latency probe for an event of the given input that's about to reach the game.
+void begin_latency_probe_if_enabled(const SDL_Event* event, recomp::InputField input) {
+    if (!zelda64::is_latency_probe_enabled() || recomp::game_input_disabled() || !ultramodern::is_game_started()) {
+        return;
+    }
+
+    // Event timestamps come from SDL_GetTicks, so they can be compared directly. Wrap the difference instead of
+    // treating it as negative in case the event was timestamped after the ticks were read.
+    int32_t event_age_ms = int32_t(SDL_GetTicks() - event->common.timestamp);
+    zelda64::begin_latency_probe(uint32_t(std::max(event_age_ms, 0)), input);
+}
+
 static std::atomic_bool cursor_enabled = true;
 
 void recompui::set_cursor_visible(bool visible) {
@@ -100,6 +166,21 @@ bool should_override_keystate(SDL_Scancode key, SDL_Keymod mod) {
     return false;        
 }
 
+// Rebuilds the list of controllers that get sampled. Only called from the event thread when a controller is added or
+// removed, so sampling doesn't have to look at every open controller.
+static void update_cur_controllers() {
+    std::lock_guard lock{ InputState.cur_controllers_mutex };
+    InputState.cur_controllers.clear();
+
+    for (const auto& [id, state] : InputState.controller_states) {
+        (void)id; // Avoid unused variable warning.
+        SDL_GameController* controller = state.controller;
+        if (controller != nullptr) {
+            InputState.cur_controllers.push_back(controller);
+        }
+    }
+}
+
 bool sdl_event_filter(void* userdata, SDL_Event* event) {
     switch (event->type) {
     case SDL_EventType::SDL_KEYDOWN:
@@ -125,6 +206,10 @@ bool sdl_event_filter(void* userdata, SDL_Event* event) {
                 }
             } else {
                 if (!should_override_keystate(keyevent->keysym.scancode, static_cast<SDL_Keymod>(keyevent->keysym.mod))) {
+                    // A key repeat isn't a new press, so it never starts a probe, even while the menu takes repeats.
+                    if (!event->key.repeat) {
+                        begin_latency_probe_if_enabled(event, {(uint32_t)InputType::Keyboard, keyevent->keysym.scancode});
+                    }
                     queue_if_enabled(event);
                 }
             }
@@ -139,6 +224,7 @@ bool sdl_event_filter(void* userdata, SDL_Event* event) {
                 printf("  Instance ID: %d\n", SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(controller)));
                 ControllerState& state = InputState.controller_states[SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(controller))];
                 state.controller = controller;
+                update_cur_controllers();
 
                 if (SDL_GameControllerHasSensor(controller, SDL_SensorType::SDL_SENSOR_GYRO) && SDL_GameControllerHasSensor(controller, SDL_SensorType::SDL_SENSOR_ACCEL)) {
                     SDL_GameControllerSetSensorEnabled(controller, SDL_SensorType::SDL_SENSOR_GYRO, SDL_TRUE);
@@ -152,6 +238,7 @@ bool sdl_event_filter(void* userdata, SDL_Event* event) {
             SDL_ControllerDeviceEvent* controller_event = &event->cdevice;
             printf("Controller removed: %d\n", controller_event->which);
             InputState.controller_states.erase(controller_event->which);
+            update_cur_controllers();
         }
         break;
     case SDL_EventType::SDL_QUIT: {
@@ -195,6 +282,7 @@ bool sdl_event_filter(void* userdata, SDL_Event* event) {
                 set_scanned_input({(uint32_t)InputType::ControllerDigital, button_event->button});
             }
         } else {
+            begin_latency_probe_if_enabled(event, {(uint32_t)InputType::ControllerDigital, event->cbutton.button});
             queue_if_enabled(event);
         }
         break;
@@ -230,6 +318,17 @@ bool sdl_event_filter(void* userdata, SDL_Event* event) {
                 set_scanned_input({(uint32_t)InputType::ControllerAnalog, -axis_event->axis - 1});
             }
         } else {
+            // Only probe axes as they cross the threshold, otherwise every bit of stick motion would start a probe.
+            static std::array<bool, SDL_CONTROLLER_AXIS_MAX> axis_past_threshold{};
+            SDL_ControllerAxisEvent* axis_event = &event->caxis;
+            if (axis_event->axis >= 0 && axis_event->axis < SDL_CONTROLLER_AXIS_MAX) {
+                bool past_threshold = std::abs(axis_event->value * (1/32768.0f)) > axis_threshold;
+                if (past_threshold && !axis_past_threshold[axis_event->axis]) {
+                    int32_t axis_id = axis_event->axis + 1;
+                    begin_latency_probe_if_enabled(event, {(uint32_t)InputType::ControllerAnalog, axis_event->value < 0 ? -axis_id : axis_id});
+                }
+                axis_past_threshold[axis_event->axis] = past_threshold;
+            }
             queue_if_enabled(event);
         }
         break;
@@ -252,28 +351,37 @@ bool sdl_event_filter(void* userdata, SDL_Event* event) {
             float y = event->csensor.data[1] * rad_to_deg;
             float z = event->csensor.data[2] * rad_to_deg;
             ControllerState& state = InputState.controller_states[event->csensor.which];
-            uint64_t cur_timestamp = event->csensor.timestamp;
-            uint32_t delta_ms = cur_timestamp - state.prev_gyro_timestamp;
-            state.motion.ProcessMotion(x, y, z, state.latest_accelerometer[0], state.latest_accelerometer[1], state.latest_accelerometer[2], delta_ms * 0.001f);
+            uint64_t cur_timestamp = uint64_t(event->csensor.timestamp) * 1000;
+#if SDL_VERSION_ATLEAST(2, 26, 0)
+            // Use the sensor's own timestamp when it has one, which is exact even if the events arrive in bursts.
+            if (event->csensor.timestamp_us != 0) {
+                cur_timestamp = event->csensor.timestamp_us;
+            }
+#endif
+            float delta_seconds = 0.0f;
+            if (state.prev_gyro_timestamp != 0 && cur_timestamp > state.prev_gyro_timestamp) {
+                delta_seconds = std::min((cur_timestamp - state.prev_gyro_timestamp) * 1e-6f, max_gyro_sample_interval);
+            }
+            state.motion.ProcessMotion(x, y, z, state.latest_accelerometer[0], state.latest_accelerometer[1], state.latest_accelerometer[2], delta_seconds);
             state.prev_gyro_timestamp = cur_timestamp;
 
             float rot_x = 0.0f;
             float rot_y = 0.0f;
             state.motion.GetPlayerSpaceGyro(rot_x, rot_y);
 
-            {
-                std::lock_guard lock{ InputState.pending_input_mutex };
-                InputState.pending_rotation_delta[0] += rot_x;
-                InputState.pending_rotation_delta[1] += rot_y;
+            float scale = rotation_fixed_point_scale;
+            if (gyro_rate_independent.load(std::memory_order_relaxed)) {
+                scale *= delta_seconds * gyro_reference_rate;
             }
+            InputState.pending_rotation_delta[0].fetch_add(std::llround(rot_x * scale), std::memory_order_relaxed);
+            InputState.pending_rotation_delta[1].fetch_add(std::llround(rot_y * scale), std::memory_order_relaxed);
         }
         break;
     case SDL_EventType::SDL_MOUSEMOTION:
         if (!recomp::game_input_disabled()) {
             SDL_MouseMotionEvent* motion_event = &event->motion;
-            std::lock_guard lock{ InputState.pending_input_mutex };
-            InputState.pending_mouse_delta[0] += motion_event->xrel;
-            InputState.pending_mouse_delta[1] += motion_event->yrel;
+            InputState.pending_mouse_delta[0].fetch_add(motion_event->xrel, std::memory_order_relaxed);
+            InputState.pending_mouse_delta[1].fetch_add(motion_event->yrel, std::memory_order_relaxed);
         }
         queue_if_enabled(event);
         break;
@@ -298,10 +406,61 @@ bool sdl_event_filter(void* userdata, SDL_Event* event) {
     return false;
 }
 
+static void sample_inputs() {
+    int numkeys = 0;
+    const Uint8* keys = SDL_GetKeyboardState(&numkeys);
+    numkeys = std::min(numkeys, int(SDL_NUM_SCANCODES));
+    SDL_Keymod keymod = SDL_GetModState();
+
+    uint32_t buttons = 0;
+    std::array<std::array<float, 2>, SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_MAX> axes{};
+    {
+        std::lock_guard lock{ InputState.cur_controllers_mutex };
+
+        // Sample every controller once so the binding queries don't have to.
+        for (const auto& controller : InputState.cur_controllers) {
+            for (int button = 0; button < SDL_GameControllerButton::SDL_CONTROLLER_BUTTON_MAX; button++) {
+                if (SDL_GameControllerGetButton(controller, (SDL_GameControllerButton)button)) {
+                    buttons |= 1u << button;
+                }
+            }
+
+            for (int axis = 0; axis < SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_MAX; axis++) {
+                float cur_val = SDL_GameControllerGetAxis(controller, (SDL_GameControllerAxis)axis) * (1/32768.0f);
+                axes[axis][0] += std::clamp(cur_val, 0.0f, 1.0f);
+                axes[axis][1] += std::clamp(-cur_val, 0.0f, 1.0f);
+            }
+        }
+    }
+
+    // Publish the snapshot.
+    uint32_t sequence = InputSnapshot.sequence.load(std::memory_order_relaxed);
+    InputSnapshot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int i = 0; i < SDL_NUM_SCANCODES; i++) {
+        InputSnapshot.keys[i].store(i < numkeys ? keys[i] : 0, std::memory_order_relaxed);
+    }
+    InputSnapshot.keymod.store(keymod, std::memory_order_relaxed);
+    InputSnapshot.buttons.store(buttons, std::memory_order_relaxed);
+    for (int axis = 0; axis < SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_MAX; axis++) {
+        InputSnapshot.axes[axis][0].store(std::clamp(axes[axis][0], 0.0f, 1.0f), std::memory_order_relaxed);
+        InputSnapshot.axes[axis][1].store(std::clamp(axes[axis][1], 0.0f, 1.0f), std::memory_order_relaxed);
+    }
+    InputSnapshot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
 void recomp::handle_events() {
     SDL_Event cur_event;
     static bool started = false;
     static bool exited = false;
+
+    // Close the game on its own once an unattended replay is over.
+    static bool replay_quit = false;
+    if (!replay_quit && zelda64::is_input_replay_finished()) {
+        replay_quit = true;
+        ultramodern::quit();
+    }
+
     while (SDL_PollEvent(&cur_event) && !exited) {
         exited = sdl_event_filter(nullptr, &cur_event);
 
@@ -318,6 +477,10 @@ void recomp::handle_events() {
         SDL_SetRelativeMouseMode(cursor_locked ? SDL_TRUE : SDL_FALSE);
     }
 
+    // SDL only updates the keyboard and controller state when events are pumped, so publish it right after. The game
+    // reads whatever was published last when it polls.
+    sample_inputs();
+
     if (!started && ultramodern::is_game_started()) {
         started = true;
         recompui::process_game_started();
@@ -467,50 +630,46 @@ const recomp::DefaultN64Mappings recomp::default_n64_controller_mappings = {
 };
 
 void recomp::poll_inputs() {
-    InputState.keys = SDL_GetKeyboardState(&InputState.numkeys);
-    InputState.keymod = SDL_GetModState();
-
-    {
-        std::lock_guard lock{ InputState.cur_controllers_mutex };
-        InputState.cur_controllers.clear();
-
-        for (const auto& [id, state] : InputState.controller_states) {
-            (void)id; // Avoid unused variable warning.
-            SDL_GameController* controller = state.controller;
-            if (controller != nullptr) {
-                InputState.cur_controllers.push_back(controller);
-            }
-        }
-    }
-
     // Read the deltas while resetting them to zero.
-    {
-        std::lock_guard lock{ InputState.pending_input_mutex };
-        
-        InputState.rotation_delta = InputState.pending_rotation_delta;
-        InputState.pending_rotation_delta = { 0.0f, 0.0f };
-
-        InputState.mouse_delta = InputState.pending_mouse_delta;
-        InputState.pending_mouse_delta = { 0.0f, 0.0f };
+    for (size_t i = 0; i < 2; i++) {
+        InputState.rotation_delta[i] = InputState.pending_rotation_delta[i].exchange(0, std::memory_order_relaxed) / rotation_fixed_point_scale;
+        InputState.mouse_delta[i] = float(InputState.pending_mouse_delta[i].exchange(0, std::memory_order_relaxed));
     }
     
-    // Quicksaving is disabled for now and will likely have more limited functionality
-    // when restored, rather than allowing saving and loading at any point in time.
-    #if 0
-    if (InputState.keys) {
+    // F5 quicksaves and F7 loads the quicksave. The action happens once the game's threads get to their quicksave
+    // handlers, which is at most a frame later. Rewind points are recorded from the first quicksave on, and holding F6
+    // steps back through them. F9 and F10 do the same as F5 and F7 with a savestate file in the app folder.
+    {
         static bool save_was_held = false;
         static bool load_was_held = false;
-        bool save_is_held = InputState.keys[SDL_SCANCODE_F5] != 0;
-        bool load_is_held = InputState.keys[SDL_SCANCODE_F7] != 0;
+        static bool save_file_was_held = false;
+        static bool load_file_was_held = false;
+        bool save_is_held = InputSnapshot.keys[SDL_SCANCODE_F5] != 0;
+        bool load_is_held = InputSnapshot.keys[SDL_SCANCODE_F7] != 0;
+        bool rewind_is_held = InputSnapshot.keys[SDL_SCANCODE_F6] != 0;
+        bool save_file_is_held = InputSnapshot.keys[SDL_SCANCODE_F9] != 0;
+        bool load_file_is_held = InputSnapshot.keys[SDL_SCANCODE_F10] != 0;
         if (save_is_held && !save_was_held) {
             zelda64::quicksave_save();
+            zelda64::set_rewind_enabled(true);
         }
         else if (load_is_held && !load_was_held) {
             zelda64::quicksave_load();
         }
+        else if (save_file_is_held && !save_file_was_held) {
+            zelda64::savestate_save(zelda64::get_app_folder_path() / "sf64.state");
+        }
+        else if (load_file_is_held && !load_file_was_held) {
+            zelda64::savestate_load(zelda64::get_app_folder_path() / "sf64.state");
+        }
+        else if (rewind_is_held) {
+            zelda64::rewind(1);
+        }
         save_was_held = save_is_held;
+        load_was_held = load_is_held;
+        save_file_was_held = save_file_is_held;
+        load_file_was_held = load_file_is_held;
     }
-    #endif
 }
 
 void recomp::set_rumble(int controller_num, bool on) {
@@ -562,18 +721,11 @@ void recomp::update_rumble() {
     }
 }
 
+// These read single fields of the snapshot and are only called from within read_input_snapshot.
 bool controller_button_state(int32_t input_id) {
     if (input_id >= 0 && input_id < SDL_GameControllerButton::SDL_CONTROLLER_BUTTON_MAX) {
-        SDL_GameControllerButton button = (SDL_GameControllerButton)input_id;
-        bool ret = false;
-        {
-            std::lock_guard lock{ InputState.cur_controllers_mutex };
-            for (const auto& controller : InputState.cur_controllers) {
-                ret |= SDL_GameControllerGetButton(controller, button);
-            }
-        }
-
-        return ret;
+        uint32_t buttons = InputSnapshot.buttons.load(std::memory_order_relaxed);
+        return (buttons >> input_id) & 1;
     }
     return false;
 }
@@ -581,43 +733,36 @@ bool controller_button_state(int32_t input_id) {
 static std::atomic_bool right_analog_suppressed = false;
 
 float controller_axis_state(int32_t input_id, bool allow_suppression) {
-    if (abs(input_id) - 1 < SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_MAX) {
+    if (input_id != 0 && abs(input_id) - 1 < SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_MAX) {
         SDL_GameControllerAxis axis = (SDL_GameControllerAxis)(abs(input_id) - 1);
         bool negative_range = input_id < 0;
-        float ret = 0.0f;
-
-        {
-            std::lock_guard lock{ InputState.cur_controllers_mutex };
-            for (const auto& controller : InputState.cur_controllers) {
-                float cur_val = SDL_GameControllerGetAxis(controller, axis) * (1/32768.0f);
-                if (negative_range) {
-                    cur_val = -cur_val;
-                }
 
-                // Check if this input is a right analog axis and suppress it accordingly.
-                if (allow_suppression && right_analog_suppressed.load() &&
-                    (axis == SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_RIGHTX || axis == SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_RIGHTY)) {
-                    cur_val = 0;
-                }
-                ret += std::clamp(cur_val, 0.0f, 1.0f);
-            }
+        // Check if this input is a right analog axis and suppress it accordingly.
+        if (allow_suppression && right_analog_suppressed.load() &&
+            (axis == SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_RIGHTX || axis == SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_RIGHTY)) {
+            return 0.0f;
         }
 
-        return std::clamp(ret, 0.0f, 1.0f);
+        return InputSnapshot.axes[axis][negative_range ? 1 : 0].load(std::memory_order_relaxed);
     }
     return false;
 }
 
-float recomp::get_input_analog(const recomp::InputField& field) {
+static bool keyboard_key_state(int32_t input_id) {
+    if (input_id >= 0 && input_id < SDL_NUM_SCANCODES) {
+        SDL_Keymod keymod = (SDL_Keymod)InputSnapshot.keymod.load(std::memory_order_relaxed);
+        if (should_override_keystate(static_cast<SDL_Scancode>(input_id), keymod)) {
+            return false;
+        }
+        return InputSnapshot.keys[input_id].load(std::memory_order_relaxed) != 0;
+    }
+    return false;
+}
+
+static float get_input_analog_unlocked(const recomp::InputField& field) {
     switch ((InputType)field.input_type) {
     case InputType::Keyboard:
-        if (InputState.keys && field.input_id >= 0 && field.input_id < InputState.numkeys) {
-            if (should_override_keystate(static_cast<SDL_Scancode>(field.input_id), InputState.keymod)) {
-                return 0.0f;
-            }
-            return InputState.keys[field.input_id] ? 1.0f : 0.0f;
-        }
-        return 0.0f;
+        return keyboard_key_state(field.input_id) ? 1.0f : 0.0f;
     case InputType::ControllerDigital:
         return controller_button_state(field.input_id) ? 1.0f : 0.0f;
     case InputType::ControllerAnalog:
@@ -630,24 +775,25 @@ float recomp::get_input_analog(const recomp::InputField& field) {
     }
 }
 
+float recomp::get_input_analog(const recomp::InputField& field) {
+    return read_input_snapshot([&]() { return get_input_analog_unlocked(field); });
+}
+
 float recomp::get_input_analog(const std::span<const recomp::InputField> fields) {
-    float ret = 0.0f;
-    for (const auto& field : fields) {
-        ret += get_input_analog(field);
-    }
-    return std::clamp(ret, 0.0f, 1.0f);
+    // All the fields are read from the same snapshot.
+    return read_input_snapshot([&]() {
+        float ret = 0.0f;
+        for (const auto& field : fields) {
+            ret += get_input_analog_unlocked(field);
+        }
+        return std::clamp(ret, 0.0f, 1.0f);
+    });
 }
 
-bool recomp::get_input_digital(const recomp::InputField& field) {
+static bool get_input_digital_unlocked(const recomp::InputField& field) {
     switch ((InputType)field.input_type) {
     case InputType::Keyboard:
-        if (InputState.keys && field.input_id >= 0 && field.input_id < InputState.numkeys) {
-            if (should_override_keystate(static_cast<SDL_Scancode>(field.input_id), InputState.keymod)) {
-                return false;
-            }
-            return InputState.keys[field.input_id] != 0;
-        }
-        return false;
+        return keyboard_key_state(field.input_id);
     case InputType::ControllerDigital:
         return controller_button_state(field.input_id);
     case InputType::ControllerAnalog:
@@ -661,12 +807,260 @@ bool recomp::get_input_digital(const recomp::InputField& field) {
     }
 }
 
+bool recomp::get_input_digital(const recomp::InputField& field) {
+    return read_input_snapshot([&]() { return get_input_digital_unlocked(field); });
+}
+
 bool recomp::get_input_digital(const std::span<const recomp::InputField> fields) {
-    bool ret = 0;
-    for (const auto& field : fields) {
-        ret |= get_input_digital(field);
+    return read_input_snapshot([&]() {
+        bool ret = 0;
+        for (const auto& field : fields) {
+            ret |= get_input_digital_unlocked(field);
+        }
+        return ret;
+    });
+}
+
+// Make the button value array, which maps a button index to its bit field.
+#define DEFINE_INPUT(name, value, readable) uint16_t(value##u),
+static const std::array n64_button_values = {
+    DEFINE_N64_BUTTON_INPUTS()
+};
+#undef DEFINE_INPUT
+
+// The N64 bindings of both devices compiled into a flat table. Every distinct key, button or axis direction that's
+// bound to something becomes a source, which is sampled once per evaluation. Buttons are then a mask over the
+// digital state of the sources and the stick is a list of sources to add up per direction.
+enum class CompiledSourceType : uint8_t {
+    Key,
+    Button,
+    Axis
+};
+
+struct CompiledSource {
+    CompiledSourceType type;
+    // Whether the key is Enter, which is ignored while Alt is held so Alt+Enter can toggle fullscreen.
+    bool alt_override : 1;
+    bool suppressible : 1;
+    // Scancode, button or axis index times two plus one for the negative range.
+    uint16_t index;
+};
+
+// Analog targets, which are the N64 axis inputs for the controller followed by the ones for the keyboard.
+enum class CompiledAnalogTarget : uint8_t {
+    ControllerXPos,
+    ControllerXNeg,
+    ControllerYPos,
+    ControllerYNeg,
+    KeyboardXPos,
+    KeyboardXNeg,
+    KeyboardYPos,
+    KeyboardYNeg,
+    Count
+};
+
+struct CompiledAnalog {
+    uint8_t source;
+    CompiledAnalogTarget target;
+};
+
+// Every input has at most bindings_per_input fields on each device, so the digital sources always fit in the mask.
+constexpr size_t max_compiled_sources = (n64_button_values.size() + 4) * recomp::bindings_per_input * size_t(recomp::InputDevice::COUNT);
+constexpr size_t max_compiled_analogs = size_t(CompiledAnalogTarget::Count) * recomp::bindings_per_input;
+static_assert(n64_button_values.size() * recomp::bindings_per_input * size_t(recomp::InputDevice::COUNT) <= 64, "Too many digital bindings for the source mask");
+static_assert(max_compiled_sources <= UINT8_MAX, "Compiled analogs index their source with a byte");
+
+// The table that evaluate_n64_bindings reads, published through a seqlock like InputSnapshot so that evaluating the
+// bindings never waits on a binding being changed from the menu. compile_n64_bindings builds a new table first and only
+// copies it in here once it's done.
+static struct {
+    std::atomic<uint32_t> sequence = 0;
+    // Keeps two compile_n64_bindings calls from publishing at the same time. Readers never take it.
+    std::mutex writer_mutex;
+    std::atomic<uint8_t> source_count = 0;
+    std::atomic<uint8_t> digital_source_count = 0;
+    std::atomic<uint8_t> analog_count = 0;
+    std::array<std::atomic<CompiledSource>, max_compiled_sources> sources{};
+    std::array<std::atomic<uint64_t>, n64_button_values.size()> button_masks{};
+    std::array<std::atomic<CompiledAnalog>, max_compiled_analogs> analogs{};
+} CompiledBindings;
+
+static bool compile_source(const recomp::InputField& field, CompiledSource& source) {
+    switch ((InputType)field.input_type) {
+    case InputType::Keyboard:
+        if (field.input_id < 0 || field.input_id >= SDL_NUM_SCANCODES) {
+            return false;
+        }
+        source = { .type = CompiledSourceType::Key, .alt_override = field.input_id == SDL_Scancode::SDL_SCANCODE_RETURN, .index = uint16_t(field.input_id) };
+        return true;
+    case InputType::ControllerDigital:
+        if (field.input_id < 0 || field.input_id >= SDL_GameControllerButton::SDL_CONTROLLER_BUTTON_MAX) {
+            return false;
+        }
+        source = { .type = CompiledSourceType::Button, .index = uint16_t(field.input_id) };
+        return true;
+    case InputType::ControllerAnalog:
+        {
+            if (field.input_id == 0 || abs(field.input_id) - 1 >= SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_MAX) {
+                return false;
+            }
+            int axis = abs(field.input_id) - 1;
+            source = {
+                .type = CompiledSourceType::Axis,
+                .suppressible = axis == SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_RIGHTX || axis == SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_RIGHTY,
+                .index = uint16_t(axis * 2 + (field.input_id < 0 ? 1 : 0))
+            };
+            return true;
+        }
+    case InputType::Mouse:
+    case InputType::None:
+        return false;
     }
-    return ret;
+    return false;
+}
+
+static size_t add_compiled_source(std::vector<CompiledSource>& sources, const CompiledSource& source) {
+    for (size_t i = 0; i < sources.size(); i++) {
+        if (sources[i].type == source.type && sources[i].index == source.index) {
+            return i;
+        }
+    }
+
+    sources.emplace_back(source);
+    return sources.size() - 1;
+}
+
+void recomp::compile_n64_bindings() {
+    constexpr std::array devices = { recomp::InputDevice::Controller, recomp::InputDevice::Keyboard };
+    std::vector<CompiledSource> sources;
+    std::array<uint64_t, n64_button_values.size()> button_masks{};
+    std::vector<CompiledAnalog> analogs;
+
+    // Digital sources go first so that their indices fit in the button masks.
+    for (size_t i = 0; i < n64_button_values.size(); i++) {
+        recomp::GameInput input = (recomp::GameInput)((size_t)recomp::GameInput::N64_BUTTON_START + i);
+        for (recomp::InputDevice device : devices) {
+            for (size_t binding_index = 0; binding_index < recomp::bindings_per_input; binding_index++) {
+                CompiledSource source;
+                if (compile_source(recomp::get_input_binding(input, binding_index, device), source)) {
+                    button_masks[i] |= uint64_t(1) << add_compiled_source(sources, source);
+                }
+            }
+        }
+    }
+
+    size_t digital_source_count = sources.size();
+
+    constexpr std::array axis_inputs = {
+        recomp::GameInput::X_AXIS_POS, recomp::GameInput::X_AXIS_NEG, recomp::GameInput::Y_AXIS_POS, recomp::GameInput::Y_AXIS_NEG
+    };
+    for (size_t device_index = 0; device_index < devices.size(); device_index++) {
+        for (size_t axis_index = 0; axis_index < axis_inputs.size(); axis_index++) {
+            for (size_t binding_index = 0; binding_index < recomp::bindings_per_input; binding_index++) {
+                CompiledSource source;
+                if (compile_source(recomp::get_input_binding(axis_inputs[axis_index], binding_index, devices[device_index]), source)) {
+                    analogs.emplace_back(CompiledAnalog{
+                        .source = uint8_t(add_compiled_source(sources, source)),
+                        .target = CompiledAnalogTarget(device_index * axis_inputs.size() + axis_index)
+                    });
+                }
+            }
+        }
+    }
+
+    // Publish the table.
+    std::lock_guard lock{ CompiledBindings.writer_mutex };
+    uint32_t sequence = CompiledBindings.sequence.load(std::memory_order_relaxed);
+    CompiledBindings.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    CompiledBindings.source_count.store(uint8_t(sources.size()), std::memory_order_relaxed);
+    CompiledBindings.digital_source_count.store(uint8_t(digital_source_count), std::memory_order_relaxed);
+    CompiledBindings.analog_count.store(uint8_t(analogs.size()), std::memory_order_relaxed);
+    for (size_t i = 0; i < sources.size(); i++) {
+        CompiledBindings.sources[i].store(sources[i], std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < button_masks.size(); i++) {
+        CompiledBindings.button_masks[i].store(button_masks[i], std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < analogs.size(); i++) {
+        CompiledBindings.analogs[i].store(analogs[i], std::memory_order_relaxed);
+    }
+    CompiledBindings.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+recomp::N64PadState recomp::evaluate_n64_bindings() {
+    std::array<CompiledSource, max_compiled_sources> sources;
+    std::array<uint64_t, n64_button_values.size()> button_masks;
+    std::array<CompiledAnalog, max_compiled_analogs> analogs;
+    size_t source_count;
+    size_t digital_source_count;
+    size_t analog_count;
+    read_seqlocked(CompiledBindings.sequence, [&]() {
+        source_count = CompiledBindings.source_count.load(std::memory_order_relaxed);
+        digital_source_count = CompiledBindings.digital_source_count.load(std::memory_order_relaxed);
+        analog_count = CompiledBindings.analog_count.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < source_count; i++) {
+            sources[i] = CompiledBindings.sources[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < button_masks.size(); i++) {
+            button_masks[i] = CompiledBindings.button_masks[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < analog_count; i++) {
+            analogs[i] = CompiledBindings.analogs[i].load(std::memory_order_relaxed);
+        }
+        return true;
+    });
+
+    std::array<float, max_compiled_sources> values;
+    std::array<float, static_cast<size_t>(CompiledAnalogTarget::Count)> sums{};
+    bool suppressed = right_analog_suppressed.load();
+
+    uint64_t digital = read_input_snapshot([&]() {
+        SDL_Keymod keymod = (SDL_Keymod)InputSnapshot.keymod.load(std::memory_order_relaxed);
+        bool alt_held = (keymod & SDL_Keymod::KMOD_ALT) != 0;
+        uint64_t digital = 0;
+        for (size_t i = 0; i < source_count; i++) {
+            const CompiledSource& source = sources[i];
+            float value;
+            switch (source.type) {
+            case CompiledSourceType::Key:
+                value = (InputSnapshot.keys[source.index].load(std::memory_order_relaxed) != 0 && !(source.alt_override && alt_held)) ? 1.0f : 0.0f;
+                break;
+            case CompiledSourceType::Button:
+                value = ((InputSnapshot.buttons.load(std::memory_order_relaxed) >> source.index) & 1) ? 1.0f : 0.0f;
+                break;
+            case CompiledSourceType::Axis:
+                value = (source.suppressible && suppressed) ? 0.0f : InputSnapshot.axes[source.index / 2][source.index % 2].load(std::memory_order_relaxed);
+                break;
+            }
+
+            values[i] = value;
+            if (i < digital_source_count) {
+                digital |= uint64_t(source.type == CompiledSourceType::Axis ? value >= axis_threshold : value != 0.0f) << i;
+            }
+        }
+        return digital;
+    });
+
+    recomp::N64PadState state{};
+    for (size_t i = 0; i < n64_button_values.size(); i++) {
+        state.buttons |= (digital & button_masks[i]) ? n64_button_values[i] : 0;
+    }
+
+    for (size_t i = 0; i < analog_count; i++) {
+        sums[static_cast<size_t>(analogs[i].target)] += values[analogs[i].source];
+    }
+
+    for (float& sum : sums) {
+        sum = std::clamp(sum, 0.0f, 1.0f);
+    }
+
+    auto sum = [&](CompiledAnalogTarget target) { return sums[static_cast<size_t>(target)]; };
+    state.joystick_x = sum(CompiledAnalogTarget::ControllerXPos) - sum(CompiledAnalogTarget::ControllerXNeg);
+    state.joystick_y = sum(CompiledAnalogTarget::ControllerYPos) - sum(CompiledAnalogTarget::ControllerYNeg);
+    state.keyboard_x = sum(CompiledAnalogTarget::KeyboardXPos) - sum(CompiledAnalogTarget::KeyboardXNeg);
+    state.keyboard_y = sum(CompiledAnalogTarget::KeyboardYPos) - sum(CompiledAnalogTarget::KeyboardYNeg);
+    return state;
 }
 
 void recomp::get_gyro_deltas(float* x, float* y) {
@@ -676,6 +1070,14 @@ void recomp::get_gyro_deltas(float* x, float* y) {
     *y = cur_rotation_delta[1] * sensitivity;
 }
 
+bool recomp::get_gyro_rate_independent() {
+    return gyro_rate_independent.load();
+}
+
+void recomp::set_gyro_rate_independent(bool enabled) {
+    gyro_rate_independent.store(enabled);
+}
+
 void recomp::get_mouse_deltas(float* x, float* y) {
     std::array<float, 2> cur_mouse_delta = InputState.mouse_delta;
     float sensitivity = (float)recomp::get_mouse_sensitivity() / 100.0f;
@@ -719,12 +1121,13 @@ void recomp::apply_joystick_deadzone(float x_in, float y_in, float* x_out, float
 }
 
 void recomp::get_right_analog(float* x, float* y) {
-    float x_val =
-        controller_axis_state((SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_RIGHTX + 1), false) -
-        controller_axis_state(-(SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_RIGHTX + 1), false);
-    float y_val =
-        controller_axis_state((SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_RIGHTY + 1), false) -
-        controller_axis_state(-(SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_RIGHTY + 1), false);
+    auto [x_val, y_val] = read_input_snapshot([]() {
+        return std::make_pair(
+            controller_axis_state((SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_RIGHTX + 1), false) -
+            controller_axis_state(-(SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_RIGHTX + 1), false),
+            controller_axis_state((SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_RIGHTY + 1), false) -
+            controller_axis_state(-(SDL_GameControllerAxis::SDL_CONTROLLER_AXIS_RIGHTY + 1), false));
+    });
     recomp::apply_joystick_deadzone(x_val, y_val, x, y);
 }
 
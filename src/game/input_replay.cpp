@@ -0,0 +1,388 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "zelda_replay.h"
+#include "librecomp/helpers.hpp"
+
+// Builds with RECOMP_COUNT_ALLOCATIONS count calls to the global operator new while a replay is running, so
+// regressions in allocation churn show up in the report alongside the frame times. Only C++ allocations through the
+// plain operator new are seen, anything that calls malloc directly (SDL, RT64, miniz) or uses aligned new isn't.
+// Counting is off outside of replays, which leaves a single relaxed load per allocation.
+static std::atomic<bool> counting_allocations = false;
+static std::atomic<uint64_t> allocation_count = 0;
+
+#ifdef RECOMP_COUNT_ALLOCATIONS
+constexpr bool allocations_counted = true;
+
+void* operator new(std::size_t size) {
+    if (counting_allocations.load(std::memory_order_relaxed)) {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (size == 0) {
+        size = 1;
+    }
+
+    while (true) {
+        void* ptr = std::malloc(size);
+        if (ptr != nullptr) {
+            return ptr;
+        }
+
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+#else
+constexpr bool allocations_counted = false;
+#endif
+
+namespace zelda64 {
+    constexpr char input_replay_magic[8] = { 'S', 'F', '6', '4', 'I', 'N', 'P', 'T' };
+    constexpr uint32_t input_replay_version = 1;
+
+    // Every record starts with one of these tags. The file is written in the host's byte order.
+    enum class InputReplayTag : uint8_t {
+        // Number of consecutive reads that returned the same pad state, followed by the state.
+        PadRun = 'P',
+        // Index of the read the seeds were taken before, followed by the three RNG seeds.
+        Seeds = 'S',
+    };
+
+    struct InputReplayPad {
+        uint16_t buttons;
+        float x;
+        float y;
+
+        bool operator==(const InputReplayPad& rhs) const = default;
+    };
+
+    struct InputReplayRun {
+        uint32_t count;
+        InputReplayPad pad;
+    };
+
+    struct InputReplaySeeds {
+        uint32_t read_index;
+        std::array<int32_t, 3> seeds;
+    };
+
+    struct InputReplayLevelStats {
+        std::vector<uint32_t> frame_times_us;
+        uint64_t allocations = 0;
+    };
+
+    // Must match LevelId in the decomp.
+    static const char* level_names[] = {
+        "Corneria", "Meteo", "Sector X", "Area 6", "Unknown 4", "Sector Y", "Venom 1", "Solar", "Zoness",
+        "Venom Andross", "Training", "Macbeth", "Titania", "Aquas", "Fortuna", "Unknown 15", "Katina", "Bolse",
+        "Sector Z", "Venom 2", "Versus",
+    };
+
+    struct InputReplayState {
+        std::mutex mutex;
+        std::atomic<InputReplayMode> mode = InputReplayMode::None;
+        std::filesystem::path path;
+        uint32_t read_count = 0;
+
+        // Recording.
+        std::ofstream output;
+        InputReplayRun current_run{};
+
+        // Replaying.
+        std::vector<InputReplayRun> runs;
+        std::vector<InputReplaySeeds> seeds;
+        size_t next_run = 0;
+        uint32_t run_offset = 0;
+        size_t next_seeds = 0;
+        std::atomic<bool> finished = false;
+        bool frame_started = false;
+        std::chrono::steady_clock::time_point replay_start;
+        std::chrono::steady_clock::time_point frame_start;
+        uint64_t frame_start_allocations = 0;
+        std::map<int32_t, InputReplayLevelStats> level_stats;
+    };
+
+    static InputReplayState input_replay{};
+
+    template <typename T>
+    static void write_value(std::ofstream& stream, const T& value) {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    static bool read_value(const std::vector<char>& bytes, size_t& offset, T& value) {
+        if (bytes.size() - offset < sizeof(value)) {
+            return false;
+        }
+
+        std::memcpy(&value, bytes.data() + offset, sizeof(value));
+        offset += sizeof(value);
+        return true;
+    }
+
+    static void flush_current_run() {
+        if (input_replay.current_run.count == 0) {
+            return;
+        }
+
+        write_value(input_replay.output, InputReplayTag::PadRun);
+        write_value(input_replay.output, input_replay.current_run.count);
+        write_value(input_replay.output, input_replay.current_run.pad.buttons);
+        write_value(input_replay.output, input_replay.current_run.pad.x);
+        write_value(input_replay.output, input_replay.current_run.pad.y);
+        input_replay.current_run.count = 0;
+    }
+
+    static std::string get_level_name(int32_t level) {
+        if (level < 0) {
+            return "Outside levels";
+        }
+        if (size_t(level) < std::size(level_names)) {
+            return level_names[level];
+        }
+        return "Level " + std::to_string(level);
+    }
+
+    static void write_replay_report() {
+        double wall_time_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - input_replay.replay_start).count();
+        std::filesystem::path report_path = input_replay.path;
+        report_path += ".report.csv";
+
+        std::ofstream stream(report_path);
+        // The operator new column is left empty in builds that don't count allocations.
+        auto new_calls = [](uint64_t count) { return allocations_counted ? std::to_string(count) : std::string{}; };
+        stream << "level,frames,min_ms,median_ms,p95_ms,max_ms,operator_new_calls\n";
+
+        uint64_t total_frames = 0;
+        uint64_t total_allocations = 0;
+        for (auto& [level, stats] : input_replay.level_stats) {
+            std::vector<uint32_t>& times = stats.frame_times_us;
+            if (times.empty()) {
+                continue;
+            }
+
+            std::sort(times.begin(), times.end());
+            auto to_ms = [](uint32_t us) { return us / 1000.0; };
+            stream << get_level_name(level) << ',' << times.size() << ',' << to_ms(times.front()) << ',' << to_ms(times[times.size() / 2]) << ','
+                << to_ms(times[std::min(times.size() * 95 / 100, times.size() - 1)]) << ',' << to_ms(times.back()) << ',' << new_calls(stats.allocations) << '\n';
+            total_frames += times.size();
+            total_allocations += stats.allocations;
+        }
+
+        stream << "total," << total_frames << ",,,,," << new_calls(total_allocations) << '\n';
+        stream << "wall_time_s," << wall_time_s << ",,,,,\n";
+
+        printf("Replay finished: %llu frames in %.3f s. Report written to %s\n",
+            (unsigned long long)total_frames, wall_time_s, report_path.string().c_str());
+        if (allocations_counted) {
+            printf("  operator new calls: %llu\n", (unsigned long long)total_allocations);
+        }
+    }
+}
+
+bool zelda64::start_input_recording(const std::filesystem::path& path) {
+    std::lock_guard lock{input_replay.mutex};
+    input_replay.output.open(path, std::ios::binary);
+    if (!input_replay.output.good()) {
+        return false;
+    }
+
+    input_replay.output.write(input_replay_magic, sizeof(input_replay_magic));
+    write_value(input_replay.output, input_replay_version);
+    input_replay.path = path;
+    input_replay.mode.store(InputReplayMode::Record);
+    return true;
+}
+
+bool zelda64::start_input_replay(const std::filesystem::path& path) {
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.good()) {
+        return false;
+    }
+
+    std::vector<char> bytes{ std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+    size_t offset = 0;
+    char magic[sizeof(input_replay_magic)];
+    uint32_t version;
+    if (!read_value(bytes, offset, magic) || std::memcmp(magic, input_replay_magic, sizeof(magic)) != 0 ||
+        !read_value(bytes, offset, version) || version != input_replay_version) {
+        return false;
+    }
+
+    std::lock_guard lock{input_replay.mutex};
+    input_replay.runs.clear();
+    input_replay.seeds.clear();
+    while (offset < bytes.size()) {
+        InputReplayTag tag;
+        read_value(bytes, offset, tag);
+        if (tag == InputReplayTag::PadRun) {
+            InputReplayRun& run = input_replay.runs.emplace_back();
+            if (!read_value(bytes, offset, run.count) || !read_value(bytes, offset, run.pad.buttons) ||
+                !read_value(bytes, offset, run.pad.x) || !read_value(bytes, offset, run.pad.y)) {
+                return false;
+            }
+        }
+        else if (tag == InputReplayTag::Seeds) {
+            InputReplaySeeds& seeds = input_replay.seeds.emplace_back();
+            if (!read_value(bytes, offset, seeds.read_index) || !read_value(bytes, offset, seeds.seeds)) {
+                return false;
+            }
+        }
+        else {
+            return false;
+        }
+    }
+
+    input_replay.path = path;
+    input_replay.mode.store(InputReplayMode::Replay);
+    return true;
+}
+
+void zelda64::finish_input_recording() {
+    std::lock_guard lock{input_replay.mutex};
+    if (input_replay.mode.load() != InputReplayMode::Record) {
+        return;
+    }
+
+    flush_current_run();
+    input_replay.output.close();
+}
+
+zelda64::InputReplayMode zelda64::get_input_replay_mode() {
+    return input_replay.mode.load(std::memory_order_relaxed);
+}
+
+void zelda64::process_input_replay_pad(uint16_t* buttons, float* x, float* y) {
+    InputReplayMode mode = get_input_replay_mode();
+    if (mode == InputReplayMode::None) {
+        return;
+    }
+
+    std::lock_guard lock{input_replay.mutex};
+    input_replay.read_count++;
+    if (mode == InputReplayMode::Record) {
+        InputReplayPad pad{ *buttons, *x, *y };
+        if (input_replay.current_run.count != 0 && pad != input_replay.current_run.pad) {
+            flush_current_run();
+        }
+
+        input_replay.current_run.pad = pad;
+        input_replay.current_run.count++;
+        return;
+    }
+
+    // Leave the game without any input once the recording runs out, the report gets written at the end of the frame.
+    InputReplayPad pad{};
+    if (input_replay.next_run < input_replay.runs.size()) {
+        const InputReplayRun& run = input_replay.runs[input_replay.next_run];
+        pad = run.pad;
+        if (++input_replay.run_offset >= run.count) {
+            input_replay.next_run++;
+            input_replay.run_offset = 0;
+        }
+    }
+
+    *buttons = pad.buttons;
+    *x = pad.x;
+    *y = pad.y;
+}
+
+bool zelda64::is_input_replay_finished() {
+    return input_replay.finished.load(std::memory_order_relaxed);
+}
+
+extern "C" void recomp_sync_input_replay_seeds(uint8_t* rdram, recomp_context* ctx) {
+    int32_t* seed_ptrs[] = {
+        _arg<0, int32_t*>(rdram, ctx),
+        _arg<1, int32_t*>(rdram, ctx),
+        _arg<2, int32_t*>(rdram, ctx),
+    };
+
+    using namespace zelda64;
+    InputReplayMode mode = get_input_replay_mode();
+    if (mode == InputReplayMode::None) {
+        return;
+    }
+
+    std::lock_guard lock{input_replay.mutex};
+    if (mode == InputReplayMode::Record) {
+        flush_current_run();
+        write_value(input_replay.output, InputReplayTag::Seeds);
+        write_value(input_replay.output, input_replay.read_count);
+        for (int32_t* seed : seed_ptrs) {
+            write_value(input_replay.output, *seed);
+        }
+        return;
+    }
+
+    if (input_replay.next_seeds >= input_replay.seeds.size()) {
+        printf("Input replay has no RNG seeds left, the replay will desync\n");
+        return;
+    }
+
+    const InputReplaySeeds& seeds = input_replay.seeds[input_replay.next_seeds++];
+    if (seeds.read_index != input_replay.read_count) {
+        printf("Input replay RNG seeds were recorded at read %u but restored at read %u, the replay will desync\n",
+            seeds.read_index, input_replay.read_count);
+    }
+
+    for (size_t i = 0; i < seeds.seeds.size(); i++) {
+        *seed_ptrs[i] = seeds.seeds[i];
+    }
+}
+
+extern "C" void recomp_input_replay_end_frame(uint8_t* rdram, recomp_context* ctx) {
+    int32_t level = _arg<0, int32_t>(rdram, ctx);
+
+    using namespace zelda64;
+    if (get_input_replay_mode() != InputReplayMode::Replay || is_input_replay_finished()) {
+        return;
+    }
+
+    std::lock_guard lock{input_replay.mutex};
+    auto now = std::chrono::steady_clock::now();
+    uint64_t allocations = allocation_count.load(std::memory_order_relaxed);
+    if (!input_replay.frame_started) {
+        input_replay.frame_started = true;
+        input_replay.replay_start = now;
+        counting_allocations.store(true, std::memory_order_relaxed);
+    }
+    else {
+        // Frames are attributed to the level that was running when they ended.
+        InputReplayLevelStats& stats = input_replay.level_stats[level];
+        stats.frame_times_us.emplace_back(uint32_t(std::chrono::duration_cast<std::chrono::microseconds>(now - input_replay.frame_start).count()));
+        stats.allocations += allocations - input_replay.frame_start_allocations;
+    }
+
+    // Read the count again so that the bookkeeping above isn't attributed to the next frame.
+    input_replay.frame_start = now;
+    input_replay.frame_start_allocations = allocation_count.load(std::memory_order_relaxed);
+
+    if (input_replay.next_run >= input_replay.runs.size()) {
+        counting_allocations.store(false, std::memory_order_relaxed);
+        write_replay_report();
+        input_replay.finished.store(true);
+    }
+}
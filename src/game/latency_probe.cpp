@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+
+#include "zelda_latency.h"
+#include "librecomp/helpers.hpp"
+
+namespace zelda64 {
+    // Value of waiting_stage when no probe is in flight. Stages are never marked as Event, so it doubles as idle.
+    constexpr uint32_t latency_probe_idle = uint32_t(LatencyStage::Event);
+    // Value of waiting_stage while a thread is writing the timestamp of a stage.
+    constexpr uint32_t latency_probe_busy = UINT32_MAX;
+    // Probes that haven't been presented after this long are dropped, e.g. when the input isn't bound to anything.
+    constexpr int64_t latency_probe_timeout_ns = 1'000'000'000;
+
+    using LatencySample = std::array<int64_t, LatencyStageCount>;
+
+    struct LatencyProbeState {
+        std::atomic<bool> enabled = false;
+        // The stage the probe in flight is waiting on. The timestamps are published by the release store that advances
+        // it, so the thread that marks the next stage always sees the previous ones.
+        std::atomic<uint32_t> waiting_stage = latency_probe_idle;
+        // Start of the probe in flight, used to drop it if it's been waiting for too long.
+        std::atomic<int64_t> probe_start_ns = 0;
+        // The input that started the probe in flight.
+        std::atomic<recomp::InputField> input{};
+        // Absolute time of every stage of the probe in flight.
+        LatencySample stage_times{};
+
+        std::mutex samples_mutex;
+        // Completed probes, with the time of every stage relative to the input event.
+        std::array<LatencySample, LatencySampleCount> samples{};
+        size_t next_sample = 0;
+        size_t stored_samples = 0;
+    };
+
+    static LatencyProbeState latency_probe{};
+
+    static const char* latency_transition_names[] = {
+        "Event queue",
+        "Input read",
+        "Game pickup",
+        "Game update",
+        "Task dispatch",
+        "Render + present",
+    };
+
+    static_assert(sizeof(latency_transition_names) / sizeof(latency_transition_names[0]) == LatencyStageCount - 1);
+
+    static int64_t latency_now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static void store_latency_sample() {
+        LatencySample sample;
+        int64_t event_time = latency_probe.stage_times[size_t(LatencyStage::Event)];
+        for (size_t i = 0; i < LatencyStageCount; i++) {
+            sample[i] = latency_probe.stage_times[i] - event_time;
+        }
+
+        std::lock_guard lock{latency_probe.samples_mutex};
+        latency_probe.samples[latency_probe.next_sample] = sample;
+        latency_probe.next_sample = (latency_probe.next_sample + 1) % LatencySampleCount;
+        latency_probe.stored_samples = std::min(latency_probe.stored_samples + 1, LatencySampleCount);
+    }
+}
+
+bool zelda64::is_latency_probe_enabled() {
+    return latency_probe.enabled.load(std::memory_order_relaxed);
+}
+
+void zelda64::set_latency_probe_enabled(bool enabled) {
+    // A probe that's already in flight is left alone, it'll either complete or time out.
+    latency_probe.enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void zelda64::begin_latency_probe(uint32_t event_age_ms, const recomp::InputField& input) {
+    if (!is_latency_probe_enabled()) {
+        return;
+    }
+
+    int64_t now = latency_now_ns();
+    uint32_t expected = latency_probe_idle;
+    if (!latency_probe.waiting_stage.compare_exchange_strong(expected, latency_probe_busy, std::memory_order_acquire)) {
+        // Replace the probe in flight if it got stuck waiting on a stage that will never come.
+        if (expected == latency_probe_busy || now - latency_probe.probe_start_ns.load(std::memory_order_relaxed) < latency_probe_timeout_ns) {
+            return;
+        }
+
+        if (!latency_probe.waiting_stage.compare_exchange_strong(expected, latency_probe_busy, std::memory_order_acquire)) {
+            return;
+        }
+    }
+
+    // SDL event timestamps are in milliseconds, so the event stage is only as precise as that.
+    int64_t event_age_ns = int64_t(event_age_ms) * 1'000'000;
+    latency_probe.stage_times[size_t(LatencyStage::Event)] = now - event_age_ns;
+    latency_probe.stage_times[size_t(LatencyStage::Filter)] = now;
+    latency_probe.probe_start_ns.store(now, std::memory_order_relaxed);
+    latency_probe.input.store(input, std::memory_order_relaxed);
+    latency_probe.waiting_stage.store(uint32_t(LatencyStage::GameRead), std::memory_order_release);
+}
+
+bool zelda64::get_latency_probe_input(recomp::InputField& input) {
+    if (latency_probe.waiting_stage.load(std::memory_order_acquire) != uint32_t(LatencyStage::GameRead)) {
+        return false;
+    }
+
+    input = latency_probe.input.load(std::memory_order_relaxed);
+    return true;
+}
+
+void zelda64::mark_latency_stage(LatencyStage stage) {
+    uint32_t expected = uint32_t(stage);
+    if (latency_probe.waiting_stage.load(std::memory_order_relaxed) != expected) {
+        return;
+    }
+
+    // Claim the stage so that only one thread records it.
+    if (!latency_probe.waiting_stage.compare_exchange_strong(expected, latency_probe_busy, std::memory_order_acquire)) {
+        return;
+    }
+
+    int64_t now = latency_now_ns();
+    if (now - latency_probe.probe_start_ns.load(std::memory_order_relaxed) >= latency_probe_timeout_ns) {
+        latency_probe.waiting_stage.store(latency_probe_idle, std::memory_order_release);
+        return;
+    }
+
+    latency_probe.stage_times[size_t(stage)] = now;
+    if (stage == LatencyStage::Present) {
+        store_latency_sample();
+        latency_probe.waiting_stage.store(latency_probe_idle, std::memory_order_release);
+    }
+    else {
+        latency_probe.waiting_stage.store(uint32_t(stage) + 1, std::memory_order_release);
+    }
+}
+
+std::vector<zelda64::LatencyStageSummary> zelda64::get_latency_summary() {
+    std::vector<LatencySample> samples;
+    {
+        std::lock_guard lock{latency_probe.samples_mutex};
+        samples.assign(latency_probe.samples.begin(), latency_probe.samples.begin() + latency_probe.stored_samples);
+    }
+
+    std::vector<LatencyStageSummary> summaries;
+    if (samples.empty()) {
+        return summaries;
+    }
+
+    std::vector<int64_t> durations(samples.size());
+    auto summarize = [&](const char* name) {
+        std::sort(durations.begin(), durations.end());
+        auto to_ms = [](int64_t ns) { return ns / 1'000'000.0; };
+        summaries.emplace_back(LatencyStageSummary{
+            .name = name,
+            .min_ms = to_ms(durations.front()),
+            .median_ms = to_ms(durations[durations.size() / 2]),
+            .p95_ms = to_ms(durations[std::min(durations.size() * 95 / 100, durations.size() - 1)]),
+            .max_ms = to_ms(durations.back()),
+        });
+    };
+
+    for (size_t stage = 1; stage < LatencyStageCount; stage++) {
+        for (size_t i = 0; i < samples.size(); i++) {
+            durations[i] = samples[i][stage] - samples[i][stage - 1];
+        }
+        summarize(latency_transition_names[stage - 1]);
+    }
+
+    for (size_t i = 0; i < samples.size(); i++) {
+        durations[i] = samples[i][size_t(LatencyStage::Present)];
+    }
+    summarize("Total");
+
+    return summaries;
+}
+
+size_t zelda64::get_latency_sample_count() {
+    std::lock_guard lock{latency_probe.samples_mutex};
+    return latency_probe.stored_samples;
+}
+
+void zelda64::clear_latency_samples() {
+    std::lock_guard lock{latency_probe.samples_mutex};
+    latency_probe.next_sample = 0;
+    latency_probe.stored_samples = 0;
+}
+
+bool zelda64::export_latency_csv(const std::filesystem::path& path) {
+    std::ofstream stream(path);
+    if (!stream.good()) {
+        return false;
+    }
+
+    stream << "probe,filter_ns,game_read_ns,frame_input_ns,task_queued_ns,submit_ns,present_ns\n";
+
+    std::lock_guard lock{latency_probe.samples_mutex};
+    // Start at the oldest probe in the ring buffer.
+    size_t first_sample = (latency_probe.next_sample + LatencySampleCount - latency_probe.stored_samples) % LatencySampleCount;
+    for (size_t i = 0; i < latency_probe.stored_samples; i++) {
+        const LatencySample& sample = latency_probe.samples[(first_sample + i) % LatencySampleCount];
+        stream << i;
+        for (size_t stage = size_t(LatencyStage::Filter); stage < LatencyStageCount; stage++) {
+            stream << ',' << sample[stage];
+        }
+        stream << '\n';
+    }
+
+    return stream.good();
+}
+
+extern "C" void recomp_mark_input_latency(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t stage = _arg<0, uint32_t>(rdram, ctx);
+    if (stage >= zelda64::LatencyStageCount) {
+        return;
+    }
+
+    zelda64::mark_latency_stage(zelda64::LatencyStage(stage));
+}
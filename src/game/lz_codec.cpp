@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "zelda_lz.h"
+
+namespace zelda64 {
+    constexpr size_t lz_min_match = 4;
+    constexpr size_t lz_max_offset = 0xFFFF;
+    constexpr size_t lz_hash_bits = 14;
+    // The last bytes are always stored as literals, which keeps the match search from reading past the end.
+    constexpr size_t lz_end_literals = 8;
+
+    static uint32_t read_u32(const uint8_t* p) {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    static uint32_t lz_hash(uint32_t value) {
+        return (value * 2654435761u) >> (32 - lz_hash_bits);
+    }
+
+    // Lengths that don't fit in their half of the token continue in extra bytes of up to 255 each.
+    static void write_length(std::vector<uint8_t>& output, size_t length) {
+        while (length >= 255) {
+            output.push_back(255);
+            length -= 255;
+        }
+        output.push_back(uint8_t(length));
+    }
+
+    static bool read_length(std::span<const uint8_t> input, size_t& offset, size_t& length) {
+        uint8_t byte;
+        do {
+            if (offset >= input.size()) {
+                return false;
+            }
+            byte = input[offset++];
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    static void write_sequence(std::vector<uint8_t>& output, const uint8_t* literals, size_t literal_length, size_t offset, size_t match_length) {
+        size_t token_match = (match_length == 0) ? 0 : match_length - lz_min_match;
+        output.push_back(uint8_t((std::min<size_t>(literal_length, 15) << 4) | std::min<size_t>(token_match, 15)));
+        if (literal_length >= 15) {
+            write_length(output, literal_length - 15);
+        }
+        output.insert(output.end(), literals, literals + literal_length);
+
+        // The final sequence only has literals.
+        if (match_length != 0) {
+            output.push_back(uint8_t(offset & 0xFF));
+            output.push_back(uint8_t(offset >> 8));
+            if (token_match >= 15) {
+                write_length(output, token_match - 15);
+            }
+        }
+    }
+}
+
+void zelda64::lz_compress(std::span<const uint8_t> input, std::vector<uint8_t>& output) {
+    const uint8_t* data = input.data();
+    size_t size = input.size();
+    size_t literal_start = 0;
+    size_t pos = 0;
+
+    if (size > lz_end_literals + lz_min_match) {
+        std::array<uint32_t, size_t(1) << lz_hash_bits> table{};
+        size_t match_limit = size - lz_end_literals;
+        while (pos + lz_min_match <= match_limit) {
+            uint32_t value = read_u32(data + pos);
+            uint32_t hash = lz_hash(value);
+            size_t candidate = table[hash];
+            table[hash] = uint32_t(pos);
+
+            if (candidate >= pos || pos - candidate > lz_max_offset || read_u32(data + candidate) != value) {
+                pos++;
+                continue;
+            }
+
+            size_t match_length = lz_min_match;
+            while (pos + match_length < match_limit && data[candidate + match_length] == data[pos + match_length]) {
+                match_length++;
+            }
+
+            write_sequence(output, data + literal_start, pos - literal_start, pos - candidate, match_length);
+            pos += match_length;
+            literal_start = pos;
+        }
+    }
+
+    write_sequence(output, data + literal_start, size - literal_start, 0, 0);
+}
+
+bool zelda64::lz_decompress(std::span<const uint8_t> input, std::span<uint8_t> output) {
+    size_t in = 0;
+    size_t out = 0;
+    while (in < input.size()) {
+        uint8_t token = input[in++];
+
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !read_length(input, in, literal_length)) {
+            return false;
+        }
+        if (literal_length > input.size() - in || literal_length > output.size() - out) {
+            return false;
+        }
+        std::memcpy(output.data() + out, input.data() + in, literal_length);
+        in += literal_length;
+        out += literal_length;
+
+        if (in == input.size()) {
+            break;
+        }
+
+        if (input.size() - in < 2) {
+            return false;
+        }
+        size_t offset = input[in] | (size_t(input[in + 1]) << 8);
+        in += 2;
+
+        size_t match_length = token & 0xF;
+        if (match_length == 15 && !read_length(input, in, match_length)) {
+            return false;
+        }
+        match_length += lz_min_match;
+        if (offset == 0 || offset > out || match_length > output.size() - out) {
+            return false;
+        }
+
+        // Matches can overlap the bytes they produce, e.g. an offset of 1 repeats a single byte, so copy forwards.
+        uint8_t* dst = output.data() + out;
+        const uint8_t* src = dst - offset;
+        for (size_t i = 0; i < match_length; i++) {
+            dst[i] = src[i];
+        }
+        out += match_length;
+    }
+
+    return out == output.size();
+}
@@ -1,37 +1,103 @@
-// Quicksaving is disabled for now
-
-#if 0
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <mutex>
 
 #include "librecomp/helpers.hpp"
 #include "librecomp/input.hpp"
 #include "ultramodern/ultramodern.hpp"
+#include "zelda_game.h"
+#include "zelda_snapshot.h"
+#include "zelda_rewind.h"
+#include "zelda_savestate.h"
 
 enum class QuicksaveAction {
     None,
     Save,
-    Load
+    Load,
+    RewindCapture,
+    Rewind,
+    SaveToFile,
+    LoadFromFile
 };
 
-std::atomic<QuicksaveAction> cur_quicksave_action = QuicksaveAction::None;
+// The action that was asked for, which the main thread picks up the next time it gets to its quicksave handler.
+std::atomic<QuicksaveAction> requested_quicksave_action = QuicksaveAction::None;
+// The action the main thread is gathering the other permanent threads for. It doesn't change until every thread has
+// been let go again, so they all act on the same one.
+std::atomic<QuicksaveAction> active_quicksave_action = QuicksaveAction::None;
+std::atomic<bool> rewind_enabled = false;
+std::atomic<uint32_t> rewind_steps = 0;
+
+// Set by the main thread before it lets the other permanent threads continue, so they know which context to keep or load.
+std::atomic<uint64_t> quicksave_point_id = 0;
+std::atomic<bool> quicksave_action_succeeded = false;
 
 void zelda64::quicksave_save() {
-    cur_quicksave_action.store(QuicksaveAction::Save);
+    requested_quicksave_action.store(QuicksaveAction::Save);
 }
 
 void zelda64::quicksave_load() {
-    cur_quicksave_action.store(QuicksaveAction::Load);
+    requested_quicksave_action.store(QuicksaveAction::Load);
+}
+
+// Contexts on their way to or from a savestate file, since the main thread is the one that writes and reads it.
+std::mutex savestate_mutex;
+std::filesystem::path savestate_path;
+std::vector<zelda64::SavestateThread> savestate_contexts;
+
+void zelda64::savestate_save(const std::filesystem::path& path) {
+    // Gets the RDRAM copy ready while the game threads make their way to the quicksave handlers.
+    zelda64::init_savestates();
+    {
+        std::lock_guard lock{savestate_mutex};
+        savestate_path = path;
+    }
+    requested_quicksave_action.store(QuicksaveAction::SaveToFile);
+}
+
+void zelda64::savestate_load(const std::filesystem::path& path) {
+    {
+        std::lock_guard lock{savestate_mutex};
+        savestate_path = path;
+    }
+    requested_quicksave_action.store(QuicksaveAction::LoadFromFile);
 }
 
-uint8_t saved_rdram[ultramodern::rdram_size];
+void zelda64::set_rewind_enabled(bool enabled) {
+    rewind_enabled.store(enabled);
+}
+
+void zelda64::rewind(uint32_t steps) {
+    rewind_steps.store(steps);
+    requested_quicksave_action.store(QuicksaveAction::Rewind);
+}
+
+// The quicksave is point 0 of the rewind history, so every thread keeps one context per rewind point.
+struct SavedContext {
+    uint64_t point_id;
+    recomp_context context;
+};
 
-thread_local recomp_context saved_context;
+thread_local std::deque<SavedContext> saved_contexts;
+thread_local recomp_context pending_context;
 
-void save_context(recomp_context* ctx) {
-    saved_context = *ctx;
+void keep_context(uint64_t point_id, bool new_history) {
+    if (new_history) {
+        saved_contexts.clear();
+    }
+
+    // Points can only be evicted from the start of the history, so contexts for points that aren't in it anymore are
+    // always at the front.
+    size_t point_count = zelda64::get_rewind_stats().points;
+    saved_contexts.emplace_back(SavedContext{ .point_id = point_id, .context = pending_context });
+    while (saved_contexts.size() > point_count) {
+        saved_contexts.pop_front();
+    }
 }
 
-void load_context(recomp_context* ctx) {
-    *ctx = saved_context;
+void apply_context(const recomp_context& saved, recomp_context* ctx) {
+    *ctx = saved;
 
     // Restore the pointer to the odd floats for correctly handling mips3 float mode.
     if (ctx->mips3_float_mode) {
@@ -44,78 +110,202 @@ void load_context(recomp_context* ctx) {
     }
 }
 
+void load_context(uint64_t point_id, recomp_context* ctx) {
+    // Contexts of the points that were stepped over are gone along with the points.
+    while (!saved_contexts.empty() && saved_contexts.back().point_id > point_id) {
+        saved_contexts.pop_back();
+    }
+    assert(!saved_contexts.empty() && saved_contexts.back().point_id == point_id);
+
+    apply_context(saved_contexts.back().context, ctx);
+}
+
+void load_context_from_savestate(int32_t thread_id, recomp_context* ctx) {
+    std::lock_guard lock{savestate_mutex};
+    for (const zelda64::SavestateThread& thread : savestate_contexts) {
+        if (thread.thread_id == thread_id) {
+            recomp_context saved;
+            std::memcpy(&saved, thread.context.data(), sizeof(saved));
+            apply_context(saved, ctx);
+            return;
+        }
+    }
+
+    // Files are only written with a context for every permanent thread, and the game always gives them the same IDs.
+    assert(false);
+}
+
 extern "C" void recomp_handle_quicksave_actions(uint8_t* rdram, recomp_context* ctx) {
-    QuicksaveAction action = cur_quicksave_action.load();
+    QuicksaveAction action = active_quicksave_action.load();
 
     if (action != QuicksaveAction::None) {
         PTR(OSMesgQueue) quicksave_enter_mq = _arg<0, PTR(OSMesgQueue)>(rdram, ctx);
         PTR(OSMesgQueue) quicksave_exit_mq = _arg<1, PTR(OSMesgQueue)>(rdram, ctx);
+        int32_t thread_id = TO_PTR(OSThread, ultramodern::this_thread())->id;
 
-        printf("saving context for thread %d\n", TO_PTR(OSThread, ultramodern::this_thread())->id);
-
-        // Save or load the thread's context as needed based on the action.
-        if (action == QuicksaveAction::Save) {
-            save_context(ctx);
+        // Hold on to this thread's context in case the main thread takes a new point.
+        if (action == QuicksaveAction::Save || action == QuicksaveAction::RewindCapture) {
+            pending_context = *ctx;
         }
-        else if (action == QuicksaveAction::Load) {
-            load_context(ctx);
+        // Hand the context to the main thread so it can go into the file.
+        else if (action == QuicksaveAction::SaveToFile) {
+            const uint8_t* context_bytes = reinterpret_cast<const uint8_t*>(ctx);
+            std::lock_guard lock{savestate_mutex};
+            savestate_contexts.emplace_back(zelda64::SavestateThread{
+                .thread_id = thread_id,
+                .context = std::vector<uint8_t>(context_bytes, context_bytes + sizeof(recomp_context)),
+            });
         }
-        else {
-            assert(false);
-        }
-    
+
         // Tell the main thread that one of the other permanent threads is ready for performing a quicksave action.
         osSendMesg(rdram, quicksave_enter_mq, NULLPTR, OS_MESG_NOBLOCK);
         // Wait for the main thread to signal that other permanent threads are safe to continue.
         osRecvMesg(rdram, quicksave_exit_mq, NULLPTR, OS_MESG_BLOCK);
+
+        if (!quicksave_action_succeeded.load()) {
+            return;
+        }
+
+        // Keep or load the thread's context as needed based on the action, now that the point is known.
+        uint64_t point_id = quicksave_point_id.load();
+        if (action == QuicksaveAction::Save || action == QuicksaveAction::RewindCapture) {
+            keep_context(point_id, action == QuicksaveAction::Save);
+        }
+        else if (action == QuicksaveAction::Load || action == QuicksaveAction::Rewind) {
+            load_context(point_id, ctx);
+        }
+        else if (action == QuicksaveAction::LoadFromFile) {
+            load_context_from_savestate(thread_id, ctx);
+        }
+        else if (action != QuicksaveAction::SaveToFile) {
+            assert(false);
+        }
     }
 }
 
-extern "C" void wake_threads_for_quicksave_action(uint8_t* rdram, recomp_context* ctx);
-
 extern "C" void recomp_handle_quicksave_actions_main(uint8_t* rdram, recomp_context* ctx) {
-    QuicksaveAction action = cur_quicksave_action.load();
-    
-    if (action != QuicksaveAction::None) {
-        PTR(OSMesgQueue) quicksave_enter_mq = _arg<0, PTR(OSMesgQueue)>(rdram, ctx);
-        PTR(OSMesgQueue) quicksave_exit_mq = _arg<1, PTR(OSMesgQueue)>(rdram, ctx);
+    static uint32_t entered_threads = 0;
+    static uint32_t vis_since_rewind_point = 0;
+    static uint64_t latest_point_id = 0;
+    // Rewind points taken before the first quicksave would start a history that Load can't tell apart from one that
+    // starts with a quicksave, so they're only taken after it.
+    static bool have_quicksave = false;
+    PTR(OSMesgQueue) quicksave_enter_mq = _arg<0, PTR(OSMesgQueue)>(rdram, ctx);
+    PTR(OSMesgQueue) quicksave_exit_mq = _arg<1, PTR(OSMesgQueue)>(rdram, ctx);
+    QuicksaveAction action = active_quicksave_action.load();
+
+    _return(ctx, s32(0));
 
-        wake_threads_for_quicksave_action(rdram, ctx);
+    if (action == QuicksaveAction::None) {
+        action = requested_quicksave_action.exchange(QuicksaveAction::None);
 
-        // Wait for all other permanent threads (hence the minus 1) to signal that they're ready for a quicksave action.
-        for (uint32_t i = 0; i < ultramodern::permanent_thread_count() - 1; i++) {
-            osRecvMesg(rdram, quicksave_enter_mq, NULLPTR, OS_MESG_BLOCK);
+        // Rewind points are taken automatically while nothing else is going on.
+        if (action == QuicksaveAction::None && have_quicksave && rewind_enabled.load() &&
+            ++vis_since_rewind_point >= zelda64::get_rewind_interval())
+        {
+            action = QuicksaveAction::RewindCapture;
         }
 
-        // Allow any temporary threads to complete by lowering this thread's priority to 0.
-        // TODO this won't cause all temporary threads to complete if any are blocked by permanent threads
-        // or events like timers. Situations like that will need to be handed on a case-by-case basis for a given game.
-        if (ultramodern::temporary_thread_count() != 0) {
-            OSPri old_pri = osGetThreadPri(rdram, NULLPTR);
-            osSetThreadPri(rdram, NULLPTR, 0);
+        if (action == QuicksaveAction::None) {
+            return;
+        }
+
+        if (action == QuicksaveAction::Load && !have_quicksave) {
+            printf("There's no quicksave to load\n");
+            return;
+        }
 
-            osSetThreadPri(rdram, NULLPTR, old_pri);
+        // The contexts of the last file that was loaded would otherwise go into the new one.
+        if (action == QuicksaveAction::SaveToFile) {
+            std::lock_guard lock{savestate_mutex};
+            savestate_contexts.clear();
         }
 
-        if (action == QuicksaveAction::Save) {
-            std::copy(rdram, rdram + ultramodern::rdram_size, saved_rdram);
+        entered_threads = 0;
+        active_quicksave_action.store(action);
+        // Have the patch wake up the threads that only run when they're sent something.
+        _return(ctx, s32(1));
+        return;
+    }
+
+    // The other permanent threads only get to their handlers if this thread keeps forwarding VIs and task completions
+    // to them, so rather than waiting here it goes back to its loop until all of them (hence the minus 1) have entered.
+    while (osRecvMesg(rdram, quicksave_enter_mq, NULLPTR, OS_MESG_NOBLOCK) != -1) {
+        entered_threads++;
+    }
+    if (entered_threads < ultramodern::permanent_thread_count() - 1) {
+        return;
+    }
+
+    // Allow any temporary threads to complete by lowering this thread's priority to 0.
+    // TODO this won't cause all temporary threads to complete if any are blocked by permanent threads
+    // or events like timers. Situations like that will need to be handed on a case-by-case basis for a given game.
+    if (ultramodern::temporary_thread_count() != 0) {
+        OSPri old_pri = osGetThreadPri(rdram, NULLPTR);
+        osSetThreadPri(rdram, NULLPTR, 0);
+
+        osSetThreadPri(rdram, NULLPTR, old_pri);
+    }
+
+    // The snapshot engine only copies the pages that were written since the last point, in either direction. A
+    // quicksave starts a new rewind history and is its first point, so loading it is a rewind all the way back.
+    bool succeeded = true;
+    uint64_t point_id = 0;
+    if (action == QuicksaveAction::Save) {
+        zelda64::clear_rewind_history();
+        point_id = zelda64::capture_rewind_point(rdram);
+        have_quicksave = true;
+        vis_since_rewind_point = 0;
+    }
+    else if (action == QuicksaveAction::RewindCapture) {
+        point_id = zelda64::capture_rewind_point(rdram);
+        vis_since_rewind_point = 0;
+    }
+    else if (action == QuicksaveAction::Load) {
+        succeeded = zelda64::rewind_rdram(rdram, latest_point_id, point_id);
+        if (!succeeded) {
+            printf("The quicksave is no longer in the rewind history\n");
         }
-        else if (action == QuicksaveAction::Load) {
-            std::copy(saved_rdram, saved_rdram + ultramodern::rdram_size, rdram);
+    }
+    else if (action == QuicksaveAction::Rewind) {
+        succeeded = zelda64::rewind_rdram(rdram, rewind_steps.load(), point_id);
+    }
+    else if (action == QuicksaveAction::SaveToFile) {
+        // Only RDRAM gets copied here, the file is written in the background.
+        std::lock_guard lock{savestate_mutex};
+        zelda64::queue_savestate_write(savestate_path, zelda64::rom_hash, rdram, std::move(savestate_contexts));
+        savestate_contexts.clear();
+    }
+    else if (action == QuicksaveAction::LoadFromFile) {
+        std::lock_guard lock{savestate_mutex};
+        zelda64::SavestateError error = zelda64::load_savestate(savestate_path, zelda64::rom_hash, sizeof(recomp_context), rdram, savestate_contexts);
+        succeeded = error == zelda64::SavestateError::Success;
+
+        if (succeeded) {
+            // The rewind history and the quicksave don't lead up to the loaded state anymore.
+            zelda64::clear_rewind_history();
+            have_quicksave = false;
         }
         else {
-            assert(false);
+            printf("Failed to load savestate %s (error %d)\n", savestate_path.string().c_str(), int(error));
         }
+    }
+    else {
+        assert(false);
+    }
 
-        printf("Quicksave action complete\n");
+    if (succeeded && action != QuicksaveAction::SaveToFile && action != QuicksaveAction::LoadFromFile) {
+        latest_point_id = point_id;
+    }
 
-        cur_quicksave_action.store(QuicksaveAction::None);
+    printf("Quicksave action complete (point %llu)\n", (unsigned long long)point_id);
 
-        // Tell all other permanent threads that they're good to continue.
-        for (uint32_t i = 0; i < ultramodern::permanent_thread_count() - 1; i++) {
-            osSendMesg(rdram, quicksave_exit_mq, NULLPTR, OS_MESG_BLOCK);
-        }
+    quicksave_point_id.store(point_id);
+    quicksave_action_succeeded.store(succeeded);
+    active_quicksave_action.store(QuicksaveAction::None);
+
+    // Tell all other permanent threads that they're good to continue.
+    for (uint32_t i = 0; i < ultramodern::permanent_thread_count() - 1; i++) {
+        osSendMesg(rdram, quicksave_exit_mq, NULLPTR, OS_MESG_BLOCK);
     }
 }
-
-#endif
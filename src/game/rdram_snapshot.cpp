@@ -0,0 +1,309 @@
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <memory>
+
+#include "zelda_snapshot.h"
+#include "ultramodern/ultramodern.hpp"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace zelda64 {
+    // Tracking granularity used when write protection isn't available.
+    constexpr size_t fallback_snapshot_page_size = 4096;
+
+    struct RdramSnapshotState {
+        std::unique_ptr<uint8_t[]> data;
+        size_t page_size = fallback_snapshot_page_size;
+        size_t page_count = 0;
+        bool tracking = false;
+
+        // Read by the fault handler, so they're only ever written while tracking is off.
+        std::atomic<uintptr_t> tracked_base = 0;
+        std::atomic<uintptr_t> tracked_end = 0;
+        std::unique_ptr<std::atomic<uint64_t>[]> dirty_bits;
+    };
+
+    static RdramSnapshotState snapshot_state{};
+
+    static bool set_pages_writable(uint8_t* start, size_t size, bool writable);
+
+    // Marks the page containing the given address as dirty and lets the write through. Returns false if the address
+    // isn't in RDRAM, in which case the fault belongs to someone else.
+    static bool handle_write_fault(uintptr_t address) {
+        uintptr_t base = snapshot_state.tracked_base.load(std::memory_order_acquire);
+        if (address < base || address >= snapshot_state.tracked_end.load(std::memory_order_relaxed)) {
+            return false;
+        }
+
+        size_t page = (address - base) / snapshot_state.page_size;
+        snapshot_state.dirty_bits[page / 64].fetch_or(uint64_t(1) << (page % 64), std::memory_order_relaxed);
+        return set_pages_writable(reinterpret_cast<uint8_t*>(base + page * snapshot_state.page_size), snapshot_state.page_size, true);
+    }
+
+#if defined(_WIN32)
+    static PVOID fault_handler_handle = nullptr;
+
+    static size_t get_os_page_size() {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+    }
+
+    static bool set_pages_writable(uint8_t* start, size_t size, bool writable) {
+        DWORD old_protect;
+        return VirtualProtect(start, size, writable ? PAGE_READWRITE : PAGE_READONLY, &old_protect) != 0;
+    }
+
+    static LONG CALLBACK write_fault_handler(PEXCEPTION_POINTERS exception_info) {
+        const EXCEPTION_RECORD* record = exception_info->ExceptionRecord;
+        // The first parameter is 1 for writes, the second one is the address that was written to.
+        if (record->ExceptionCode == EXCEPTION_ACCESS_VIOLATION && record->NumberParameters >= 2 && record->ExceptionInformation[0] == 1 &&
+            handle_write_fault(uintptr_t(record->ExceptionInformation[1]))) {
+            return EXCEPTION_CONTINUE_EXECUTION;
+        }
+
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+
+    static bool install_fault_handler() {
+        if (fault_handler_handle == nullptr) {
+            fault_handler_handle = AddVectoredExceptionHandler(1, write_fault_handler);
+        }
+
+        return fault_handler_handle != nullptr;
+    }
+#else
+    static struct sigaction previous_segv_action{};
+    static struct sigaction previous_bus_action{};
+    static bool fault_handler_installed = false;
+
+    static size_t get_os_page_size() {
+        return size_t(sysconf(_SC_PAGESIZE));
+    }
+
+    static bool set_pages_writable(uint8_t* start, size_t size, bool writable) {
+        return mprotect(start, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ) == 0;
+    }
+
+    static void write_fault_handler(int signal, siginfo_t* info, void* context) {
+        if (handle_write_fault(reinterpret_cast<uintptr_t>(info->si_addr))) {
+            return;
+        }
+
+        // Not a write to RDRAM, so pass it on to whoever was handling it before.
+        const struct sigaction& previous = (signal == SIGBUS) ? previous_bus_action : previous_segv_action;
+        if (previous.sa_flags & SA_SIGINFO) {
+            previous.sa_sigaction(signal, info, context);
+        }
+        else if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN) {
+            previous.sa_handler(signal);
+        }
+        else {
+            // Restore the default action and return, so the faulting instruction runs again and crashes as usual.
+            sigaction(signal, &previous, nullptr);
+        }
+    }
+
+    static bool install_fault_handler() {
+        if (fault_handler_installed) {
+            return true;
+        }
+
+        struct sigaction action{};
+        action.sa_sigaction = write_fault_handler;
+        action.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigemptyset(&action.sa_mask);
+
+        // Some platforms report writes to read-only pages as SIGBUS instead of SIGSEGV.
+        if (sigaction(SIGSEGV, &action, &previous_segv_action) != 0 || sigaction(SIGBUS, &action, &previous_bus_action) != 0) {
+            return false;
+        }
+
+        fault_handler_installed = true;
+        return true;
+    }
+#endif
+
+    static void clear_page_dirty(size_t page) {
+        snapshot_state.dirty_bits[page / 64].fetch_and(~(uint64_t(1) << (page % 64)), std::memory_order_relaxed);
+    }
+
+    // Takes the first snapshot, copying the whole of RDRAM, and starts tracking writes if possible.
+    static void create_snapshot(uint8_t* rdram) {
+        size_t os_page_size = get_os_page_size();
+        bool can_track = (reinterpret_cast<uintptr_t>(rdram) % os_page_size) == 0 && (ultramodern::rdram_size % os_page_size) == 0 && install_fault_handler();
+
+        snapshot_state.page_size = can_track ? os_page_size : fallback_snapshot_page_size;
+        snapshot_state.page_count = ultramodern::rdram_size / snapshot_state.page_size;
+        snapshot_state.data = std::make_unique<uint8_t[]>(ultramodern::rdram_size);
+        snapshot_state.dirty_bits = std::make_unique<std::atomic<uint64_t>[]>((snapshot_state.page_count + 63) / 64);
+        std::memcpy(snapshot_state.data.get(), rdram, ultramodern::rdram_size);
+
+        if (can_track) {
+            snapshot_state.tracked_base.store(reinterpret_cast<uintptr_t>(rdram), std::memory_order_relaxed);
+            snapshot_state.tracked_end.store(reinterpret_cast<uintptr_t>(rdram) + ultramodern::rdram_size, std::memory_order_release);
+            snapshot_state.tracking = set_pages_writable(rdram, ultramodern::rdram_size, false);
+            if (!snapshot_state.tracking) {
+                snapshot_state.tracked_end.store(0, std::memory_order_relaxed);
+                snapshot_state.tracked_base.store(0, std::memory_order_release);
+                set_pages_writable(rdram, ultramodern::rdram_size, true);
+            }
+        }
+    }
+
+    // Copies the pages that changed since the previous capture into the snapshot. If deltas isn't null, the XOR of the
+    // previous and new contents of each copied page is appended to it first.
+    static size_t capture_changed_pages(uint8_t* rdram, std::vector<uint32_t>* changed_pages, std::vector<uint8_t>* deltas) {
+        size_t page_size = snapshot_state.page_size;
+        size_t copied_pages = 0;
+        auto copy_page = [&](size_t page) {
+            const uint8_t* rdram_page = rdram + page * page_size;
+            uint8_t* snapshot_page = snapshot_state.data.get() + page * page_size;
+            if (deltas != nullptr) {
+                size_t delta_offset = deltas->size();
+                deltas->resize(delta_offset + page_size);
+                uint8_t* delta = deltas->data() + delta_offset;
+                for (size_t i = 0; i < page_size; i++) {
+                    delta[i] = snapshot_page[i] ^ rdram_page[i];
+                }
+            }
+
+            std::memcpy(snapshot_page, rdram_page, page_size);
+            if (changed_pages != nullptr) {
+                changed_pages->emplace_back(uint32_t(page));
+            }
+            copied_pages++;
+        };
+
+        if (snapshot_state.tracking) {
+            for (size_t word = 0; word < (snapshot_state.page_count + 63) / 64; word++) {
+                // Protect the pages before copying them, so a write that races with the copy marks them dirty again.
+                uint64_t bits = snapshot_state.dirty_bits[word].exchange(0, std::memory_order_relaxed);
+                while (bits != 0) {
+                    size_t page = word * 64 + std::countr_zero(bits);
+                    bits &= bits - 1;
+                    set_pages_writable(rdram + page * page_size, page_size, false);
+                    copy_page(page);
+                }
+            }
+        }
+        else {
+            for (size_t page = 0; page < snapshot_state.page_count; page++) {
+                if (std::memcmp(rdram + page * page_size, snapshot_state.data.get() + page * page_size, page_size) != 0) {
+                    copy_page(page);
+                }
+            }
+        }
+
+        return copied_pages;
+    }
+}
+
+size_t zelda64::capture_rdram_snapshot(uint8_t* rdram, std::vector<uint32_t>* changed_pages) {
+    if (!has_rdram_snapshot()) {
+        create_snapshot(rdram);
+        if (changed_pages != nullptr) {
+            for (size_t page = 0; page < snapshot_state.page_count; page++) {
+                changed_pages->emplace_back(uint32_t(page));
+            }
+        }
+        return snapshot_state.page_count;
+    }
+
+    return capture_changed_pages(rdram, changed_pages, nullptr);
+}
+
+size_t zelda64::capture_rdram_snapshot_delta(uint8_t* rdram, std::vector<uint32_t>& changed_pages, std::vector<uint8_t>& deltas) {
+    if (!has_rdram_snapshot()) {
+        create_snapshot(rdram);
+        return 0;
+    }
+
+    return capture_changed_pages(rdram, &changed_pages, &deltas);
+}
+
+void zelda64::apply_rdram_snapshot_delta(uint8_t* rdram, uint32_t page, const uint8_t* delta) {
+    size_t page_size = snapshot_state.page_size;
+    uint8_t* snapshot_page = snapshot_state.data.get() + page * page_size;
+    for (size_t i = 0; i < page_size; i++) {
+        snapshot_page[i] ^= delta[i];
+    }
+
+    // Dirty pages are always writable.
+    if (snapshot_state.tracking) {
+        snapshot_state.dirty_bits[page / 64].fetch_or(uint64_t(1) << (page % 64), std::memory_order_relaxed);
+        set_pages_writable(rdram + page * page_size, page_size, true);
+    }
+}
+
+size_t zelda64::restore_rdram_snapshot(uint8_t* rdram) {
+    if (!has_rdram_snapshot()) {
+        return 0;
+    }
+
+    size_t page_size = snapshot_state.page_size;
+    size_t copied_pages = 0;
+    if (snapshot_state.tracking) {
+        for (size_t word = 0; word < (snapshot_state.page_count + 63) / 64; word++) {
+            uint64_t bits = snapshot_state.dirty_bits[word].load(std::memory_order_relaxed);
+            while (bits != 0) {
+                size_t page = word * 64 + std::countr_zero(bits);
+                bits &= bits - 1;
+
+                // Dirty pages are already writable, and they match the snapshot again once they're copied back.
+                std::memcpy(rdram + page * page_size, snapshot_state.data.get() + page * page_size, page_size);
+                clear_page_dirty(page);
+                set_pages_writable(rdram + page * page_size, page_size, false);
+                copied_pages++;
+            }
+        }
+    }
+    else {
+        for (size_t page = 0; page < snapshot_state.page_count; page++) {
+            uint8_t* rdram_page = rdram + page * page_size;
+            const uint8_t* snapshot_page = snapshot_state.data.get() + page * page_size;
+            if (std::memcmp(rdram_page, snapshot_page, page_size) != 0) {
+                std::memcpy(rdram_page, snapshot_page, page_size);
+                copied_pages++;
+            }
+        }
+    }
+
+    return copied_pages;
+}
+
+bool zelda64::has_rdram_snapshot() {
+    return snapshot_state.data != nullptr;
+}
+
+const uint8_t* zelda64::get_rdram_snapshot_data() {
+    return snapshot_state.data.get();
+}
+
+size_t zelda64::get_rdram_snapshot_page_size() {
+    return snapshot_state.page_size;
+}
+
+bool zelda64::is_rdram_write_tracking_active() {
+    return snapshot_state.tracking;
+}
+
+void zelda64::discard_rdram_snapshot(uint8_t* rdram) {
+    if (snapshot_state.tracking) {
+        set_pages_writable(rdram, ultramodern::rdram_size, true);
+        snapshot_state.tracked_end.store(0, std::memory_order_relaxed);
+        snapshot_state.tracked_base.store(0, std::memory_order_release);
+        snapshot_state.tracking = false;
+    }
+
+    snapshot_state.data.reset();
+    snapshot_state.dirty_bits.reset();
+    snapshot_state.page_count = 0;
+}
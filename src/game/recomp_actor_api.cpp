@@ -0,0 +1,207 @@
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "recomp_data.h"
+#include "recomp_profiler.h"
+#include "recomp_ui.h"
+#include "librecomp/helpers.hpp"
+#include "librecomp/overlays.hpp"
+#include "librecomp/addresses.hpp"
+#include "ultramodern/error_handling.hpp"
+
+// Per-object extension data. Mods register a fixed-size block for one of the game's object arrays and get a
+// contiguous arena in RDRAM with one block per slot of that array. Every extension has its own arena (a struct of
+// arrays across all extensions), so registering a new extension never moves the data of existing ones and the
+// address of a block is simply the arena base plus the object index times the stride.
+
+enum class ObjectType : uint32_t {
+    Actor,
+    Boss,
+    Effect,
+    Item,
+    Scenery,
+    Count
+};
+
+// Number of slots in gActors, gBosses, gEffects, gItems and gScenery respectively.
+// Must be kept in sync with the static asserts in patches/object_extension.c!
+static constexpr std::array<uint32_t, static_cast<size_t>(ObjectType::Count)> object_slot_counts = {
+    60, 4, 100, 20, 50
+};
+
+// Blocks are aligned so that mods can store doubles and 64-bit integers in them.
+static constexpr uint32_t extension_alignment = 8;
+
+// Keeps mods from reserving an unreasonable amount of RDRAM by mistake.
+static constexpr uint32_t max_extension_size = 0x10000;
+
+struct ObjectExtension {
+    // The arena's address in RDRAM and the host pointer to it, which is kept so the arena can be cleared without rdram.
+    gpr base;
+    uint8_t* data;
+    uint32_t stride;
+};
+
+struct ObjectExtensionStore {
+    std::mutex mutex;
+    std::array<std::vector<ObjectExtension>, static_cast<size_t>(ObjectType::Count)> extensions;
+};
+
+static ObjectExtensionStore extension_store{};
+
+static void show_fatal_error_message_box(const char* funcname, const char* errstr) {
+    std::string message = std::string{"Fatal error in mod - "} + funcname + " : " + errstr;
+    recompui::message_box(message.c_str());
+}
+
+#define FATAL_MOD_ERROR(errstr) \
+    show_fatal_error_message_box(__FUNCTION__, errstr); \
+    assert(false); \
+    ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+
+static bool is_valid_object_type(uint32_t type) {
+    return type < static_cast<uint32_t>(ObjectType::Count);
+}
+
+static uint32_t get_slot_count(uint32_t type) {
+    return object_slot_counts[type];
+}
+
+// Extension handles are the index of the extension within its object type plus one, so that zero is never valid.
+static const ObjectExtension* get_extension(uint32_t type, uint32_t handle) {
+    const auto& extensions = extension_store.extensions[type];
+    if (handle == 0 || handle > extensions.size()) {
+        return nullptr;
+    }
+
+    return &extensions[handle - 1];
+}
+
+void recomputil::reset_actor_data() {
+    std::lock_guard lock{extension_store.mutex};
+    for (uint32_t type = 0; type < static_cast<uint32_t>(ObjectType::Count); type++) {
+        for (const ObjectExtension& extension : extension_store.extensions[type]) {
+            memset(extension.data, 0, size_t(extension.stride) * get_slot_count(type));
+        }
+    }
+}
+
+// u32 recomputil_register_object_extension(u32 object_type, u32 size)
+// Returns a handle for the new extension. The data for every slot starts out zeroed.
+void recomputil_register_object_extension(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t type = _arg<0, uint32_t>(rdram, ctx);
+    uint32_t size = _arg<1, uint32_t>(rdram, ctx);
+
+    if (!is_valid_object_type(type)) {
+        FATAL_MOD_ERROR("object type is invalid");
+    }
+
+    if (size == 0 || size > max_extension_size) {
+        FATAL_MOD_ERROR("extension size is invalid");
+    }
+
+    uint32_t stride = (size + extension_alignment - 1) & ~(extension_alignment - 1);
+    size_t arena_size = size_t(stride) * get_slot_count(type);
+    void* mem = recomp::alloc(rdram, arena_size);
+    if (mem == nullptr) {
+        FATAL_MOD_ERROR("not enough memory for the extension");
+    }
+    memset(mem, 0, arena_size);
+
+    std::lock_guard lock{extension_store.mutex};
+    auto& extensions = extension_store.extensions[type];
+    extensions.emplace_back(ObjectExtension{
+        .base = reinterpret_cast<uint8_t*>(mem) - rdram + 0xFFFFFFFF80000000ULL,
+        .data = reinterpret_cast<uint8_t*>(mem),
+        .stride = stride
+    });
+
+    _return(ctx, static_cast<uint32_t>(extensions.size()));
+}
+
+// void* recomputil_get_object_extension_base(u32 object_type, u32 extension)
+// Returns the start of the extension's arena. The block for an object is at base + index * stride, where stride is
+// the registered size rounded up to a multiple of 8 bytes. The arena never moves, so the pointer can be cached.
+void recomputil_get_object_extension_base(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t type = _arg<0, uint32_t>(rdram, ctx);
+    uint32_t handle = _arg<1, uint32_t>(rdram, ctx);
+
+    if (!is_valid_object_type(type)) {
+        FATAL_MOD_ERROR("object type is invalid");
+    }
+
+    std::lock_guard lock{extension_store.mutex};
+    const ObjectExtension* extension = get_extension(type, handle);
+    if (extension == nullptr) {
+        FATAL_MOD_ERROR("extension handle is invalid");
+    }
+
+    _return(ctx, static_cast<PTR(void)>(extension->base));
+}
+
+// void* recomputil_get_object_extension_data(u32 object_type, u32 extension, u32 index)
+void recomputil_get_object_extension_data(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t type = _arg<0, uint32_t>(rdram, ctx);
+    uint32_t handle = _arg<1, uint32_t>(rdram, ctx);
+    uint32_t index = _arg<2, uint32_t>(rdram, ctx);
+
+    if (!is_valid_object_type(type)) {
+        FATAL_MOD_ERROR("object type is invalid");
+    }
+
+    if (index >= get_slot_count(type)) {
+        FATAL_MOD_ERROR("object index is out of bounds");
+    }
+
+    std::lock_guard lock{extension_store.mutex};
+    const ObjectExtension* extension = get_extension(type, handle);
+    if (extension == nullptr) {
+        FATAL_MOD_ERROR("extension handle is invalid");
+    }
+
+    _return(ctx, static_cast<PTR(void)>(extension->base + gpr(index) * extension->stride));
+}
+
+// u32 recomputil_get_object_slot_count(u32 object_type)
+void recomputil_get_object_slot_count(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t type = _arg<0, uint32_t>(rdram, ctx);
+
+    if (!is_valid_object_type(type)) {
+        FATAL_MOD_ERROR("object type is invalid");
+    }
+
+    _return(ctx, get_slot_count(type));
+}
+
+// Called by the patches whenever an object is spawned or killed. Only linked through syms.ld, mods can't call it.
+extern "C" void recomputil_clear_object_extension_data(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t type = _arg<0, uint32_t>(rdram, ctx);
+    uint32_t index = _arg<1, uint32_t>(rdram, ctx);
+
+    if (!is_valid_object_type(type) || index >= get_slot_count(type)) {
+        return;
+    }
+
+    std::lock_guard lock{extension_store.mutex};
+    for (const ObjectExtension& extension : extension_store.extensions[type]) {
+        memset(extension.data + size_t(index) * extension.stride, 0, extension.stride);
+    }
+}
+
+// Called by the patches when a level is set up, as every object from the previous level is gone at that point. Only
+// linked through syms.ld like the one above.
+extern "C" void recomputil_reset_object_extension_data(uint8_t* rdram, recomp_context* ctx) {
+    recomputil::reset_actor_data();
+}
+
+#define REGISTER_FUNC(name) REGISTER_PROFILED_FUNC(recomputil::ProfileCategory::DataApi, name)
+
+void recomputil::init_extended_actor_data() {
+    REGISTER_FUNC(recomputil_register_object_extension);
+    REGISTER_FUNC(recomputil_get_object_extension_base);
+    REGISTER_FUNC(recomputil_get_object_extension_data);
+    REGISTER_FUNC(recomputil_get_object_slot_count);
+}
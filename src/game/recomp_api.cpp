@@ -7,6 +7,7 @@
 #include "recomp_ui.h"
 #include "zelda_render.h"
 #include "zelda_sound.h"
+#include "zelda_pacer.h"
 #include "librecomp/helpers.hpp"
 // #include "../patches/input.h"
 // #include "../patches/graphics.h"
@@ -68,7 +69,7 @@ extern "C" void recomp_powf(uint8_t* rdram, recomp_context* ctx) {
 extern "C" void recomp_get_target_framerate(uint8_t* rdram, recomp_context* ctx) {
     int frame_divisor = _arg<0, u32>(rdram, ctx);
 
-    _return(ctx, ultramodern::get_target_framerate(60 / frame_divisor));
+    _return(ctx, ultramodern::get_target_framerate(zelda64::get_paced_refresh_rate(frame_divisor)));
 }
 
 extern "C" void recomp_get_window_resolution(uint8_t* rdram, recomp_context* ctx) {
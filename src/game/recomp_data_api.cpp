@@ -1,176 +1,650 @@
 #include <vector>
 #include <mutex>
-#include <unordered_map>
-#include <unordered_set>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <new>
+#include <algorithm>
+#include <cstring>
 
-#include "slot_map.h"
 #include "recomp_data.h"
+#include "recomp_profiler.h"
 #include "recomp_ui.h"
 #include "librecomp/helpers.hpp"
 #include "librecomp/overlays.hpp"
 #include "librecomp/addresses.hpp"
 #include "ultramodern/error_handling.hpp"
 
-template <typename KeyType, typename ValueType>
-class LockedMap {
+// Open-addressing hash map from u32 keys to 32-bit values with linear probing over a flat array. Readers never take a lock: they validate
+// each probe against a sequence counter and retry if a write happened in the meantime. Writers are serialized by a
+// mutex, which is uncontended in the usual case of a single thread using a map.
+template <typename ValueType>
+class ConcurrentU32Map {
 private:
-    std::mutex mutex{};
-    std::unordered_map<KeyType, ValueType> map{};
+    static_assert(sizeof(ValueType) == sizeof(uint32_t));
+
+    struct Slot {
+        std::atomic<uint32_t> occupied;
+        std::atomic<uint32_t> key;
+        std::atomic<ValueType> value;
+    };
+
+    struct Table {
+        uint32_t mask;
+        std::unique_ptr<Slot[]> slots;
+
+        Table(uint32_t capacity) : mask(capacity - 1), slots(new Slot[capacity]()) {}
+    };
+
+    static constexpr uint32_t min_capacity = 16;
+
+    std::mutex write_mutex{};
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<Table*> table{nullptr};
+    std::atomic<uint32_t> count{0};
+    std::unique_ptr<Table> owned_table;
+    // Tables replaced by a resize stay alive until the map is destroyed, as readers may still be probing them.
+    // Capacity doubles on every resize, so these add up to less than the current table.
+    std::vector<std::unique_ptr<Table>> retired_tables;
+
+    static uint32_t hash(uint32_t key) {
+        key ^= key >> 16;
+        key *= 0x85EBCA6Bu;
+        key ^= key >> 13;
+        key *= 0xC2B2AE35u;
+        key ^= key >> 16;
+        return key;
+    }
+
+    void begin_write() {
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void end_write() {
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    template <typename Func>
+    auto read(Func&& func) const {
+        while (true) {
+            uint32_t start = sequence.load(std::memory_order_acquire);
+            if (start & 1) {
+                continue;
+            }
+
+            auto ret = func(table.load(std::memory_order_acquire));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == start) {
+                return ret;
+            }
+        }
+    }
+
+    // Returns the slot holding the key, or the empty slot that ends its probe sequence. The probe is bounded by the
+    // table's capacity so a reader racing a writer always terminates, even if it sees an inconsistent table.
+    static Slot* find_slot(Table* t, uint32_t key, bool& found) {
+        uint32_t index = hash(key) & t->mask;
+        for (uint32_t i = 0; i <= t->mask; i++) {
+            Slot* slot = &t->slots[index];
+            if (!slot->occupied.load(std::memory_order_relaxed)) {
+                found = false;
+                return slot;
+            }
+            if (slot->key.load(std::memory_order_relaxed) == key) {
+                found = true;
+                return slot;
+            }
+            index = (index + 1) & t->mask;
+        }
+
+        found = false;
+        return nullptr;
+    }
+
+    Table* get_writable_table() {
+        Table* t = owned_table.get();
+        if (t == nullptr) {
+            owned_table = std::make_unique<Table>(min_capacity);
+            t = owned_table.get();
+            table.store(t, std::memory_order_release);
+        }
+        return t;
+    }
+
+    void grow() {
+        Table* old_table = owned_table.get();
+        auto new_table = std::make_unique<Table>((old_table->mask + 1) * 2);
+
+        // Build the new table before publishing it, readers keep probing the old one until then.
+        for (uint32_t i = 0; i <= old_table->mask; i++) {
+            const Slot& old_slot = old_table->slots[i];
+            if (old_slot.occupied.load(std::memory_order_relaxed)) {
+                bool found;
+                Slot* slot = find_slot(new_table.get(), old_slot.key.load(std::memory_order_relaxed), found);
+                slot->key.store(old_slot.key.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                slot->value.store(old_slot.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                slot->occupied.store(1, std::memory_order_relaxed);
+            }
+        }
+
+        begin_write();
+        table.store(new_table.get(), std::memory_order_release);
+        end_write();
+
+        retired_tables.emplace_back(std::move(owned_table));
+        owned_table = std::move(new_table);
+    }
 public:
-    bool get(const KeyType& key, ValueType& out) {
-        std::lock_guard lock{mutex};
-        auto find_it = map.find(key);
-        if (find_it == map.end()) {
+    bool get(uint32_t key, ValueType& out) const {
+        std::pair<bool, ValueType> ret = read([key](Table* t) -> std::pair<bool, ValueType> {
+            if (t == nullptr) {
+                return { false, ValueType{} };
+            }
+            bool found;
+            Slot* slot = find_slot(t, key, found);
+            return { found, found ? slot->value.load(std::memory_order_relaxed) : ValueType{} };
+        });
+
+        out = ret.second;
+        return ret.first;
+    }
+
+    bool contains(uint32_t key) const {
+        return read([key](Table* t) {
+            bool found = false;
+            if (t != nullptr) {
+                find_slot(t, key, found);
+            }
+            return found;
+        });
+    }
+
+private:
+    // Both of these expect the write lock to be held.
+    bool insert_locked(uint32_t key, ValueType value) {
+        Table* t = get_writable_table();
+
+        bool found;
+        Slot* slot = find_slot(t, key, found);
+        if (found) {
+            begin_write();
+            slot->value.store(value, std::memory_order_relaxed);
+            end_write();
             return false;
         }
-        out = find_it->second;
+
+        // Keep the load factor under 3/4 so probe sequences stay short.
+        if ((count.load(std::memory_order_relaxed) + 1) * 4 > (t->mask + 1) * 3) {
+            grow();
+            t = owned_table.get();
+            slot = find_slot(t, key, found);
+        }
+
+        begin_write();
+        slot->key.store(key, std::memory_order_relaxed);
+        slot->value.store(value, std::memory_order_relaxed);
+        slot->occupied.store(1, std::memory_order_relaxed);
+        end_write();
+        count.fetch_add(1, std::memory_order_relaxed);
         return true;
     }
 
-    bool insert(const KeyType& key, ValueType val) {
-        std::lock_guard lock{mutex};
-        auto ret = map.insert_or_assign(key, val);
-        return ret.second;
+    bool erase_locked(uint32_t key) {
+        Table* t = owned_table.get();
+        if (t == nullptr) {
+            return false;
+        }
+
+        bool found;
+        Slot* slot = find_slot(t, key, found);
+        if (!found) {
+            return false;
+        }
+
+        // Backward shift deletion: move later entries of the cluster into the hole whenever their home slot allows
+        // it, so lookups never need tombstones.
+        begin_write();
+        uint32_t hole = static_cast<uint32_t>(slot - t->slots.get());
+        uint32_t cur = hole;
+        while (true) {
+            cur = (cur + 1) & t->mask;
+            Slot& cur_slot = t->slots[cur];
+            if (!cur_slot.occupied.load(std::memory_order_relaxed)) {
+                break;
+            }
+
+            uint32_t home = hash(cur_slot.key.load(std::memory_order_relaxed)) & t->mask;
+            bool stays = (hole <= cur) ? (hole < home && home <= cur) : (hole < home || home <= cur);
+            if (stays) {
+                continue;
+            }
+
+            Slot& hole_slot = t->slots[hole];
+            hole_slot.key.store(cur_slot.key.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            hole_slot.value.store(cur_slot.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            hole = cur;
+        }
+        t->slots[hole].occupied.store(0, std::memory_order_relaxed);
+        end_write();
+
+        count.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+public:
+    // Inserts or assigns the value for the key. Returns true if the key was newly inserted.
+    bool insert(uint32_t key, ValueType value) {
+        std::lock_guard lock{write_mutex};
+        return insert_locked(key, value);
     }
 
-    bool erase(const KeyType& key) {
-        std::lock_guard lock{mutex};
-        size_t num_erased = map.erase(key);
-        return num_erased != 0;
+    // Inserts the value only if the key isn't in the map yet. Returns false, leaving the map unchanged, if it is.
+    bool insert_if_absent(uint32_t key, ValueType value) {
+        std::lock_guard lock{write_mutex};
+        if (owned_table != nullptr) {
+            bool found;
+            find_slot(owned_table.get(), key, found);
+            if (found) {
+                return false;
+            }
+        }
+        return insert_locked(key, value);
     }
 
-    void clear() {
-        std::lock_guard lock{mutex};
-        map.clear();
+    bool erase(uint32_t key) {
+        std::lock_guard lock{write_mutex};
+        return erase_locked(key);
     }
-    
-    bool erase_first(ValueType& out) {
-        std::lock_guard lock{mutex};
-        auto it = map.begin();
 
-        if (it == map.end()) {
+    // Erases the key and hands back the value it had. Only one of several concurrent erases of the same key succeeds,
+    // and the value is read under the same lock, so it's the one that was actually removed.
+    bool erase(uint32_t key, ValueType& removed) {
+        std::lock_guard lock{write_mutex};
+        Table* t = owned_table.get();
+        if (t == nullptr) {
             return false;
         }
 
-        out = it->second;
-        map.erase(it);
-        return true;
+        bool found;
+        Slot* slot = find_slot(t, key, found);
+        if (!found) {
+            return false;
+        }
+
+        removed = slot->value.load(std::memory_order_relaxed);
+        return erase_locked(key);
     }
 
-    bool contains(const KeyType& key) {
-        std::lock_guard lock{mutex};
+    // Batched versions of insert and erase that only take the write lock once. The functions provide the key and value
+    // for each index. Returns the number of keys that were newly inserted or erased respectively.
+    template <typename KeyFunc, typename ValueFunc>
+    uint32_t insert_many(uint32_t num, KeyFunc&& get_key, ValueFunc&& get_value) {
+        std::lock_guard lock{write_mutex};
+        uint32_t inserted = 0;
+        for (uint32_t i = 0; i < num; i++) {
+            inserted += insert_locked(get_key(i), get_value(i)) ? 1 : 0;
+        }
+        return inserted;
+    }
 
-        return map.contains(key);
+    template <typename KeyFunc>
+    uint32_t erase_many(uint32_t num, KeyFunc&& get_key) {
+        std::lock_guard lock{write_mutex};
+        uint32_t erased = 0;
+        for (uint32_t i = 0; i < num; i++) {
+            erased += erase_locked(get_key(i)) ? 1 : 0;
+        }
+        return erased;
     }
 
-    size_t size() {
-        std::lock_guard lock{mutex};
+    void clear() {
+        std::lock_guard lock{write_mutex};
+        Table* t = owned_table.get();
+        if (t == nullptr) {
+            return;
+        }
 
-        return map.size();
+        begin_write();
+        for (uint32_t i = 0; i <= t->mask; i++) {
+            t->slots[i].occupied.store(0, std::memory_order_relaxed);
+        }
+        end_write();
+        count.store(0, std::memory_order_relaxed);
+    }
+
+    // Calls the function with every value in the map. Writes from other threads are blocked during iteration.
+    template <typename Func>
+    void for_each(Func&& func) {
+        std::lock_guard lock{write_mutex};
+        Table* t = owned_table.get();
+        if (t == nullptr) {
+            return;
+        }
+
+        for (uint32_t i = 0; i <= t->mask; i++) {
+            if (t->slots[i].occupied.load(std::memory_order_relaxed)) {
+                func(t->slots[i].value.load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+    size_t size() const {
+        return count.load(std::memory_order_relaxed);
     }
 };
 
-template <typename KeyType>
-class LockedSet {
+class ConcurrentU32Set {
 private:
-    std::mutex mutex{};
-    std::unordered_set<KeyType> set{};
+    ConcurrentU32Map<uint32_t> map{};
 public:
-    bool contains(const KeyType& key) {
-        std::lock_guard lock{mutex};
-        return set.contains(key);
+    bool contains(uint32_t key) const {
+        return map.contains(key);
     }
 
-    bool insert(const KeyType& key) {
-        std::lock_guard lock{mutex};
-        auto it = set.insert(key);
-        return it.second;
+    bool insert(uint32_t key) {
+        return map.insert(key, 0);
     }
 
-    bool erase(const KeyType& key) {
-        std::lock_guard lock{mutex};
-        size_t num_erased = set.erase(key);
-        return num_erased != 0;
+    bool erase(uint32_t key) {
+        return map.erase(key);
+    }
+
+    template <typename KeyFunc>
+    uint32_t insert_many(uint32_t num, KeyFunc&& get_key) {
+        return map.insert_many(num, get_key, [](uint32_t) { return 0u; });
+    }
+
+    template <typename KeyFunc>
+    uint32_t erase_many(uint32_t num, KeyFunc&& get_key) {
+        return map.erase_many(num, get_key);
     }
 
     void clear() {
-        std::lock_guard lock{mutex};
-        set.clear();
+        map.clear();
     }
 
-    size_t size() {
-        std::lock_guard lock{mutex};
-        return set.size();
+    size_t size() const {
+        return map.size();
     }
 };
 
-template <typename ValueType>
-class LockedSlotmap {
+// Objects referenced by 32-bit handles made of a 20-bit slot index and a 12-bit generation, the same layout as
+// dod::slot_map32 keys. Looking up a handle is a lock-free array access that checks the generation, so stale handles
+// are rejected without taking a lock. Slots live in chunks that never move, so pointers returned by get remain valid
+// until the handle is erased. Creating and erasing handles is serialized by a mutex.
+template <typename T>
+class HandleTable {
 private:
+    static constexpr uint32_t index_bits = 20;
+    static constexpr uint32_t index_mask = (1u << index_bits) - 1;
+    static constexpr uint32_t generation_mask = (1u << (32 - index_bits)) - 1;
+    static constexpr uint32_t chunk_bits = 10;
+    static constexpr uint32_t chunk_size = 1u << chunk_bits;
+    static constexpr uint32_t max_chunks = 1u << (index_bits - chunk_bits);
+    // Freed slots are only reused once this many are available, which spreads out generation reuse.
+    static constexpr size_t min_free_slots = 64;
+
+    struct Slot {
+        // The handle that currently owns this slot, or 0 if it's free.
+        std::atomic<uint32_t> handle;
+        uint32_t generation;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* value() {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+
     std::mutex mutex{};
-    dod::slot_map32<ValueType> map{};
-    using key_t = typename dod::slot_map32<ValueType>::key;
+    std::atomic<Slot*> chunks[max_chunks]{};
+    uint32_t used_slots = 0;
+    std::deque<uint32_t> free_slots{};
+    std::atomic<uint32_t> count{0};
+
+    Slot* get_slot(uint32_t index) const {
+        Slot* chunk = chunks[index >> chunk_bits].load(std::memory_order_acquire);
+        return chunk != nullptr ? &chunk[index & (chunk_size - 1)] : nullptr;
+    }
+
+    // Both of these expect the mutex to be held.
+    uint32_t create_locked() {
+        uint32_t index;
+        if (free_slots.size() > min_free_slots || (used_slots == (index_mask + 1) && !free_slots.empty())) {
+            index = free_slots.front();
+            free_slots.pop_front();
+        }
+        else if (used_slots <= index_mask) {
+            index = used_slots++;
+            std::atomic<Slot*>& chunk = chunks[index >> chunk_bits];
+            if (chunk.load(std::memory_order_relaxed) == nullptr) {
+                chunk.store(new Slot[chunk_size](), std::memory_order_release);
+            }
+        }
+        else {
+            return 0;
+        }
+
+        Slot* slot = get_slot(index);
+        // Generation 0 is skipped so a valid handle is never 0.
+        slot->generation = (slot->generation & generation_mask) + 1;
+        if (slot->generation > generation_mask) {
+            slot->generation = 1;
+        }
+
+        new (slot->storage) T();
+        uint32_t handle = (slot->generation << index_bits) | index;
+        slot->handle.store(handle, std::memory_order_release);
+        count.fetch_add(1, std::memory_order_relaxed);
+        return handle;
+    }
+
+    bool erase_locked(uint32_t handle) {
+        uint32_t index = handle & index_mask;
+        Slot* slot = get_slot(index);
+        if (handle == 0 || slot == nullptr || slot->handle.load(std::memory_order_relaxed) != handle) {
+            return false;
+        }
+
+        slot->handle.store(0, std::memory_order_release);
+        slot->value()->~T();
+        free_slots.push_back(index);
+        count.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
 public:
-    bool get(uint32_t key, ValueType** out) {
-        std::lock_guard lock{mutex};
-        ValueType* ret = map.get(key_t{key});
-        *out = ret;
-        return ret != nullptr;
+    HandleTable() = default;
+    HandleTable(const HandleTable&) = delete;
+    HandleTable& operator=(const HandleTable&) = delete;
+
+    ~HandleTable() {
+        for (uint32_t i = 0; i < used_slots; i++) {
+            Slot* slot = get_slot(i);
+            if (slot->handle.load(std::memory_order_relaxed) != 0) {
+                slot->value()->~T();
+            }
+        }
+
+        for (std::atomic<Slot*>& chunk : chunks) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
     }
 
+    bool get(uint32_t handle, T** out) const {
+        Slot* slot = get_slot(handle & index_mask);
+        if (handle == 0 || slot == nullptr || slot->handle.load(std::memory_order_acquire) != handle) {
+            *out = nullptr;
+            return false;
+        }
+
+        *out = slot->value();
+        return true;
+    }
+
+    // Returns 0 if every slot is in use.
     uint32_t create() {
         std::lock_guard lock{mutex};
-        return map.emplace().raw;
+        return create_locked();
     }
 
-    bool erase(uint32_t key) {
+    bool erase(uint32_t handle) {
         std::lock_guard lock{mutex};
-        if (!map.has_key(key_t{ key })) {
+        return erase_locked(handle);
+    }
+
+    // Erases the handle and moves its value out. Only one of several concurrent erases of the same handle succeeds, so
+    // only that caller gets the value.
+    bool erase(uint32_t handle, T& removed) {
+        std::lock_guard lock{mutex};
+        T* value;
+        if (!get(handle, &value)) {
             return false;
         }
 
-        map.erase(key_t{ key });
-        return true;
+        removed = std::move(*value);
+        return erase_locked(handle);
     }
 
-    void clear() {
+    // Batched versions of create and erase that only take the lock once. Returns the number of handles created or
+    // erased respectively.
+    template <typename StoreFunc>
+    uint32_t create_many(uint32_t num, StoreFunc&& store_handle) {
         std::lock_guard lock{mutex};
-        map.clear();
+        uint32_t created = 0;
+        for (uint32_t i = 0; i < num; i++) {
+            uint32_t handle = create_locked();
+            store_handle(i, handle);
+            created += handle != 0 ? 1 : 0;
+        }
+        return created;
     }
-    
-    bool erase_first(ValueType& out) {
+
+    template <typename HandleFunc>
+    uint32_t erase_many(uint32_t num, HandleFunc&& get_handle) {
+        std::lock_guard lock{mutex};
+        uint32_t erased = 0;
+        for (uint32_t i = 0; i < num; i++) {
+            erased += erase_locked(get_handle(i)) ? 1 : 0;
+        }
+        return erased;
+    }
+
+    // Calls the function with every live value. Handles can't be created or erased during iteration.
+    template <typename Func>
+    void for_each(Func&& func) {
         std::lock_guard lock{mutex};
-        auto it = map.items().begin();
+        for (uint32_t i = 0; i < used_slots; i++) {
+            Slot* slot = get_slot(i);
+            if (slot->handle.load(std::memory_order_relaxed) != 0) {
+                func(*slot->value());
+            }
+        }
+    }
 
-        if (it == map.items().end()) {
-            return false;
+    size_t size() const {
+        return count.load(std::memory_order_relaxed);
+    }
+};
+
+// Allocator for the fixed-size elements of a memory hashmap or slotmap. Cells are carved out of large chunks allocated
+// in RDRAM and recycled through a free list, so creating and erasing keys doesn't go through recomp::alloc each time.
+class RdramSlab {
+public:
+    struct Stats {
+        uint32_t cell_size;
+        uint32_t live_cells;
+        uint32_t free_cells;
+        uint32_t chunk_count;
+        uint32_t reserved_bytes;
+    };
+private:
+    static constexpr uint32_t cell_alignment = 8;
+    static constexpr uint32_t target_chunk_size = 16 * 1024;
+
+    std::mutex mutex{};
+    uint32_t cell_size = cell_alignment;
+    uint32_t cells_per_chunk = target_chunk_size / cell_alignment;
+    std::vector<gpr> chunks{};
+    std::vector<PTR(void)> free_cells{};
+    uint32_t next_uncarved = 0;
+    uint32_t live_cells = 0;
+public:
+    void init(uint32_t element_size) {
+        // Rounding up to a multiple of 8 keeps every cell aligned for 64-bit fields and made of whole RDRAM words,
+        // so a host memset clears exactly the cell regardless of RDRAM's byte swapping.
+        cell_size = std::max(cell_alignment, (element_size + cell_alignment - 1) & ~(cell_alignment - 1));
+        cells_per_chunk = std::max(1u, target_chunk_size / cell_size);
+    }
+
+    // Returns a zeroed cell, or NULLPTR if a new chunk was needed and couldn't be allocated.
+    PTR(void) alloc(uint8_t* rdram) {
+        std::lock_guard lock{mutex};
+        gpr addr;
+        if (!free_cells.empty()) {
+            addr = static_cast<gpr>(static_cast<int64_t>(free_cells.back()));
+            free_cells.pop_back();
+        }
+        else {
+            if (chunks.empty() || next_uncarved == cells_per_chunk) {
+                void* mem = recomp::alloc(rdram, cells_per_chunk * cell_size);
+                if (mem == nullptr) {
+                    return NULLPTR;
+                }
+                chunks.push_back(reinterpret_cast<uint8_t*>(mem) - rdram + 0xFFFFFFFF80000000ULL);
+                next_uncarved = 0;
+            }
+            addr = chunks.back() + next_uncarved * cell_size;
+            next_uncarved++;
         }
 
-        out = it->second;
-        map.erase(it->first);
-        return true;
+        memset(TO_PTR(void, addr), 0, cell_size);
+        live_cells++;
+        return static_cast<PTR(void)>(addr);
     }
 
-    size_t size() {
+    void free(PTR(void) cell) {
         std::lock_guard lock{mutex};
+        free_cells.push_back(cell);
+        live_cells--;
+    }
 
-        return map.size();
+    // Frees every chunk at once, invalidating all cells.
+    void release(uint8_t* rdram) {
+        std::lock_guard lock{mutex};
+        for (gpr chunk : chunks) {
+            recomp::free(rdram, TO_PTR(void, chunk));
+        }
+        chunks.clear();
+        free_cells.clear();
+        next_uncarved = 0;
+        live_cells = 0;
+    }
+
+    Stats get_stats() {
+        std::lock_guard lock{mutex};
+        return Stats{
+            .cell_size = cell_size,
+            .live_cells = live_cells,
+            .free_cells = static_cast<uint32_t>(free_cells.size()),
+            .chunk_count = static_cast<uint32_t>(chunks.size()),
+            .reserved_bytes = static_cast<uint32_t>(chunks.size()) * cells_per_chunk * cell_size,
+        };
     }
 };
 
-using U32ValueMap = LockedMap<uint32_t, uint32_t>;
-using U32MemoryMap = std::pair<LockedMap<uint32_t, PTR(void)>, u32>;
-using U32HashSet = LockedSet<uint32_t>;
-using U32Slotmap = LockedSlotmap<uint32_t>;
-using MemorySlotmap = std::pair<LockedSlotmap<PTR(void)>, u32>;
+using U32ValueMap = ConcurrentU32Map<uint32_t>;
+using U32MemoryMap = std::pair<ConcurrentU32Map<PTR(void)>, RdramSlab>;
+using U32HashSet = ConcurrentU32Set;
+using U32Slotmap = HandleTable<uint32_t>;
+using MemorySlotmap = std::pair<HandleTable<PTR(void)>, RdramSlab>;
 
-LockedSlotmap<U32ValueMap> u32_value_hashmaps{};
-LockedSlotmap<U32MemoryMap> u32_memory_hashmaps{};
-LockedSlotmap<U32HashSet> u32_hashsets{};
-LockedSlotmap<U32Slotmap> u32_slotmaps{};
-LockedSlotmap<MemorySlotmap> memory_slotmaps{};
+HandleTable<U32ValueMap> u32_value_hashmaps{};
+HandleTable<U32MemoryMap> u32_memory_hashmaps{};
+HandleTable<U32HashSet> u32_hashsets{};
+HandleTable<U32Slotmap> u32_slotmaps{};
+HandleTable<MemorySlotmap> memory_slotmaps{};
 
-#define REGISTER_FUNC(name) recomp::overlays::register_base_export(#name, name)
+#define REGISTER_FUNC(name) REGISTER_PROFILED_FUNC(recomputil::ProfileCategory::DataApi, name)
 
 static void show_fatal_error_message_box(const char* funcname, const char* errstr) {
     std::string message = std::string{"Fatal error in mod - "} + funcname + " : " + errstr;
@@ -187,11 +661,30 @@ static void show_fatal_error_message_box(const char* funcname, const char* errst
     assert(false); \
     ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
 
+#define HANDLES_EXHAUSTED_ERROR() \
+    show_fatal_error_message_box(__FUNCTION__, "too many handles are in use"); \
+    assert(false); \
+    ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+
+#define OUT_OF_MEMORY_ERROR() \
+    show_fatal_error_message_box(__FUNCTION__, "not enough memory for the element"); \
+    assert(false); \
+    ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+
+// Creates a handle in the given table, failing with a fatal mod error if every handle is in use.
+#define CREATE_HANDLE_OR_ERROR(out, table) \
+    out = (table).create(); \
+    if (out == 0) { \
+        HANDLES_EXHAUSTED_ERROR(); \
+    }
+
 // u32 -> 32-bit value hashmap.
 
 void recomputil_create_u32_value_hashmap(uint8_t* rdram, recomp_context* ctx) {
     (void)rdram;
-    _return(ctx, u32_value_hashmaps.create());
+    uint32_t map_key;
+    CREATE_HANDLE_OR_ERROR(map_key, u32_value_hashmaps);
+    _return(ctx, map_key);
 }
 
 void recomputil_destroy_u32_value_hashmap(uint8_t* rdram, recomp_context* ctx) {
@@ -272,18 +765,99 @@ void recomputil_u32_value_hashmap_size(uint8_t* rdram, recomp_context* ctx) {
     _return(ctx, static_cast<uint32_t>(map->size()));
 }
 
+// Batched versions of the functions above, which process arrays of keys in RDRAM in a single call.
+// For get_many, entries of the output array whose key isn't in the map are left untouched.
+
+void recomputil_u32_value_hashmap_contains_many(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t mapkey = _arg<0, uint32_t>(rdram, ctx);
+    PTR(u32) keys = _arg<1, PTR(u32)>(rdram, ctx);
+    PTR(u8) results_out = _arg<2, PTR(u8)>(rdram, ctx);
+    uint32_t count = _arg<3, uint32_t>(rdram, ctx);
+
+    U32ValueMap* map;
+    if (!u32_value_hashmaps.get(mapkey, &map)) {
+        HANDLE_INVALID_ERROR();
+    }
+
+    uint32_t num_found = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        bool found = map->contains(MEM_W(i * sizeof(u32), keys));
+        MEM_B(i, results_out) = found ? 1 : 0;
+        num_found += found ? 1 : 0;
+    }
+
+    _return(ctx, num_found);
+}
+
+void recomputil_u32_value_hashmap_insert_many(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t mapkey = _arg<0, uint32_t>(rdram, ctx);
+    PTR(u32) keys = _arg<1, PTR(u32)>(rdram, ctx);
+    PTR(u32) values = _arg<2, PTR(u32)>(rdram, ctx);
+    uint32_t count = _arg<3, uint32_t>(rdram, ctx);
+
+    U32ValueMap* map;
+    if (!u32_value_hashmaps.get(mapkey, &map)) {
+        HANDLE_INVALID_ERROR();
+    }
+
+    uint32_t num_inserted = map->insert_many(count,
+        [rdram, keys](uint32_t i) -> uint32_t { return MEM_W(i * sizeof(u32), keys); },
+        [rdram, values](uint32_t i) -> uint32_t { return MEM_W(i * sizeof(u32), values); });
+
+    _return(ctx, num_inserted);
+}
+
+void recomputil_u32_value_hashmap_get_many(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t mapkey = _arg<0, uint32_t>(rdram, ctx);
+    PTR(u32) keys = _arg<1, PTR(u32)>(rdram, ctx);
+    PTR(u32) values_out = _arg<2, PTR(u32)>(rdram, ctx);
+    uint32_t count = _arg<3, uint32_t>(rdram, ctx);
+
+    U32ValueMap* map;
+    if (!u32_value_hashmaps.get(mapkey, &map)) {
+        HANDLE_INVALID_ERROR();
+    }
+
+    uint32_t num_found = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t value;
+        if (map->get(MEM_W(i * sizeof(u32), keys), value)) {
+            MEM_W(i * sizeof(u32), values_out) = value;
+            num_found++;
+        }
+    }
+
+    _return(ctx, num_found);
+}
+
+void recomputil_u32_value_hashmap_erase_many(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t mapkey = _arg<0, uint32_t>(rdram, ctx);
+    PTR(u32) keys = _arg<1, PTR(u32)>(rdram, ctx);
+    uint32_t count = _arg<2, uint32_t>(rdram, ctx);
+
+    U32ValueMap* map;
+    if (!u32_value_hashmaps.get(mapkey, &map)) {
+        HANDLE_INVALID_ERROR();
+    }
+
+    uint32_t num_erased = map->erase_many(count, [rdram, keys](uint32_t i) -> uint32_t { return MEM_W(i * sizeof(u32), keys); });
+
+    _return(ctx, num_erased);
+}
+
 // u32 -> memory hashmap.
 
 void recomputil_create_u32_memory_hashmap(uint8_t* rdram, recomp_context* ctx) {
     uint32_t element_size = _arg<0, uint32_t>(rdram, ctx);
     
     // Create the map.
-    uint32_t map_key = u32_memory_hashmaps.create();
+    uint32_t map_key;
+    CREATE_HANDLE_OR_ERROR(map_key, u32_memory_hashmaps);
 
     // Retrieve the map and set its element size to the provided value.
     U32MemoryMap* map;
     u32_memory_hashmaps.get(map_key, &map);
-    map->second = element_size;
+    map->second.init(element_size);
 
     // Return the created map's key.
     _return(ctx, map_key);
@@ -299,10 +873,7 @@ void recomputil_destroy_u32_memory_hashmap(uint8_t* rdram, recomp_context* ctx)
     }
 
     // Free all of the entries in the map.
-    PTR(void) cur_mem;
-    while (map->first.erase_first(cur_mem)) {
-        recomp::free(rdram, TO_PTR(void, cur_mem));
-    }
+    map->second.release(rdram);
 
     // Destroy the map itself.
     u32_memory_hashmaps.erase(mapkey);
@@ -329,24 +900,23 @@ void recomputil_u32_memory_hashmap_create(uint8_t* rdram, recomp_context* ctx) {
         HANDLE_INVALID_ERROR();
     }
     
-    // Check if the map contains the key already to prevent inserting it twice.
-    PTR(void) dummy;
-    if (map->first.get(key, dummy)) {
+    // Skip allocating if the map clearly contains the key already.
+    if (map->first.contains(key)) {
         _return(ctx, 0);
         return;
     }
 
-    // Allocate the map's size and return the pointer.
-    void* mem = recomp::alloc(rdram, map->second);
-    gpr addr = reinterpret_cast<uint8_t*>(mem) - rdram + 0xFFFFFFFF80000000ULL;
-
-    // Zero the memory.
-    for (size_t i = 0; i < map->second; i++) {
-        MEM_B(i, addr) = 0;
+    // Allocate a zeroed element and store its pointer, unless another thread created the key in the meantime. The
+    // check and the insert happen under the map's lock, so only one element can end up in the map for the key.
+    PTR(void) ret = map->second.alloc(rdram);
+    if (ret == NULLPTR) {
+        OUT_OF_MEMORY_ERROR();
+    }
+    if (!map->first.insert_if_absent(key, ret)) {
+        map->second.free(ret);
+        _return(ctx, 0);
+        return;
     }
-
-    PTR(void) ret = static_cast<PTR(void)>(addr);
-    map->first.insert(key, ret);
     _return(ctx, 1);
 }
 
@@ -379,15 +949,14 @@ void recomputil_u32_memory_hashmap_erase(uint8_t* rdram, recomp_context* ctx) {
         HANDLE_INVALID_ERROR();
     }
     
-    // Free the memory for this key if the key exists.
+    // Free the memory for this key if this call is the one that erased it, using the pointer the erase removed.
     PTR(void) addr;
-    bool has_value = map->first.get(key, addr);
-    if (has_value) {
-        void* mem = TO_PTR(void, addr);
-        recomp::free(rdram, mem);
+    bool erased = map->first.erase(key, addr);
+    if (erased) {
+        map->second.free(addr);
     }
 
-    _return(ctx, map->first.erase(key));
+    _return(ctx, erased);
 }
 
 void recomputil_u32_memory_hashmap_size(uint8_t* rdram, recomp_context* ctx) {
@@ -401,11 +970,34 @@ void recomputil_u32_memory_hashmap_size(uint8_t* rdram, recomp_context* ctx) {
     _return(ctx, static_cast<uint32_t>(map->first.size()));
 }
 
+// The layout written here must be kept in sync with RecomputilSlabStats in patches/recomputil_funcs.h!
+static void write_slab_stats(uint8_t* rdram, PTR(void) stats_out, const RdramSlab::Stats& stats) {
+    MEM_W(0x00, stats_out) = stats.cell_size;
+    MEM_W(0x04, stats_out) = stats.live_cells;
+    MEM_W(0x08, stats_out) = stats.free_cells;
+    MEM_W(0x0C, stats_out) = stats.chunk_count;
+    MEM_W(0x10, stats_out) = stats.reserved_bytes;
+}
+
+void recomputil_u32_memory_hashmap_get_stats(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t mapkey = _arg<0, uint32_t>(rdram, ctx);
+    PTR(void) stats_out = _arg<1, PTR(void)>(rdram, ctx);
+
+    U32MemoryMap* map;
+    if (!u32_memory_hashmaps.get(mapkey, &map)) {
+        HANDLE_INVALID_ERROR();
+    }
+
+    write_slab_stats(rdram, stats_out, map->second.get_stats());
+}
+
 // u32 hashset.
 
 void recomputil_create_u32_hashset(uint8_t* rdram, recomp_context* ctx) {
     (void)rdram;
-    _return(ctx, u32_hashsets.create());
+    uint32_t set_key;
+    CREATE_HANDLE_OR_ERROR(set_key, u32_hashsets);
+    _return(ctx, set_key);
 }
 
 void recomputil_destroy_u32_hashset(uint8_t* rdram, recomp_context* ctx) {
@@ -463,11 +1055,64 @@ void recomputil_u32_hashset_size(uint8_t* rdram, recomp_context* ctx) {
     _return(ctx, static_cast<uint32_t>(set->size()));
 }
 
+void recomputil_u32_hashset_contains_many(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t setkey = _arg<0, uint32_t>(rdram, ctx);
+    PTR(u32) keys = _arg<1, PTR(u32)>(rdram, ctx);
+    PTR(u8) results_out = _arg<2, PTR(u8)>(rdram, ctx);
+    uint32_t count = _arg<3, uint32_t>(rdram, ctx);
+
+    U32HashSet* set;
+    if (!u32_hashsets.get(setkey, &set)) {
+        HANDLE_INVALID_ERROR();
+    }
+
+    uint32_t num_found = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        bool found = set->contains(MEM_W(i * sizeof(u32), keys));
+        MEM_B(i, results_out) = found ? 1 : 0;
+        num_found += found ? 1 : 0;
+    }
+
+    _return(ctx, num_found);
+}
+
+void recomputil_u32_hashset_insert_many(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t setkey = _arg<0, uint32_t>(rdram, ctx);
+    PTR(u32) keys = _arg<1, PTR(u32)>(rdram, ctx);
+    uint32_t count = _arg<2, uint32_t>(rdram, ctx);
+
+    U32HashSet* set;
+    if (!u32_hashsets.get(setkey, &set)) {
+        HANDLE_INVALID_ERROR();
+    }
+
+    uint32_t num_inserted = set->insert_many(count, [rdram, keys](uint32_t i) -> uint32_t { return MEM_W(i * sizeof(u32), keys); });
+
+    _return(ctx, num_inserted);
+}
+
+void recomputil_u32_hashset_erase_many(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t setkey = _arg<0, uint32_t>(rdram, ctx);
+    PTR(u32) keys = _arg<1, PTR(u32)>(rdram, ctx);
+    uint32_t count = _arg<2, uint32_t>(rdram, ctx);
+
+    U32HashSet* set;
+    if (!u32_hashsets.get(setkey, &set)) {
+        HANDLE_INVALID_ERROR();
+    }
+
+    uint32_t num_erased = set->erase_many(count, [rdram, keys](uint32_t i) -> uint32_t { return MEM_W(i * sizeof(u32), keys); });
+
+    _return(ctx, num_erased);
+}
+
 // u32 value slotmap.
 
 void recomputil_create_u32_slotmap(uint8_t* rdram, recomp_context* ctx) {
     (void)rdram;
-    _return(ctx, u32_slotmaps.create());
+    uint32_t map_key;
+    CREATE_HANDLE_OR_ERROR(map_key, u32_slotmaps);
+    _return(ctx, map_key);
 }
 
 void recomputil_destroy_u32_slotmap(uint8_t* rdram, recomp_context* ctx) {
@@ -499,7 +1144,9 @@ void recomputil_u32_slotmap_create(uint8_t* rdram, recomp_context* ctx) {
         HANDLE_INVALID_ERROR();
     }
 
-    _return(ctx, map->create());
+    uint32_t key;
+    CREATE_HANDLE_OR_ERROR(key, *map);
+    _return(ctx, key);
 }
 
 void recomputil_u32_slotmap_get(uint8_t* rdram, recomp_context* ctx) {
@@ -515,6 +1162,7 @@ void recomputil_u32_slotmap_get(uint8_t* rdram, recomp_context* ctx) {
     uint32_t* ret;
     if (!map->get(key, &ret)) {
         _return(ctx, 0);
+        return;
     }
     MEM_W(0, val_out) = *ret;
     _return(ctx, 1);
@@ -533,6 +1181,7 @@ void recomputil_u32_slotmap_set(uint8_t* rdram, recomp_context* ctx) {
     uint32_t* value_ptr;
     if (!map->get(key, &value_ptr)) {
         _return(ctx, 0);
+        return;
     }
 
     *value_ptr = value;
@@ -550,6 +1199,7 @@ void recomputil_u32_slotmap_erase(uint8_t* rdram, recomp_context* ctx) {
     
     if (!map->erase(key)) {
         _return(ctx, 0);
+        return;
     }
     
     _return(ctx, 1);
@@ -566,11 +1216,120 @@ void recomputil_u32_slotmap_size(uint8_t* rdram, recomp_context* ctx) {
     _return(ctx, static_cast<uint32_t>(map->size()));
 }
 
+void recomputil_u32_slotmap_contains_many(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t mapkey = _arg<0, uint32_t>(rdram, ctx);
+    PTR(u32) keys = _arg<1, PTR(u32)>(rdram, ctx);
+    PTR(u8) results_out = _arg<2, PTR(u8)>(rdram, ctx);
+    uint32_t count = _arg<3, uint32_t>(rdram, ctx);
+
+    U32Slotmap* map;
+    if (!u32_slotmaps.get(mapkey, &map)) {
+        HANDLE_INVALID_ERROR();
+    }
+
+    uint32_t num_found = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t* dummy_ptr;
+        bool found = map->get(MEM_W(i * sizeof(u32), keys), &dummy_ptr);
+        MEM_B(i, results_out) = found ? 1 : 0;
+        num_found += found ? 1 : 0;
+    }
+
+    _return(ctx, num_found);
+}
+
+void recomputil_u32_slotmap_create_many(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t mapkey = _arg<0, uint32_t>(rdram, ctx);
+    PTR(u32) keys_out = _arg<1, PTR(u32)>(rdram, ctx);
+    uint32_t count = _arg<2, uint32_t>(rdram, ctx);
+
+    U32Slotmap* map;
+    if (!u32_slotmaps.get(mapkey, &map)) {
+        HANDLE_INVALID_ERROR();
+    }
+
+    uint32_t num_created = map->create_many(count, [rdram, keys_out](uint32_t i, uint32_t key) { MEM_W(i * sizeof(u32), keys_out) = key; });
+
+    _return(ctx, num_created);
+}
+
+void recomputil_u32_slotmap_get_many(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t mapkey = _arg<0, uint32_t>(rdram, ctx);
+    PTR(u32) keys = _arg<1, PTR(u32)>(rdram, ctx);
+    PTR(u32) values_out = _arg<2, PTR(u32)>(rdram, ctx);
+    uint32_t count = _arg<3, uint32_t>(rdram, ctx);
+
+    U32Slotmap* map;
+    if (!u32_slotmaps.get(mapkey, &map)) {
+        HANDLE_INVALID_ERROR();
+    }
+
+    uint32_t num_found = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t* value_ptr;
+        if (map->get(MEM_W(i * sizeof(u32), keys), &value_ptr)) {
+            MEM_W(i * sizeof(u32), values_out) = *value_ptr;
+            num_found++;
+        }
+    }
+
+    _return(ctx, num_found);
+}
+
+void recomputil_u32_slotmap_set_many(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t mapkey = _arg<0, uint32_t>(rdram, ctx);
+    PTR(u32) keys = _arg<1, PTR(u32)>(rdram, ctx);
+    PTR(u32) values = _arg<2, PTR(u32)>(rdram, ctx);
+    uint32_t count = _arg<3, uint32_t>(rdram, ctx);
+
+    U32Slotmap* map;
+    if (!u32_slotmaps.get(mapkey, &map)) {
+        HANDLE_INVALID_ERROR();
+    }
+
+    uint32_t num_set = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t* value_ptr;
+        if (map->get(MEM_W(i * sizeof(u32), keys), &value_ptr)) {
+            *value_ptr = MEM_W(i * sizeof(u32), values);
+            num_set++;
+        }
+    }
+
+    _return(ctx, num_set);
+}
+
+void recomputil_u32_slotmap_erase_many(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t mapkey = _arg<0, uint32_t>(rdram, ctx);
+    PTR(u32) keys = _arg<1, PTR(u32)>(rdram, ctx);
+    uint32_t count = _arg<2, uint32_t>(rdram, ctx);
+
+    U32Slotmap* map;
+    if (!u32_slotmaps.get(mapkey, &map)) {
+        HANDLE_INVALID_ERROR();
+    }
+
+    uint32_t num_erased = map->erase_many(count, [rdram, keys](uint32_t i) -> uint32_t { return MEM_W(i * sizeof(u32), keys); });
+
+    _return(ctx, num_erased);
+}
+
 // memory slotmap.
 
 void recomputil_create_memory_slotmap(uint8_t* rdram, recomp_context* ctx) {
-    (void)rdram;
-    _return(ctx, memory_slotmaps.create());
+    uint32_t element_size = _arg<0, uint32_t>(rdram, ctx);
+
+    // Create the map.
+    uint32_t map_key;
+    CREATE_HANDLE_OR_ERROR(map_key, memory_slotmaps);
+
+    // Retrieve the map and set its element size to the provided value.
+    MemorySlotmap* map;
+    memory_slotmaps.get(map_key, &map);
+    map->second.init(element_size);
+
+    // Return the created map's key.
+    _return(ctx, map_key);
 }
 
 void recomputil_destroy_memory_slotmap(uint8_t* rdram, recomp_context* ctx) {
@@ -583,10 +1342,7 @@ void recomputil_destroy_memory_slotmap(uint8_t* rdram, recomp_context* ctx) {
     }
 
     // Free all of the entries in the map.
-    PTR(void) cur_mem;
-    while (map->first.erase_first(cur_mem)) {
-        recomp::free(rdram, TO_PTR(void, cur_mem));
-    }
+    map->second.release(rdram);
 
     // Destroy the map itself.
     memory_slotmaps.erase(mapkey);
@@ -613,22 +1369,18 @@ void recomputil_memory_slotmap_create(uint8_t* rdram, recomp_context* ctx) {
         HANDLE_INVALID_ERROR();
     }
 
-    // Create the slotmap element.
-    u32 key = map->first.create();
-
-    // Allocate the map's element size.
-    void* mem = recomp::alloc(rdram, map->second);
-    gpr addr = reinterpret_cast<uint8_t*>(mem) - rdram + 0xFFFFFFFF80000000ULL;
-
-    // Zero the memory.
-    for (size_t i = 0; i < map->second; i++) {
-        MEM_B(i, addr) = 0;
+    // Allocate a zeroed element.
+    PTR(void) element = map->second.alloc(rdram);
+    if (element == NULLPTR) {
+        OUT_OF_MEMORY_ERROR();
     }
 
-    // Store the allocated pointer.
+    // Create the slotmap element and store its pointer.
+    u32 key;
+    CREATE_HANDLE_OR_ERROR(key, map->first);
     PTR(void)* value_ptr;
     map->first.get(key, &value_ptr);
-    MEM_W(0, *value_ptr) = addr;
+    *value_ptr = element;
 
     // Return the key.
     _return(ctx, key);
@@ -660,15 +1412,14 @@ void recomputil_memory_slotmap_erase(uint8_t* rdram, recomp_context* ctx) {
         HANDLE_INVALID_ERROR();
     }
     
-    // Free the memory for this key if the key exists.
-    PTR(void)* addr;
-    bool has_value = map->first.get(key, &addr);
-    if (has_value) {
-        void* mem = TO_PTR(void, addr);
-        recomp::free(rdram, mem);
+    // Free the memory for this key if this call is the one that erased it.
+    PTR(void) addr;
+    bool erased = map->first.erase(key, addr);
+    if (erased) {
+        map->second.free(addr);
     }
 
-    _return(ctx, map->first.erase(key));
+    _return(ctx, erased);
 }
 
 void recomputil_memory_slotmap_size(uint8_t* rdram, recomp_context* ctx) {
@@ -682,6 +1433,18 @@ void recomputil_memory_slotmap_size(uint8_t* rdram, recomp_context* ctx) {
     _return(ctx, static_cast<uint32_t>(map->first.size()));
 }
 
+void recomputil_memory_slotmap_get_stats(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t mapkey = _arg<0, uint32_t>(rdram, ctx);
+    PTR(void) stats_out = _arg<1, PTR(void)>(rdram, ctx);
+
+    MemorySlotmap* map;
+    if (!memory_slotmaps.get(mapkey, &map)) {
+        HANDLE_INVALID_ERROR();
+    }
+
+    write_slab_stats(rdram, stats_out, map->second.get_stats());
+}
+
 // Exports.
 
 void recomputil::register_data_api_exports() {
@@ -692,6 +1455,10 @@ void recomputil::register_data_api_exports() {
     REGISTER_FUNC(recomputil_u32_value_hashmap_get);
     REGISTER_FUNC(recomputil_u32_value_hashmap_erase);
     REGISTER_FUNC(recomputil_u32_value_hashmap_size);
+    REGISTER_FUNC(recomputil_u32_value_hashmap_contains_many);
+    REGISTER_FUNC(recomputil_u32_value_hashmap_insert_many);
+    REGISTER_FUNC(recomputil_u32_value_hashmap_get_many);
+    REGISTER_FUNC(recomputil_u32_value_hashmap_erase_many);
     
     REGISTER_FUNC(recomputil_create_u32_memory_hashmap);
     REGISTER_FUNC(recomputil_destroy_u32_memory_hashmap);
@@ -700,6 +1467,7 @@ void recomputil::register_data_api_exports() {
     REGISTER_FUNC(recomputil_u32_memory_hashmap_get);
     REGISTER_FUNC(recomputil_u32_memory_hashmap_erase);
     REGISTER_FUNC(recomputil_u32_memory_hashmap_size);
+    REGISTER_FUNC(recomputil_u32_memory_hashmap_get_stats);
     
     REGISTER_FUNC(recomputil_create_u32_hashset);
     REGISTER_FUNC(recomputil_destroy_u32_hashset);
@@ -707,6 +1475,9 @@ void recomputil::register_data_api_exports() {
     REGISTER_FUNC(recomputil_u32_hashset_insert);
     REGISTER_FUNC(recomputil_u32_hashset_erase);
     REGISTER_FUNC(recomputil_u32_hashset_size);
+    REGISTER_FUNC(recomputil_u32_hashset_contains_many);
+    REGISTER_FUNC(recomputil_u32_hashset_insert_many);
+    REGISTER_FUNC(recomputil_u32_hashset_erase_many);
 
     REGISTER_FUNC(recomputil_create_u32_slotmap);
     REGISTER_FUNC(recomputil_destroy_u32_slotmap);
@@ -716,6 +1487,11 @@ void recomputil::register_data_api_exports() {
     REGISTER_FUNC(recomputil_u32_slotmap_set);
     REGISTER_FUNC(recomputil_u32_slotmap_erase);
     REGISTER_FUNC(recomputil_u32_slotmap_size);
+    REGISTER_FUNC(recomputil_u32_slotmap_contains_many);
+    REGISTER_FUNC(recomputil_u32_slotmap_create_many);
+    REGISTER_FUNC(recomputil_u32_slotmap_get_many);
+    REGISTER_FUNC(recomputil_u32_slotmap_set_many);
+    REGISTER_FUNC(recomputil_u32_slotmap_erase_many);
 
     REGISTER_FUNC(recomputil_create_memory_slotmap);
     REGISTER_FUNC(recomputil_destroy_memory_slotmap);
@@ -724,4 +1500,5 @@ void recomputil::register_data_api_exports() {
     REGISTER_FUNC(recomputil_memory_slotmap_get);
     REGISTER_FUNC(recomputil_memory_slotmap_erase);
     REGISTER_FUNC(recomputil_memory_slotmap_size);
+    REGISTER_FUNC(recomputil_memory_slotmap_get_stats);
 }
@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <fstream>
+#include <mutex>
+#include <optional>
+
+#include "recomp_profiler.h"
+#include "librecomp/helpers.hpp"
+#include "librecomp/overlays.hpp"
+
+namespace recomputil {
+    // Plenty for every export in the data and UI APIs plus the events.
+    constexpr size_t max_profile_counters = 1024;
+
+    struct ProfileCounterInfo {
+        std::string name;
+        ProfileCategory category;
+    };
+
+    struct ProfileFrameCounter {
+        std::atomic<uint32_t> calls;
+        std::atomic<uint64_t> ns;
+    };
+
+    struct ProfileFrameSample {
+        ProfileCounterId counter;
+        uint32_t calls;
+        uint64_t ns;
+    };
+
+    struct ProfileFrame {
+        uint64_t frame_number = 0;
+        // Only the counters that were called in the frame are stored.
+        std::vector<ProfileFrameSample> samples;
+    };
+
+    struct ProfilerState {
+        std::mutex counter_mutex;
+        std::vector<ProfileCounterInfo> counter_infos;
+        std::atomic<uint32_t> counter_count = 0;
+        std::array<ProfileFrameCounter, max_profile_counters> current_frame{};
+        std::atomic<bool> enabled = false;
+
+        std::mutex frames_mutex;
+        std::array<ProfileFrame, ProfilerFrameCount> frames{};
+        size_t next_frame = 0;
+        size_t stored_frames = 0;
+        uint64_t frame_number = 0;
+    };
+
+    static ProfilerState profiler{};
+}
+
+recomputil::ProfileCounterId recomputil::register_profile_counter(ProfileCategory category, const char* name) {
+    std::lock_guard lock{profiler.counter_mutex};
+    if (profiler.counter_infos.size() >= max_profile_counters) {
+        assert(false && "Too many profile counters");
+        return max_profile_counters - 1;
+    }
+
+    profiler.counter_infos.emplace_back(ProfileCounterInfo{ .name = name, .category = category });
+    profiler.counter_count.store(static_cast<uint32_t>(profiler.counter_infos.size()), std::memory_order_release);
+    return static_cast<ProfileCounterId>(profiler.counter_infos.size() - 1);
+}
+
+bool recomputil::is_profiling_enabled() {
+    return profiler.enabled.load(std::memory_order_relaxed);
+}
+
+void recomputil::set_profiling_enabled(bool enabled) {
+    bool was_enabled = profiler.enabled.exchange(enabled);
+
+    // Start a fresh capture every time profiling is turned on so frames from an older session don't skew the results.
+    if (enabled && !was_enabled) {
+        uint32_t counter_count = profiler.counter_count.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < counter_count; i++) {
+            profiler.current_frame[i].calls.store(0, std::memory_order_relaxed);
+            profiler.current_frame[i].ns.store(0, std::memory_order_relaxed);
+        }
+
+        std::lock_guard lock{profiler.frames_mutex};
+        for (ProfileFrame& frame : profiler.frames) {
+            frame.samples.clear();
+        }
+        profiler.next_frame = 0;
+        profiler.stored_frames = 0;
+    }
+}
+
+void recomputil::record_profile_sample(ProfileCounterId counter, uint64_t nanoseconds) {
+    ProfileFrameCounter& frame_counter = profiler.current_frame[counter];
+    frame_counter.calls.fetch_add(1, std::memory_order_relaxed);
+    frame_counter.ns.fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+void recomputil::end_profile_frame() {
+    if (!is_profiling_enabled()) {
+        return;
+    }
+
+    std::vector<ProfileFrameSample> samples;
+    uint32_t counter_count = profiler.counter_count.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < counter_count; i++) {
+        ProfileFrameCounter& frame_counter = profiler.current_frame[i];
+        uint32_t calls = frame_counter.calls.exchange(0, std::memory_order_relaxed);
+        uint64_t ns = frame_counter.ns.exchange(0, std::memory_order_relaxed);
+        if (calls != 0) {
+            samples.emplace_back(ProfileFrameSample{ .counter = i, .calls = calls, .ns = ns });
+        }
+    }
+
+    std::lock_guard lock{profiler.frames_mutex};
+    ProfileFrame& frame = profiler.frames[profiler.next_frame];
+    frame.frame_number = profiler.frame_number++;
+    frame.samples = std::move(samples);
+    profiler.next_frame = (profiler.next_frame + 1) % ProfilerFrameCount;
+    profiler.stored_frames = std::min(profiler.stored_frames + 1, ProfilerFrameCount);
+}
+
+const char* recomputil::get_profile_category_name(ProfileCategory category) {
+    switch (category) {
+        case ProfileCategory::DataApi:
+            return "Data API";
+        case ProfileCategory::UiApi:
+            return "UI API";
+        case ProfileCategory::UiCallback:
+            return "UI callback";
+        case ProfileCategory::Event:
+            return "Event";
+    }
+
+    return "Unknown";
+}
+
+std::vector<recomputil::ProfileSummary> recomputil::get_profile_summary() {
+    std::vector<ProfileSummary> summaries;
+    {
+        std::lock_guard lock{profiler.counter_mutex};
+        summaries.reserve(profiler.counter_infos.size());
+        for (const ProfileCounterInfo& info : profiler.counter_infos) {
+            summaries.emplace_back(ProfileSummary{ .name = info.name, .category = info.category });
+        }
+    }
+
+    {
+        std::lock_guard lock{profiler.frames_mutex};
+        for (size_t i = 0; i < profiler.stored_frames; i++) {
+            for (const ProfileFrameSample& sample : profiler.frames[i].samples) {
+                // Skip counters that were registered after the names were copied.
+                if (sample.counter >= summaries.size()) {
+                    continue;
+                }
+
+                ProfileSummary& summary = summaries[sample.counter];
+                summary.frame_count++;
+                summary.total_calls += sample.calls;
+                summary.total_ns += sample.ns;
+                summary.max_frame_calls = std::max<uint64_t>(summary.max_frame_calls, sample.calls);
+                summary.max_frame_ns = std::max(summary.max_frame_ns, sample.ns);
+            }
+        }
+    }
+
+    std::erase_if(summaries, [](const ProfileSummary& summary) { return summary.total_calls == 0; });
+    std::sort(summaries.begin(), summaries.end(),
+        [](const ProfileSummary& a, const ProfileSummary& b) { return a.total_ns > b.total_ns; });
+    return summaries;
+}
+
+bool recomputil::export_profile_csv(const std::filesystem::path& path) {
+    std::vector<ProfileCounterInfo> counter_infos;
+    {
+        std::lock_guard lock{profiler.counter_mutex};
+        counter_infos = profiler.counter_infos;
+    }
+
+    std::ofstream stream(path);
+    if (!stream.good()) {
+        return false;
+    }
+
+    stream << "frame,category,name,calls,ns\n";
+
+    std::lock_guard lock{profiler.frames_mutex};
+    // Start at the oldest frame in the ring buffer.
+    size_t first_frame = (profiler.next_frame + ProfilerFrameCount - profiler.stored_frames) % ProfilerFrameCount;
+    for (size_t i = 0; i < profiler.stored_frames; i++) {
+        const ProfileFrame& frame = profiler.frames[(first_frame + i) % ProfilerFrameCount];
+        for (const ProfileFrameSample& sample : frame.samples) {
+            if (sample.counter >= counter_infos.size()) {
+                continue;
+            }
+
+            const ProfileCounterInfo& info = counter_infos[sample.counter];
+            stream << frame.frame_number << ',' << get_profile_category_name(info.category) << ',' << info.name << ','
+                << sample.calls << ',' << sample.ns << '\n';
+        }
+    }
+
+    return stream.good();
+}
+
+// Mod events are dispatched by the runtime from inside the patches, so the patches mark the start and end of each
+// event instead. Must be kept in sync with RecompProfileEvent in patches/misc_funcs.h!
+static const char* profile_event_names[] = {
+    "recomp_on_init",
+};
+
+static constexpr size_t profile_event_count = sizeof(profile_event_names) / sizeof(profile_event_names[0]);
+static std::array<recomputil::ProfileCounterId, profile_event_count> profile_event_counters{};
+// Events don't nest in one another and each one is only dispatched from one thread, so there's one scope per event.
+static std::array<std::optional<recomputil::ProfileScope>, profile_event_count> profile_event_scopes{};
+
+extern "C" void recomp_profile_event_begin(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t event = _arg<0, uint32_t>(rdram, ctx);
+    if (event >= profile_event_count) {
+        return;
+    }
+
+    profile_event_scopes[event].emplace(profile_event_counters[event]);
+}
+
+extern "C" void recomp_profile_event_end(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t event = _arg<0, uint32_t>(rdram, ctx);
+    if (event >= profile_event_count) {
+        return;
+    }
+
+    profile_event_scopes[event].reset();
+}
+
+extern "C" void recomp_profile_end_frame(uint8_t* rdram, recomp_context* ctx) {
+    recomputil::end_profile_frame();
+}
+
+void recomputil::init_profiler() {
+    for (size_t i = 0; i < profile_event_count; i++) {
+        profile_event_counters[i] = register_profile_counter(ProfileCategory::Event, profile_event_names[i]);
+    }
+}
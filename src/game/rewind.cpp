@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "zelda_rewind.h"
+#include "zelda_snapshot.h"
+#include "zelda_lz.h"
+
+namespace zelda64 {
+    // Deltas captured by the game thread that the rewind thread still has to compress.
+    struct RewindJob {
+        uint64_t point_id = 0;
+        uint64_t generation = 0;
+        std::vector<uint32_t> pages;
+        std::vector<uint8_t> deltas;
+    };
+
+    // A compressed point in the ring. The page indices are stored first, followed by the compressed deltas.
+    struct RewindEntry {
+        uint64_t point_id;
+        size_t offset;
+        size_t size;
+        uint32_t page_count;
+    };
+
+    // Finished jobs are kept around so their buffers can be reused by the next captures.
+    constexpr size_t max_spare_rewind_jobs = 4;
+
+    struct RewindState {
+        std::mutex mutex;
+        std::condition_variable job_cv;
+        std::condition_variable idle_cv;
+        std::deque<RewindJob> jobs;
+        std::vector<RewindJob> spare_jobs;
+        std::thread worker;
+        bool worker_busy = false;
+        bool stop_requested = false;
+
+        std::unique_ptr<uint8_t[]> ring;
+        size_t budget = default_rewind_budget;
+        size_t ring_head = 0;
+        size_t bytes_used = 0;
+        std::deque<RewindEntry> entries;
+
+        uint32_t interval = default_rewind_interval;
+        bool history_started = false;
+        uint64_t latest_point = 0;
+        // Bumped when the history is cleared, so jobs that were captured before that are thrown away.
+        uint64_t generation = 0;
+    };
+
+    static RewindState rewind_state{};
+
+    static void recycle_rewind_job(RewindJob&& job) {
+        if (rewind_state.spare_jobs.size() < max_spare_rewind_jobs) {
+            job.pages.clear();
+            job.deltas.clear();
+            rewind_state.spare_jobs.emplace_back(std::move(job));
+        }
+    }
+
+    static void pop_newest_rewind_entry() {
+        rewind_state.bytes_used -= rewind_state.entries.back().size;
+        rewind_state.entries.pop_back();
+        rewind_state.ring_head = rewind_state.entries.empty() ? 0 : (rewind_state.entries.back().offset + rewind_state.entries.back().size);
+    }
+
+    static void pop_oldest_rewind_entry() {
+        rewind_state.bytes_used -= rewind_state.entries.front().size;
+        rewind_state.entries.pop_front();
+    }
+
+    // Copies a compressed point into the ring, dropping the oldest points that are in the way.
+    static void store_rewind_entry(uint64_t point_id, const std::vector<uint32_t>& pages, const std::vector<uint8_t>& compressed) {
+        size_t pages_size = pages.size() * sizeof(uint32_t);
+        size_t size = pages_size + compressed.size();
+
+        // Every point depends on the one after it, so a point that doesn't fit at all cuts off the whole history before it.
+        if (size > rewind_state.budget) {
+            rewind_state.entries.clear();
+            rewind_state.ring_head = 0;
+            rewind_state.bytes_used = 0;
+            return;
+        }
+
+        if (rewind_state.ring == nullptr) {
+            rewind_state.ring = std::make_unique<uint8_t[]>(rewind_state.budget);
+        }
+
+        size_t offset = rewind_state.ring_head;
+        if (offset + size > rewind_state.budget) {
+            // The space left at the end is too small, so everything stored there goes and the point starts over at the
+            // beginning of the ring.
+            while (!rewind_state.entries.empty() && rewind_state.entries.front().offset >= offset) {
+                pop_oldest_rewind_entry();
+            }
+            offset = 0;
+        }
+
+        while (!rewind_state.entries.empty()) {
+            const RewindEntry& oldest = rewind_state.entries.front();
+            if (oldest.offset >= offset + size || oldest.offset + oldest.size <= offset) {
+                break;
+            }
+            pop_oldest_rewind_entry();
+        }
+
+        std::memcpy(rewind_state.ring.get() + offset, pages.data(), pages_size);
+        std::memcpy(rewind_state.ring.get() + offset + pages_size, compressed.data(), compressed.size());
+        rewind_state.entries.emplace_back(RewindEntry{ .point_id = point_id, .offset = offset, .size = size, .page_count = uint32_t(pages.size()) });
+        rewind_state.ring_head = offset + size;
+        rewind_state.bytes_used += size;
+    }
+
+    static void rewind_thread_func() {
+        std::vector<uint8_t> compressed;
+        std::unique_lock lock{rewind_state.mutex};
+        while (true) {
+            rewind_state.job_cv.wait(lock, []() { return rewind_state.stop_requested || !rewind_state.jobs.empty(); });
+            if (rewind_state.stop_requested) {
+                return;
+            }
+
+            RewindJob job = std::move(rewind_state.jobs.front());
+            rewind_state.jobs.pop_front();
+            rewind_state.worker_busy = true;
+            lock.unlock();
+
+            compressed.clear();
+            lz_compress(job.deltas, compressed);
+
+            lock.lock();
+            if (job.generation == rewind_state.generation) {
+                store_rewind_entry(job.point_id, job.pages, compressed);
+            }
+            recycle_rewind_job(std::move(job));
+            rewind_state.worker_busy = false;
+            if (rewind_state.jobs.empty()) {
+                rewind_state.idle_cv.notify_all();
+            }
+        }
+    }
+}
+
+void zelda64::set_rewind_budget(size_t bytes) {
+    std::unique_lock lock{rewind_state.mutex};
+    rewind_state.idle_cv.wait(lock, []() { return !rewind_state.worker_busy; });
+    rewind_state.budget = bytes;
+    rewind_state.ring.reset();
+    rewind_state.entries.clear();
+    rewind_state.ring_head = 0;
+    rewind_state.bytes_used = 0;
+}
+
+size_t zelda64::get_rewind_budget() {
+    std::lock_guard lock{rewind_state.mutex};
+    return rewind_state.budget;
+}
+
+void zelda64::set_rewind_interval(uint32_t vis) {
+    std::lock_guard lock{rewind_state.mutex};
+    rewind_state.interval = std::max<uint32_t>(vis, 1);
+}
+
+uint32_t zelda64::get_rewind_interval() {
+    std::lock_guard lock{rewind_state.mutex};
+    return rewind_state.interval;
+}
+
+uint64_t zelda64::capture_rewind_point(uint8_t* rdram) {
+    RewindJob job;
+    {
+        std::lock_guard lock{rewind_state.mutex};
+        if (!rewind_state.spare_jobs.empty()) {
+            job = std::move(rewind_state.spare_jobs.back());
+            rewind_state.spare_jobs.pop_back();
+        }
+    }
+
+    // This is the only part of a capture the game pays for.
+    capture_rdram_snapshot_delta(rdram, job.pages, job.deltas);
+
+    std::lock_guard lock{rewind_state.mutex};
+    if (!rewind_state.worker.joinable()) {
+        rewind_state.stop_requested = false;
+        rewind_state.worker = std::thread{rewind_thread_func};
+    }
+
+    // The first point of a history is the snapshot itself, so its deltas aren't needed.
+    if (!rewind_state.history_started) {
+        rewind_state.history_started = true;
+        rewind_state.latest_point = 0;
+        recycle_rewind_job(std::move(job));
+        return 0;
+    }
+
+    job.point_id = ++rewind_state.latest_point;
+    job.generation = rewind_state.generation;
+    rewind_state.jobs.emplace_back(std::move(job));
+    rewind_state.job_cv.notify_one();
+    return rewind_state.latest_point;
+}
+
+bool zelda64::rewind_rdram(uint8_t* rdram, size_t steps, uint64_t& point_id) {
+    std::unique_lock lock{rewind_state.mutex};
+    // Every point has to be in the ring before the history can be walked.
+    rewind_state.idle_cv.wait(lock, []() { return rewind_state.jobs.empty() && !rewind_state.worker_busy; });
+
+    if (!rewind_state.history_started || steps > rewind_state.entries.size()) {
+        return false;
+    }
+
+    // The points that are stepped over have to be the latest ones, with none missing in between.
+    for (size_t i = 0; i < steps; i++) {
+        if (rewind_state.entries[rewind_state.entries.size() - 1 - i].point_id != rewind_state.latest_point - i) {
+            return false;
+        }
+    }
+
+    size_t page_size = get_rdram_snapshot_page_size();
+    std::vector<uint8_t> deltas;
+    for (size_t i = 0; i < steps; i++) {
+        const RewindEntry& entry = rewind_state.entries.back();
+        const uint8_t* payload = rewind_state.ring.get() + entry.offset;
+        size_t pages_size = entry.page_count * sizeof(uint32_t);
+        std::vector<uint32_t> pages(entry.page_count);
+        std::memcpy(pages.data(), payload, pages_size);
+
+        deltas.resize(size_t(entry.page_count) * page_size);
+        bool decompressed = lz_decompress({ payload + pages_size, entry.size - pages_size }, deltas);
+        assert(decompressed && "Corrupt rewind point");
+        if (!decompressed) {
+            // Nothing before this point can be reached anymore.
+            rewind_state.entries.clear();
+            rewind_state.ring_head = 0;
+            rewind_state.bytes_used = 0;
+            break;
+        }
+
+        for (size_t page = 0; page < pages.size(); page++) {
+            apply_rdram_snapshot_delta(rdram, pages[page], deltas.data() + page * page_size);
+        }
+
+        pop_newest_rewind_entry();
+        rewind_state.latest_point--;
+    }
+
+    restore_rdram_snapshot(rdram);
+    point_id = rewind_state.latest_point;
+    return true;
+}
+
+zelda64::RewindStats zelda64::get_rewind_stats() {
+    std::lock_guard lock{rewind_state.mutex};
+    return RewindStats{
+        .points = rewind_state.history_started ? rewind_state.entries.size() + 1 : 0,
+        .bytes_used = rewind_state.bytes_used,
+        .pending = rewind_state.jobs.size() + (rewind_state.worker_busy ? 1 : 0),
+    };
+}
+
+void zelda64::clear_rewind_history() {
+    std::lock_guard lock{rewind_state.mutex};
+    rewind_state.generation++;
+    while (!rewind_state.jobs.empty()) {
+        recycle_rewind_job(std::move(rewind_state.jobs.front()));
+        rewind_state.jobs.pop_front();
+    }
+    rewind_state.entries.clear();
+    rewind_state.ring_head = 0;
+    rewind_state.bytes_used = 0;
+    rewind_state.history_started = false;
+    rewind_state.latest_point = 0;
+}
+
+void zelda64::shutdown_rewind() {
+    {
+        std::lock_guard lock{rewind_state.mutex};
+        rewind_state.stop_requested = true;
+        rewind_state.job_cv.notify_all();
+    }
+
+    if (rewind_state.worker.joinable()) {
+        rewind_state.worker.join();
+    }
+}
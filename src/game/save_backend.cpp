@@ -0,0 +1,203 @@
+#include <array>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "zelda_save.h"
+#include "zelda_config.h"
+#include "librecomp/helpers.hpp"
+
+namespace zelda64 {
+    using SaveBlocks = std::array<uint64_t, eeprom_block_count>;
+
+    struct SaveBackendState {
+        std::mutex mutex;
+        std::condition_variable flush_cv;
+        std::thread thread;
+        // The save as of the last call to write_save_data, one EEPROM block per element.
+        SaveBlocks shadow{};
+        bool shadow_valid = false;
+        // Blocks that changed since the save was last written out.
+        uint64_t pending_blocks = 0;
+        std::chrono::steady_clock::time_point flush_deadline{};
+        bool stop_requested = false;
+    };
+
+    static SaveBackendState save_state{};
+
+    static std::filesystem::path get_save_path() {
+        return zelda64::get_app_folder_path() / "saves" / "sf64.eep";
+    }
+
+    static std::filesystem::path get_save_backup_path(const std::filesystem::path& path, size_t index) {
+        std::filesystem::path backup_path = path;
+        backup_path += ".bak" + std::to_string(index);
+        return backup_path;
+    }
+
+    static bool read_save_from(const std::filesystem::path& path, SaveBlocks& blocks) {
+        std::ifstream input{ path, std::ios::binary };
+        if (!input.good()) {
+            return false;
+        }
+
+        input.read(reinterpret_cast<char*>(blocks.data()), eeprom_save_size);
+        // A save of any other size is damaged, e.g. by being cut off.
+        return input.gcount() == eeprom_save_size && input.peek() == std::ifstream::traits_type::eof();
+    }
+
+    static bool write_save_to_disk(const SaveBlocks& blocks) {
+        std::filesystem::path path = get_save_path();
+        std::filesystem::path temp_path = path;
+        temp_path += ".tmp";
+        std::error_code ec;
+
+        std::filesystem::create_directories(path.parent_path(), ec);
+
+        {
+            std::ofstream output{ temp_path, std::ios::binary };
+            output.write(reinterpret_cast<const char*>(blocks.data()), eeprom_save_size);
+            if (!output.good()) {
+                return false;
+            }
+        }
+
+        // Shift the backups down by one and turn the current save into the newest one. It's copied rather than renamed
+        // so there's always a save at the main path.
+        if (std::filesystem::exists(path, ec)) {
+            for (size_t i = save_backup_count; i > 1; i--) {
+                std::filesystem::path older = get_save_backup_path(path, i - 1);
+                if (std::filesystem::exists(older, ec)) {
+                    std::filesystem::rename(older, get_save_backup_path(path, i), ec);
+                }
+            }
+            std::filesystem::copy_file(path, get_save_backup_path(path, 1), std::filesystem::copy_options::overwrite_existing, ec);
+        }
+
+        // Replacing the file through a rename means it's never left half written.
+        std::filesystem::rename(temp_path, path, ec);
+        return !ec;
+    }
+
+    static void save_thread_func() {
+        std::unique_lock lock{save_state.mutex};
+        while (true) {
+            save_state.flush_cv.wait(lock, []() { return save_state.stop_requested || save_state.pending_blocks != 0; });
+            if (save_state.pending_blocks == 0) {
+                return;
+            }
+
+            // Wait for the game to stop saving. Every new write pushes the deadline back.
+            while (!save_state.stop_requested && std::chrono::steady_clock::now() < save_state.flush_deadline) {
+                save_state.flush_cv.wait_until(lock, save_state.flush_deadline);
+            }
+
+            SaveBlocks blocks = save_state.shadow;
+            save_state.pending_blocks = 0;
+            lock.unlock();
+
+            if (!write_save_to_disk(blocks)) {
+                fprintf(stderr, "Failed to write save file to %s\n", get_save_path().string().c_str());
+            }
+
+            lock.lock();
+        }
+    }
+}
+
+bool zelda64::read_save_data(std::span<uint8_t, eeprom_save_size> data) {
+    std::filesystem::path path = get_save_path();
+    SaveBlocks blocks;
+    bool found = read_save_from(path, blocks);
+    for (size_t i = 1; !found && i <= save_backup_count; i++) {
+        found = read_save_from(get_save_backup_path(path, i), blocks);
+        if (found) {
+            printf("Save file is missing or damaged, loaded backup %zu instead\n", i);
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    std::lock_guard lock{save_state.mutex};
+    save_state.shadow = blocks;
+    save_state.shadow_valid = true;
+    std::memcpy(data.data(), blocks.data(), eeprom_save_size);
+    return true;
+}
+
+bool zelda64::write_save_data(std::span<const uint8_t, eeprom_save_size> data) {
+    SaveBlocks blocks;
+    std::memcpy(blocks.data(), data.data(), eeprom_save_size);
+
+    std::lock_guard lock{save_state.mutex};
+
+    // Every block is exactly one 64-bit word, so this is a plain word compare that the compiler vectorizes.
+    uint64_t changed_blocks = 0;
+    for (size_t i = 0; i < eeprom_block_count; i++) {
+        changed_blocks |= uint64_t(blocks[i] != save_state.shadow[i]) << i;
+    }
+
+    // Without a save on disk to compare against, the whole save has to be written out.
+    if (!save_state.shadow_valid) {
+        changed_blocks = ~uint64_t(0) >> (64 - eeprom_block_count);
+        save_state.shadow_valid = true;
+    }
+
+    if (changed_blocks == 0) {
+        return false;
+    }
+
+    save_state.shadow = blocks;
+    save_state.pending_blocks |= changed_blocks;
+    save_state.flush_deadline = std::chrono::steady_clock::now() + save_flush_delay;
+    if (!save_state.thread.joinable()) {
+        save_state.stop_requested = false;
+        save_state.thread = std::thread{save_thread_func};
+    }
+    save_state.flush_cv.notify_one();
+    return true;
+}
+
+void zelda64::shutdown_save_backend() {
+    {
+        std::lock_guard lock{save_state.mutex};
+        save_state.stop_requested = true;
+        save_state.flush_cv.notify_one();
+    }
+
+    // The thread writes out anything that's still pending before it stops.
+    if (save_state.thread.joinable()) {
+        save_state.thread.join();
+    }
+}
+
+extern "C" void recomp_read_save_file(uint8_t* rdram, recomp_context* ctx) {
+    PTR(void) save = _arg<0, PTR(void)>(rdram, ctx);
+
+    std::array<uint8_t, zelda64::eeprom_save_size> data;
+    if (!zelda64::read_save_data(data)) {
+        _return(ctx, s32{0});
+        return;
+    }
+
+    for (size_t i = 0; i < data.size(); i++) {
+        MEM_B(i, (gpr)save) = data[i];
+    }
+    _return(ctx, s32{1});
+}
+
+extern "C" void recomp_write_save_file(uint8_t* rdram, recomp_context* ctx) {
+    PTR(void) save = _arg<0, PTR(void)>(rdram, ctx);
+
+    // Gather the save in the EEPROM's byte order, which is also the order it's stored in on disk.
+    std::array<uint8_t, zelda64::eeprom_save_size> data;
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = MEM_B(i, (gpr)save);
+    }
+    zelda64::write_save_data(data);
+}
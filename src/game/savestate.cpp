@@ -0,0 +1,385 @@
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "zelda_savestate.h"
+#include "zelda_lz.h"
+#include "ultramodern/ultramodern.hpp"
+#include "librecomp/files.hpp"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace zelda64 {
+    constexpr char savestate_magic[8] = { 'S', 'F', '6', '4', 'S', 'T', 'A', 'T' };
+    constexpr size_t savestate_chunk_count = ultramodern::rdram_size / savestate_chunk_size;
+    static_assert(ultramodern::rdram_size % savestate_chunk_size == 0, "RDRAM must be made of whole chunks");
+
+    struct SavestateJob {
+        std::filesystem::path path;
+        uint64_t rom_hash;
+        std::unique_ptr<uint8_t[]> rdram;
+        std::vector<SavestateThread> threads;
+    };
+
+    struct SavestateState {
+        std::mutex mutex;
+        std::condition_variable job_cv;
+        std::condition_variable idle_cv;
+        std::deque<SavestateJob> jobs;
+        std::thread worker;
+        bool worker_busy = false;
+        bool stop_requested = false;
+        bool write_failed = false;
+        // Kept from the last write, so saving doesn't have to fault in a fresh copy of RDRAM every time.
+        std::unique_ptr<uint8_t[]> spare_rdram;
+    };
+
+    static SavestateState savestate_state{};
+
+    // FNV-1a over whole words, which is fast enough to check every chunk of RDRAM when loading.
+    static uint64_t savestate_checksum(const uint8_t* data, size_t size) {
+        uint64_t hash = 0xCBF29CE484222325ULL;
+        for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            hash = (hash ^ word) * 0x100000001B3ULL;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    static void write_value(std::ofstream& stream, const T& value) {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    static bool write_savestate(const SavestateJob& job) {
+        std::vector<SavestateChunk> chunks(savestate_chunk_count);
+        std::vector<uint8_t> chunk_data;
+        chunk_data.reserve(ultramodern::rdram_size / 4);
+
+        size_t data_start = sizeof(SavestateHeader) + chunks.size() * sizeof(SavestateChunk);
+        for (const SavestateThread& thread : job.threads) {
+            data_start += sizeof(int32_t) + sizeof(uint32_t) + thread.context.size();
+        }
+
+        for (size_t i = 0; i < chunks.size(); i++) {
+            const uint8_t* chunk = job.rdram.get() + i * savestate_chunk_size;
+            size_t start = chunk_data.size();
+            lz_compress({ chunk, savestate_chunk_size }, chunk_data);
+
+            // Store chunks that didn't get any smaller as they are, which also keeps the chunk data from growing too much.
+            if (chunk_data.size() - start >= savestate_chunk_size) {
+                chunk_data.resize(start);
+                chunk_data.insert(chunk_data.end(), chunk, chunk + savestate_chunk_size);
+            }
+
+            chunks[i] = SavestateChunk{
+                .offset = data_start + start,
+                .compressed_size = uint32_t(chunk_data.size() - start),
+                .reserved = 0,
+                .checksum = savestate_checksum(chunk, savestate_chunk_size),
+            };
+        }
+
+        {
+            std::ofstream output = recomp::open_output_file_with_backup(job.path);
+            if (!output.good()) {
+                return false;
+            }
+
+            SavestateHeader header{
+                .magic = {},
+                .version = savestate_version,
+                .thread_count = uint32_t(job.threads.size()),
+                .rom_hash = job.rom_hash,
+                .rdram_size = uint32_t(ultramodern::rdram_size),
+                .chunk_size = uint32_t(savestate_chunk_size),
+            };
+            std::memcpy(header.magic, savestate_magic, sizeof(header.magic));
+            write_value(output, header);
+
+            for (const SavestateThread& thread : job.threads) {
+                write_value(output, thread.thread_id);
+                write_value(output, uint32_t(thread.context.size()));
+                output.write(reinterpret_cast<const char*>(thread.context.data()), thread.context.size());
+            }
+
+            output.write(reinterpret_cast<const char*>(chunks.data()), chunks.size() * sizeof(SavestateChunk));
+            output.write(reinterpret_cast<const char*>(chunk_data.data()), chunk_data.size());
+            if (!output.good()) {
+                return false;
+            }
+        }
+
+        return recomp::finalize_output_file_with_backup(job.path);
+    }
+
+    static void savestate_thread_func() {
+        // Fault in the first copy of RDRAM ahead of time, so the first save doesn't pay for it on the game thread.
+        auto first_copy = std::make_unique_for_overwrite<uint8_t[]>(ultramodern::rdram_size);
+        std::memset(first_copy.get(), 0, ultramodern::rdram_size);
+
+        std::unique_lock lock{savestate_state.mutex};
+        if (savestate_state.spare_rdram == nullptr) {
+            savestate_state.spare_rdram = std::move(first_copy);
+        }
+
+        while (true) {
+            savestate_state.job_cv.wait(lock, []() { return savestate_state.stop_requested || !savestate_state.jobs.empty(); });
+            // Queued states are still written when stopping, since the player expects them to be there next time.
+            if (savestate_state.jobs.empty()) {
+                return;
+            }
+
+            SavestateJob job = std::move(savestate_state.jobs.front());
+            savestate_state.jobs.pop_front();
+            savestate_state.worker_busy = true;
+            lock.unlock();
+
+            bool written = write_savestate(job);
+            if (!written) {
+                fprintf(stderr, "Failed to write savestate to %s\n", job.path.string().c_str());
+            }
+
+            lock.lock();
+            savestate_state.write_failed |= !written;
+            savestate_state.spare_rdram = std::move(job.rdram);
+            savestate_state.worker_busy = false;
+            if (savestate_state.jobs.empty()) {
+                savestate_state.idle_cv.notify_all();
+            }
+        }
+    }
+
+    static void start_savestate_thread() {
+        if (!savestate_state.worker.joinable()) {
+            savestate_state.stop_requested = false;
+            savestate_state.worker = std::thread{savestate_thread_func};
+        }
+    }
+
+    // Read-only view of a whole file.
+    struct MappedFile {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+#if defined(_WIN32)
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+
+        bool open(const std::filesystem::path& path) {
+            file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) {
+                return false;
+            }
+
+            LARGE_INTEGER file_size;
+            if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+                return false;
+            }
+
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping == nullptr) {
+                return false;
+            }
+
+            data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            size = size_t(file_size.QuadPart);
+            return data != nullptr;
+        }
+
+        ~MappedFile() {
+            if (data != nullptr) {
+                UnmapViewOfFile(data);
+            }
+            if (mapping != nullptr) {
+                CloseHandle(mapping);
+            }
+            if (file != INVALID_HANDLE_VALUE) {
+                CloseHandle(file);
+            }
+        }
+#else
+        bool open(const std::filesystem::path& path) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd == -1) {
+                return false;
+            }
+
+            // The mapping stays valid after the file is closed.
+            struct stat file_stat;
+            if (fstat(fd, &file_stat) == 0 && file_stat.st_size != 0) {
+                void* mapped = mmap(nullptr, size_t(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped != MAP_FAILED) {
+                    data = static_cast<const uint8_t*>(mapped);
+                    size = size_t(file_stat.st_size);
+                }
+            }
+
+            close(fd);
+            return data != nullptr;
+        }
+
+        ~MappedFile() {
+            if (data != nullptr) {
+                munmap(const_cast<uint8_t*>(data), size);
+            }
+        }
+#endif
+    };
+}
+
+void zelda64::init_savestates() {
+    std::lock_guard lock{savestate_state.mutex};
+    start_savestate_thread();
+}
+
+void zelda64::queue_savestate_write(const std::filesystem::path& path, uint64_t rom_hash, const uint8_t* rdram, std::vector<SavestateThread>&& threads) {
+    std::unique_ptr<uint8_t[]> rdram_copy;
+    {
+        std::lock_guard lock{savestate_state.mutex};
+        rdram_copy = std::move(savestate_state.spare_rdram);
+    }
+
+    // A previous write may still be using the spare copy, in which case a new one is needed.
+    if (rdram_copy == nullptr) {
+        rdram_copy = std::make_unique_for_overwrite<uint8_t[]>(ultramodern::rdram_size);
+    }
+    std::memcpy(rdram_copy.get(), rdram, ultramodern::rdram_size);
+
+    std::lock_guard lock{savestate_state.mutex};
+    start_savestate_thread();
+    savestate_state.jobs.emplace_back(SavestateJob{
+        .path = path,
+        .rom_hash = rom_hash,
+        .rdram = std::move(rdram_copy),
+        .threads = std::move(threads),
+    });
+    savestate_state.job_cv.notify_one();
+}
+
+bool zelda64::is_savestate_write_pending() {
+    std::lock_guard lock{savestate_state.mutex};
+    return !savestate_state.jobs.empty() || savestate_state.worker_busy;
+}
+
+bool zelda64::wait_for_savestate_writes() {
+    std::unique_lock lock{savestate_state.mutex};
+    savestate_state.idle_cv.wait(lock, []() { return savestate_state.jobs.empty() && !savestate_state.worker_busy; });
+    bool succeeded = !savestate_state.write_failed;
+    savestate_state.write_failed = false;
+    return succeeded;
+}
+
+zelda64::SavestateError zelda64::load_savestate(const std::filesystem::path& path, uint64_t rom_hash, size_t context_size, uint8_t* rdram, std::vector<SavestateThread>& threads) {
+    // Make sure a state that was just saved to the same path is the one that gets loaded.
+    wait_for_savestate_writes();
+
+    MappedFile file{};
+    if (!file.open(path)) {
+        return SavestateError::FailedToOpen;
+    }
+
+    SavestateHeader header;
+    if (file.size < sizeof(header)) {
+        return SavestateError::NotASavestate;
+    }
+    std::memcpy(&header, file.data, sizeof(header));
+
+    if (std::memcmp(header.magic, savestate_magic, sizeof(header.magic)) != 0) {
+        return SavestateError::NotASavestate;
+    }
+    if (header.version != savestate_version) {
+        return SavestateError::WrongVersion;
+    }
+    if (header.rom_hash != rom_hash) {
+        return SavestateError::WrongRom;
+    }
+    if (header.rdram_size != ultramodern::rdram_size || header.chunk_size != savestate_chunk_size) {
+        return SavestateError::Corrupt;
+    }
+
+    size_t offset = sizeof(header);
+    std::vector<SavestateThread> loaded_threads(header.thread_count);
+    for (SavestateThread& thread : loaded_threads) {
+        uint32_t stored_size;
+        if (file.size - offset < sizeof(thread.thread_id) + sizeof(stored_size)) {
+            return SavestateError::Corrupt;
+        }
+        std::memcpy(&thread.thread_id, file.data + offset, sizeof(thread.thread_id));
+        std::memcpy(&stored_size, file.data + offset + sizeof(thread.thread_id), sizeof(stored_size));
+        offset += sizeof(thread.thread_id) + sizeof(stored_size);
+
+        if (stored_size != context_size || file.size - offset < stored_size) {
+            return SavestateError::Corrupt;
+        }
+        thread.context.assign(file.data + offset, file.data + offset + stored_size);
+        offset += stored_size;
+    }
+
+    std::vector<SavestateChunk> chunks(savestate_chunk_count);
+    if (file.size - offset < chunks.size() * sizeof(SavestateChunk)) {
+        return SavestateError::Corrupt;
+    }
+    std::memcpy(chunks.data(), file.data + offset, chunks.size() * sizeof(SavestateChunk));
+
+    // Only the chunks that differ from what's in RDRAM are decompressed. They're staged until every one of them has been
+    // checked, so a corrupt file leaves RDRAM alone.
+    std::vector<uint32_t> changed_chunks;
+    std::vector<uint8_t> staged;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        const SavestateChunk& chunk = chunks[i];
+        if (savestate_checksum(rdram + i * savestate_chunk_size, savestate_chunk_size) == chunk.checksum) {
+            continue;
+        }
+
+        if (chunk.offset > file.size || file.size - chunk.offset < chunk.compressed_size || chunk.compressed_size > savestate_chunk_size) {
+            return SavestateError::Corrupt;
+        }
+
+        std::span<const uint8_t> input{ file.data + chunk.offset, chunk.compressed_size };
+        size_t start = staged.size();
+        staged.resize(start + savestate_chunk_size);
+        std::span<uint8_t> output{ staged.data() + start, savestate_chunk_size };
+        if (chunk.compressed_size == savestate_chunk_size) {
+            std::memcpy(output.data(), input.data(), savestate_chunk_size);
+        }
+        else if (!lz_decompress(input, output)) {
+            return SavestateError::Corrupt;
+        }
+
+        if (savestate_checksum(output.data(), savestate_chunk_size) != chunk.checksum) {
+            return SavestateError::Corrupt;
+        }
+        changed_chunks.push_back(uint32_t(i));
+    }
+
+    for (size_t i = 0; i < changed_chunks.size(); i++) {
+        std::memcpy(rdram + size_t(changed_chunks[i]) * savestate_chunk_size, staged.data() + i * savestate_chunk_size, savestate_chunk_size);
+    }
+
+    threads = std::move(loaded_threads);
+    return SavestateError::Success;
+}
+
+void zelda64::shutdown_savestates() {
+    {
+        std::lock_guard lock{savestate_state.mutex};
+        savestate_state.stop_requested = true;
+        savestate_state.job_cv.notify_all();
+    }
+
+    if (savestate_state.worker.joinable()) {
+        savestate_state.worker.join();
+    }
+}
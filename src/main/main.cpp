@@ -35,6 +35,11 @@
 #include "zelda_support.h"
 #include "zelda_game.h"
 #include "recomp_data.h"
+#include "recomp_profiler.h"
+#include "zelda_replay.h"
+#include "zelda_rewind.h"
+#include "zelda_savestate.h"
+#include "zelda_save.h"
 #include "ovl_patches.hpp"
 #include "librecomp/game.hpp"
 #include "librecomp/mods.hpp"
@@ -350,7 +355,7 @@ gpr get_entrypoint_address();
 // array of supported GameEntry objects
 std::vector<recomp::GameEntry> supported_games = {
     {
-        .rom_hash = 0x163fd3fc3813f54eULL,
+        .rom_hash = zelda64::rom_hash,
         .internal_name = "STARFOX64",
         .game_id = u8"sf64.n64.us.1.1",
         .mod_game_id = "sf64",
@@ -569,8 +574,6 @@ void reorder_texture_pack(recomp::mods::ModContext&) {
 #define REGISTER_FUNC(name) recomp::overlays::register_base_export(#name, name)
 
 int main(int argc, char** argv) {
-    (void)argc;
-    (void)argv;
     recomp::Version project_version{};
     if (!recomp::Version::from_string(version_string, project_version)) {
         ultramodern::error_handling::message_box(("Invalid version string: " + version_string).c_str());
@@ -635,6 +638,28 @@ int main(int argc, char** argv) {
 
     recomp::register_config_path(zelda64::get_app_folder_path());
 
+    // Profiling mods from the start is the only way to time recomp_on_init, which runs before the debug menu can turn
+    // profiling on.
+    for (int i = 1; i < argc; i++) {
+        if (std::string_view{argv[i]} == "--profile-mods") {
+            recomputil::set_profiling_enabled(true);
+        }
+    }
+
+    // Process the input recording arguments. Both have to be set up before the game boots so that the recording
+    // starts from the same state every time.
+    for (int i = 1; i + 1 < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--record-inputs" || arg == "--replay-inputs") {
+            std::filesystem::path path = std::filesystem::path(std::u8string_view(reinterpret_cast<const char8_t*>(argv[++i])));
+            bool started = (arg == "--record-inputs") ? zelda64::start_input_recording(path) : zelda64::start_input_replay(path);
+            if (!started) {
+                ultramodern::error_handling::message_box(("Failed to open input recording: " + path.string()).c_str());
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
     // Register supported games and patches
     for (const auto& game : supported_games) {
         recomp::register_game(game);
@@ -656,12 +681,13 @@ int main(int argc, char** argv) {
     REGISTER_FUNC(recomp_get_mouse_deltas);
     REGISTER_FUNC(recomp_get_inverted_axes);
     REGISTER_FUNC(recomp_get_analog_inverted_axes);
+    recomputil::init_profiler();
     recompui::register_ui_exports();
     recomputil::register_data_api_exports();
 
     zelda64::register_overlays();
     zelda64::register_patches();
-    // recomputil::init_extended_actor_data();
+    recomputil::init_extended_actor_data();
     zelda64::load_config();
 
     recomp::rsp::callbacks_t rsp_callbacks{
@@ -716,6 +742,7 @@ int main(int argc, char** argv) {
 
     // Register the .rtz texture pack file format with the previous content type as its only allowed content type.
     recomp::mods::register_mod_container_type("rtz", std::vector{ texture_pack_content_type_id }, false);
+    recompui::register_mod_index_container_type("rtz");
 
     recomp::start(
         project_version,
@@ -730,6 +757,11 @@ int main(int argc, char** argv) {
         threads_callbacks
     );
 
+    zelda64::finish_input_recording();
+    zelda64::shutdown_rewind();
+    zelda64::shutdown_savestates();
+    zelda64::shutdown_save_backend();
+
     NFD_Quit();
 
     if (preloaded) {
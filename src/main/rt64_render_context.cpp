@@ -12,6 +12,7 @@
 #include "ultramodern/config.hpp"
 
 #include "zelda_render.h"
+#include "zelda_latency.h"
 #include "recomp_ui.h"
 #include "concurrentqueue.h"
 
@@ -321,6 +322,7 @@ zelda64::renderer::RT64Context::RT64Context(uint8_t* rdram, ultramodern::rendere
 zelda64::renderer::RT64Context::~RT64Context() = default;
 
 void zelda64::renderer::RT64Context::send_dl(const OSTask* task) {
+    zelda64::mark_latency_stage(zelda64::LatencyStage::Submit);
     check_texture_pack_actions();
     app->state->rsp->reset();
     app->interpreter->loadUCodeGBI(task->t.ucode & 0x3FFFFFF, task->t.ucode_data & 0x3FFFFFF, true);
@@ -329,6 +331,7 @@ void zelda64::renderer::RT64Context::send_dl(const OSTask* task) {
 
 void zelda64::renderer::RT64Context::update_screen() {
     app->updateScreen();
+    zelda64::mark_latency_stage(zelda64::LatencyStage::Present);
 }
 
 void zelda64::renderer::RT64Context::shutdown() {
@@ -1,3 +1,4 @@
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -38,8 +39,11 @@ namespace recompui {
         std::vector<Element*> loose_elements;
         std::unordered_set<ResourceId> to_update;
         std::vector<std::tuple<Element*, ResourceId, std::string>> to_set_text;     
+        std::vector<StyleCommand> style_commands;
         bool captures_input = true;
         bool captures_mouse = true;
+        // Whether the UI thread is drawing this context. Style commands are only buffered for shown contexts.
+        std::atomic<bool> shown = false;
         Context(Rml::ElementDocument* document) : document(document), root_element(document) {}
     };
 } // namespace recompui
@@ -70,6 +74,8 @@ enum class ContextErrorType {
     UpdateElementInWrongContext,
     SetTextElementWithoutContext,
     SetTextElementInWrongContext,
+    StyleCommandWithoutContext,
+    StyleCommandInWrongContext,
     GetResourceWithoutOpen,
     GetResourceFailed,
     DestroyResourceWithoutOpen,
@@ -128,6 +134,12 @@ void context_error(recompui::ContextId id, ContextErrorType type) {
         case ContextErrorType::SetTextElementInWrongContext:
             error_message = "Attempted to set the text of a UI element in a different UI context than the one that's open";
             break;
+        case ContextErrorType::StyleCommandWithoutContext:
+            error_message = "Attempted to style a UI resource with no open UI context";
+            break;
+        case ContextErrorType::StyleCommandInWrongContext:
+            error_message = "Attempted to style a UI resource in a different UI context than the one that's open";
+            break;
         case ContextErrorType::GetResourceWithoutOpen:
             error_message = "Attempted to get a UI resource with no open UI context";
             break;
@@ -377,6 +389,24 @@ recompui::ContextId recompui::try_close_current_context() {
     return ContextId::null();
 }
 
+static void apply_style_command(recompui::Context* ctx, const recompui::StyleCommand& command) {
+    resource_slotmap::key cur_key{ command.resource.slot_id };
+    std::unique_ptr<recompui::Style>* cur_resource = ctx->resources.get(cur_key);
+
+    // The resource may have been destroyed after the command was queued, so skip it if so.
+    if (cur_resource == nullptr) {
+        return;
+    }
+
+    cur_resource->get()->set_style_property(command.property, command.unit, command.value);
+}
+
+static void apply_style_commands(recompui::Context* ctx, std::vector<recompui::StyleCommand>& style_commands) {
+    for (const recompui::StyleCommand& command : style_commands) {
+        apply_style_command(ctx, command);
+    }
+}
+
 void recompui::ContextId::process_updates() {
     // Ensure a context is currently opened by this thread.
     if (opened_context_id == ContextId::null()) {
@@ -388,6 +418,19 @@ void recompui::ContextId::process_updates() {
         context_error(*this, ContextErrorType::InternalError);
     }
 
+    // Apply all queued style commands in one pass before dispatching updates, so that elements see their final
+    // style and Rml only has to recompute the dirtied properties once during the next layout.
+    std::vector<StyleCommand> style_commands = std::move(opened_context->style_commands);
+    opened_context->style_commands.clear();
+
+    apply_style_commands(opened_context, style_commands);
+
+    // Keep the buffer's capacity around for the next frame to avoid reallocating it.
+    if (opened_context->style_commands.empty()) {
+        style_commands.clear();
+        opened_context->style_commands = std::move(style_commands);
+    }
+
     // Move the current update set into a local variable. This clears the update set
     // and allows it to be used to queue updates from any element callbacks.
     std::unordered_set<ResourceId> to_update = std::move(opened_context->to_update);
@@ -493,6 +536,16 @@ void recompui::ContextId::set_captures_mouse(bool captures_mouse) {
     ctx->captures_mouse = captures_mouse;
 }
 
+void recompui::ContextId::set_shown(bool shown) {
+    std::lock_guard lock{ context_state.all_contexts_lock };
+
+    Context* ctx = context_state.all_contexts.get(context_slotmap::key{ slot_id });
+    if (ctx == nullptr) {
+        return;
+    }
+    ctx->shown = shown;
+}
+
 recompui::Style* recompui::ContextId::add_resource_impl(std::unique_ptr<Style>&& resource) {
     // Ensure a context is currently opened by this thread.
     if (opened_context_id == ContextId::null()) {
@@ -571,6 +624,43 @@ void recompui::ContextId::queue_set_text(Element* element, std::string&& text) {
     opened_context->to_set_text.emplace_back(std::make_tuple(element, element->resource_id, std::move(text)));
 }
 
+void recompui::ContextId::queue_style_command(const StyleCommand& command) {
+    // Ensure a context is currently opened by this thread.
+    if (opened_context_id == ContextId::null()) {
+        context_error(*this, ContextErrorType::StyleCommandWithoutContext);
+    }
+
+    // Check that the context that was specified is the same one that's currently open.
+    if (*this != opened_context_id) {
+        context_error(*this, ContextErrorType::StyleCommandInWrongContext);
+    }
+
+    // The context's lock is already held by this thread, so the buffer can be appended to directly.
+    std::vector<StyleCommand>& style_commands = opened_context->style_commands;
+
+    // Hidden contexts don't get processed by the UI thread, so apply the command right away. Anything still buffered
+    // from before the context was hidden goes first to keep the order.
+    if (!opened_context->shown) {
+        if (!style_commands.empty()) {
+            apply_style_commands(opened_context, style_commands);
+            style_commands.clear();
+        }
+        apply_style_command(opened_context, command);
+        return;
+    }
+
+    // Collapse repeated writes of the same property on the same resource, which is common when animating.
+    if (!style_commands.empty()) {
+        StyleCommand& last = style_commands.back();
+        if (last.resource == command.resource && last.property == command.property) {
+            last = command;
+            return;
+        }
+    }
+
+    style_commands.emplace_back(command);
+}
+
 recompui::Style* recompui::ContextId::create_style() {
     return add_resource_impl(std::make_unique<Style>());
 }
@@ -13,6 +13,7 @@
 namespace recompui {
     class Style;
     class Element;
+    struct StyleCommand;
     class ContextId {
         Style* add_resource_impl(std::unique_ptr<Style>&& resource);
     public:
@@ -32,6 +33,7 @@ namespace recompui {
         void add_loose_element(Element* element);
         void queue_element_update(ResourceId element);
         void queue_set_text(Element* element, std::string&& text);
+        void queue_style_command(const StyleCommand& command);
 
         Style* create_style();
 
@@ -56,6 +58,8 @@ namespace recompui {
 
         void set_captures_input(bool captures_input);
         void set_captures_mouse(bool captures_input);
+        // Called by the UI state when the context is shown or hidden.
+        void set_shown(bool shown);
     };
 
     ContextId create_context(const std::filesystem::path& path);
@@ -5,6 +5,7 @@
 #include "ui_element.h"
 #include "../core/ui_context.h"
 
+#include <algorithm>
 #include <cassert>
 
 namespace recompui {
@@ -324,6 +325,35 @@ bool Element::remove_child(ResourceId child) {
     return found;
 }
 
+void Element::move_child_to_front(Element *child) {
+    auto it = std::find(children.begin(), children.end(), child);
+    if (it == children.end()) {
+        assert(false && "Attempted to move an element that isn't a child of this element");
+        return;
+    }
+
+    children.erase(it);
+    children.insert(children.begin(), child);
+
+    // Reinsert the same Rml element so that it keeps its listeners and properties.
+    Rml::ElementPtr child_owning = base->RemoveChild(child->base);
+    child->base = base->InsertBefore(std::move(child_owning), base->GetFirstChild());
+}
+
+void Element::move_child_to_back(Element *child) {
+    auto it = std::find(children.begin(), children.end(), child);
+    if (it == children.end()) {
+        assert(false && "Attempted to move an element that isn't a child of this element");
+        return;
+    }
+
+    children.erase(it);
+    children.emplace_back(child);
+
+    Rml::ElementPtr child_owning = base->RemoveChild(child->base);
+    child->base = base->AppendChild(std::move(child_owning));
+}
+
 void Element::add_style(Style *style, const std::string_view style_name) {
     add_style(style, { style_name });
 }
@@ -457,6 +487,19 @@ float Element::get_client_height() {
     return base->GetClientHeight();
 }
 
+float Element::get_scroll_top() {
+    return base->GetScrollTop();
+}
+
+void Element::set_scroll_top(float scroll_top) {
+    base->SetScrollTop(scroll_top);
+}
+
+float Element::get_dp_ratio() {
+    Rml::Context* context = base->GetContext();
+    return context != nullptr ? context->GetDensityIndependentPixelRatio() : 1.0f;
+}
+
 uint32_t Element::get_input_value_u32() {
     ElementValue value = get_element_value();
     
@@ -69,6 +69,8 @@ public:
     void clear_children();
     bool remove_child(ResourceId child);
     bool remove_child(Element *child) { return remove_child(child->get_resource_id()); }
+    void move_child_to_front(Element *child);
+    void move_child_to_back(Element *child);
     void add_style(Style *style, std::string_view style_name);
     void add_style(Style *style, const std::initializer_list<std::string_view> &style_names);
     void set_enabled(bool enabled);
@@ -87,6 +89,9 @@ public:
     float get_client_top();
     float get_client_width();
     float get_client_height();
+    float get_scroll_top();
+    void set_scroll_top(float scroll_top);
+    float get_dp_ratio();
     void enable_focus();
     void focus();
     void blur();
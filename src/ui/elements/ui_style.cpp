@@ -608,5 +608,223 @@ namespace recompui {
         set_property(Rml::PropertyId::Focus, focusable ? Rml::Style::Focus::Auto : Rml::Style::Focus::None);
     }
 
+    void Style::set_style_property(StyleProperty property, Unit unit, StyleValue value) {
+        switch (property) {
+        case StyleProperty::Visibility:
+            set_visibility(static_cast<Visibility>(value.u32));
+            break;
+        case StyleProperty::Position:
+            set_position(static_cast<Position>(value.u32));
+            break;
+        case StyleProperty::Left:
+            set_left(value.f32, unit);
+            break;
+        case StyleProperty::Top:
+            set_top(value.f32, unit);
+            break;
+        case StyleProperty::Right:
+            set_right(value.f32, unit);
+            break;
+        case StyleProperty::Bottom:
+            set_bottom(value.f32, unit);
+            break;
+        case StyleProperty::Width:
+            set_width(value.f32, unit);
+            break;
+        case StyleProperty::WidthAuto:
+            set_width_auto();
+            break;
+        case StyleProperty::Height:
+            set_height(value.f32, unit);
+            break;
+        case StyleProperty::HeightAuto:
+            set_height_auto();
+            break;
+        case StyleProperty::MinWidth:
+            set_min_width(value.f32, unit);
+            break;
+        case StyleProperty::MinHeight:
+            set_min_height(value.f32, unit);
+            break;
+        case StyleProperty::MaxWidth:
+            set_max_width(value.f32, unit);
+            break;
+        case StyleProperty::MaxHeight:
+            set_max_height(value.f32, unit);
+            break;
+        case StyleProperty::Padding:
+            set_padding(value.f32, unit);
+            break;
+        case StyleProperty::PaddingLeft:
+            set_padding_left(value.f32, unit);
+            break;
+        case StyleProperty::PaddingTop:
+            set_padding_top(value.f32, unit);
+            break;
+        case StyleProperty::PaddingRight:
+            set_padding_right(value.f32, unit);
+            break;
+        case StyleProperty::PaddingBottom:
+            set_padding_bottom(value.f32, unit);
+            break;
+        case StyleProperty::Margin:
+            set_margin(value.f32, unit);
+            break;
+        case StyleProperty::MarginLeft:
+            set_margin_left(value.f32, unit);
+            break;
+        case StyleProperty::MarginTop:
+            set_margin_top(value.f32, unit);
+            break;
+        case StyleProperty::MarginRight:
+            set_margin_right(value.f32, unit);
+            break;
+        case StyleProperty::MarginBottom:
+            set_margin_bottom(value.f32, unit);
+            break;
+        case StyleProperty::MarginAuto:
+            set_margin_auto();
+            break;
+        case StyleProperty::MarginLeftAuto:
+            set_margin_left_auto();
+            break;
+        case StyleProperty::MarginTopAuto:
+            set_margin_top_auto();
+            break;
+        case StyleProperty::MarginRightAuto:
+            set_margin_right_auto();
+            break;
+        case StyleProperty::MarginBottomAuto:
+            set_margin_bottom_auto();
+            break;
+        case StyleProperty::BorderWidth:
+            set_border_width(value.f32, unit);
+            break;
+        case StyleProperty::BorderLeftWidth:
+            set_border_left_width(value.f32, unit);
+            break;
+        case StyleProperty::BorderTopWidth:
+            set_border_top_width(value.f32, unit);
+            break;
+        case StyleProperty::BorderRightWidth:
+            set_border_right_width(value.f32, unit);
+            break;
+        case StyleProperty::BorderBottomWidth:
+            set_border_bottom_width(value.f32, unit);
+            break;
+        case StyleProperty::BorderRadius:
+            set_border_radius(value.f32, unit);
+            break;
+        case StyleProperty::BorderTopLeftRadius:
+            set_border_top_left_radius(value.f32, unit);
+            break;
+        case StyleProperty::BorderTopRightRadius:
+            set_border_top_right_radius(value.f32, unit);
+            break;
+        case StyleProperty::BorderBottomLeftRadius:
+            set_border_bottom_left_radius(value.f32, unit);
+            break;
+        case StyleProperty::BorderBottomRightRadius:
+            set_border_bottom_right_radius(value.f32, unit);
+            break;
+        case StyleProperty::BackgroundColor:
+            set_background_color(unpack_color(value.u32));
+            break;
+        case StyleProperty::BorderColor:
+            set_border_color(unpack_color(value.u32));
+            break;
+        case StyleProperty::BorderLeftColor:
+            set_border_left_color(unpack_color(value.u32));
+            break;
+        case StyleProperty::BorderTopColor:
+            set_border_top_color(unpack_color(value.u32));
+            break;
+        case StyleProperty::BorderRightColor:
+            set_border_right_color(unpack_color(value.u32));
+            break;
+        case StyleProperty::BorderBottomColor:
+            set_border_bottom_color(unpack_color(value.u32));
+            break;
+        case StyleProperty::Color:
+            set_color(unpack_color(value.u32));
+            break;
+        case StyleProperty::Cursor:
+            set_cursor(static_cast<Cursor>(value.u32));
+            break;
+        case StyleProperty::Opacity:
+            set_opacity(value.f32);
+            break;
+        case StyleProperty::Display:
+            set_display(static_cast<Display>(value.u32));
+            break;
+        case StyleProperty::JustifyContent:
+            set_justify_content(static_cast<JustifyContent>(value.u32));
+            break;
+        case StyleProperty::FlexGrow:
+            set_flex_grow(value.f32);
+            break;
+        case StyleProperty::FlexShrink:
+            set_flex_shrink(value.f32);
+            break;
+        case StyleProperty::FlexBasisAuto:
+            set_flex_basis_auto();
+            break;
+        case StyleProperty::FlexBasis:
+            set_flex_basis(value.f32, unit);
+            break;
+        case StyleProperty::FlexDirection:
+            set_flex_direction(static_cast<FlexDirection>(value.u32));
+            break;
+        case StyleProperty::AlignItems:
+            set_align_items(static_cast<AlignItems>(value.u32));
+            break;
+        case StyleProperty::Overflow:
+            set_overflow(static_cast<Overflow>(value.u32));
+            break;
+        case StyleProperty::OverflowX:
+            set_overflow_x(static_cast<Overflow>(value.u32));
+            break;
+        case StyleProperty::OverflowY:
+            set_overflow_y(static_cast<Overflow>(value.u32));
+            break;
+        case StyleProperty::FontSize:
+            set_font_size(value.f32, unit);
+            break;
+        case StyleProperty::LetterSpacing:
+            set_letter_spacing(value.f32, unit);
+            break;
+        case StyleProperty::LineHeight:
+            set_line_height(value.f32, unit);
+            break;
+        case StyleProperty::FontStyle:
+            set_font_style(static_cast<FontStyle>(value.u32));
+            break;
+        case StyleProperty::FontWeight:
+            set_font_weight(value.u32);
+            break;
+        case StyleProperty::TextAlign:
+            set_text_align(static_cast<TextAlign>(value.u32));
+            break;
+        case StyleProperty::Gap:
+            set_gap(value.f32, unit);
+            break;
+        case StyleProperty::RowGap:
+            set_row_gap(value.f32, unit);
+            break;
+        case StyleProperty::ColumnGap:
+            set_column_gap(value.f32, unit);
+            break;
+        case StyleProperty::Drag:
+            set_drag(static_cast<Drag>(value.u32));
+            break;
+        case StyleProperty::TabIndex:
+            set_tab_index(static_cast<TabIndex>(value.u32));
+            break;
+        default:
+            assert(false && "Unknown style property.");
+            break;
+        }
+    }
+
 
 } // namespace recompui
\ No newline at end of file
@@ -9,6 +9,15 @@
 
 namespace recompui {
     class ContextId;
+
+    // A single deferred style change, queued on a context and applied during ContextId::process_updates.
+    struct StyleCommand {
+        ResourceId resource;
+        StyleProperty property;
+        Unit unit;
+        StyleValue value;
+    };
+
     class Style {
         friend class Element; // For access to property_map without making it visible to element subclasses.
         friend class ContextId;
@@ -101,6 +110,7 @@ namespace recompui {
         void set_tab_index_auto();
         void set_tab_index_none();
         void set_focusable(bool focusable);
+        void set_style_property(StyleProperty property, Unit unit, StyleValue value);
         virtual bool is_element() { return false; }
         ResourceId get_resource_id() { return resource_id; }
     };
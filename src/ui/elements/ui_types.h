@@ -235,6 +235,7 @@ namespace recompui {
         Scroll
     };
 
+    // This enum must be kept in sync with RecompuiUnit in patches/ui_funcs.h!
     enum class Unit {
         Px,
         Dp,
@@ -279,4 +280,100 @@ namespace recompui {
         Auto
     };
 
+    // Style properties that can be queued as deferred style commands.
+    // This enum must be kept in sync with RecompuiStyleProperty in patches/ui_funcs.h!
+    enum class StyleProperty : uint8_t {
+        Visibility,
+        Position,
+        Left,
+        Top,
+        Right,
+        Bottom,
+        Width,
+        WidthAuto,
+        Height,
+        HeightAuto,
+        MinWidth,
+        MinHeight,
+        MaxWidth,
+        MaxHeight,
+        Padding,
+        PaddingLeft,
+        PaddingTop,
+        PaddingRight,
+        PaddingBottom,
+        Margin,
+        MarginLeft,
+        MarginTop,
+        MarginRight,
+        MarginBottom,
+        MarginAuto,
+        MarginLeftAuto,
+        MarginTopAuto,
+        MarginRightAuto,
+        MarginBottomAuto,
+        BorderWidth,
+        BorderLeftWidth,
+        BorderTopWidth,
+        BorderRightWidth,
+        BorderBottomWidth,
+        BorderRadius,
+        BorderTopLeftRadius,
+        BorderTopRightRadius,
+        BorderBottomLeftRadius,
+        BorderBottomRightRadius,
+        BackgroundColor,
+        BorderColor,
+        BorderLeftColor,
+        BorderTopColor,
+        BorderRightColor,
+        BorderBottomColor,
+        Color,
+        Cursor,
+        Opacity,
+        Display,
+        JustifyContent,
+        FlexGrow,
+        FlexShrink,
+        FlexBasisAuto,
+        FlexBasis,
+        FlexDirection,
+        AlignItems,
+        Overflow,
+        OverflowX,
+        OverflowY,
+        FontSize,
+        LetterSpacing,
+        LineHeight,
+        FontStyle,
+        FontWeight,
+        TextAlign,
+        Gap,
+        RowGap,
+        ColumnGap,
+        Drag,
+        TabIndex,
+        Count
+    };
+
+    // Raw value of a style command. Floats are used for lengths and numbers, u32 for enums and weights,
+    // and colors are packed as 0xRRGGBBAA.
+    union StyleValue {
+        float f32;
+        uint32_t u32;
+    };
+
+    inline uint32_t pack_color(const Color& color) {
+        return (uint32_t(color.r) << 24) | (uint32_t(color.g) << 16) | (uint32_t(color.b) << 8) | uint32_t(color.a);
+    }
+
+    inline Color unpack_color(uint32_t packed) {
+        return Color{
+            .r = uint8_t(packed >> 24),
+            .g = uint8_t(packed >> 16),
+            .b = uint8_t(packed >> 8),
+            .a = uint8_t(packed >> 0),
+        };
+    }
+
 } // namespace recompui
\ No newline at end of file
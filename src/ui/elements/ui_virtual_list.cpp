@@ -0,0 +1,146 @@
+#include "ui_virtual_list.h"
+#include "recomp_ui.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace recompui {
+
+    VirtualList::VirtualList(Element *parent, float row_height, RowFactory create_row, RowBinder bind_row, size_t overscan) :
+        ScrollContainer(parent, ScrollDirection::Vertical), create_row(create_row), bind_row(bind_row), row_height(row_height), overscan(overscan) {
+        assert(row_height > 0.0f);
+
+        ContextId context = get_current_context();
+
+        // The paddings stand in for the rows above and below the window so the scroll range matches the full list.
+        top_padding = context.create_element<Element>(this);
+        top_padding->set_height(0.0f);
+
+        row_container = context.create_element<Element>(this);
+        row_container->set_width(100.0f, Unit::Percent);
+
+        bottom_padding = context.create_element<Element>(this);
+        bottom_padding->set_height(0.0f);
+    }
+
+    void VirtualList::bind_row_at(size_t row_index) {
+        bind_row(rows[row_index], first_index + row_index);
+    }
+
+    void VirtualList::update_visible_rows(bool force_rebind) {
+        float row_height_px = row_height * get_dp_ratio();
+        float scroll_top = get_scroll_top();
+        float viewport_height = get_client_height();
+
+        last_scroll_top = scroll_top;
+        last_viewport_height = viewport_height;
+
+        // The viewport has no size until the list has gone through layout, so assume it covers the whole window.
+        if (viewport_height <= 0.0f) {
+            int window_width, window_height;
+            get_window_size(window_width, window_height);
+            viewport_height = static_cast<float>(window_height);
+        }
+
+        size_t visible_first = static_cast<size_t>(std::max(scroll_top, 0.0f) / row_height_px);
+        size_t visible_count = static_cast<size_t>(std::ceil(viewport_height / row_height_px)) + 1;
+        size_t new_first = std::min(visible_first > overscan ? visible_first - overscan : 0, item_count);
+        size_t new_last = std::min(visible_first + visible_count + overscan, item_count);
+        size_t new_count = new_last - new_first;
+
+        bool rebind_all = force_rebind;
+
+        // Match the number of live rows to the size of the window.
+        if (rows.size() != new_count) {
+            while (rows.size() < new_count) {
+                rows.emplace_back(create_row(row_container));
+            }
+
+            while (rows.size() > new_count) {
+                row_container->remove_child(rows.back());
+                rows.pop_back();
+            }
+
+            rebind_all = true;
+        }
+
+        size_t old_first = first_index;
+        first_index = new_first;
+
+        if (rebind_all || new_first >= old_first + rows.size() || old_first >= new_first + rows.size()) {
+            for (size_t i = 0; i < rows.size(); i++) {
+                bind_row_at(i);
+            }
+        }
+        else if (new_first > old_first) {
+            // Move the rows that scrolled off the top to the bottom and only rebind those. Rows that stay in view
+            // keep their element, which preserves state such as focus and hover.
+            size_t shift = new_first - old_first;
+            std::rotate(rows.begin(), rows.begin() + shift, rows.end());
+            for (size_t i = rows.size() - shift; i < rows.size(); i++) {
+                row_container->move_child_to_back(rows[i]);
+                bind_row_at(i);
+            }
+        }
+        else if (new_first < old_first) {
+            size_t shift = old_first - new_first;
+            std::rotate(rows.begin(), rows.end() - shift, rows.end());
+            for (size_t i = shift; i > 0; i--) {
+                row_container->move_child_to_front(rows[i - 1]);
+                bind_row_at(i - 1);
+            }
+        }
+        else {
+            // The window didn't move, so there's no need to touch the paddings.
+            return;
+        }
+
+        top_padding->set_height(first_index * row_height);
+        bottom_padding->set_height((item_count - first_index - rows.size()) * row_height);
+    }
+
+    void VirtualList::process_event(const Event &e) {
+        switch (e.type) {
+        case EventType::Update:
+            if (get_scroll_top() != last_scroll_top || get_client_height() != last_viewport_height) {
+                update_visible_rows(false);
+            }
+
+            // Keep polling the scroll position for as long as the list exists.
+            queue_update();
+            break;
+        default:
+            break;
+        }
+    }
+
+    void VirtualList::set_item_count(size_t count) {
+        item_count = count;
+        update_visible_rows(true);
+
+        // Start polling the scroll position. The element has no resource ID yet in the constructor, so this can't be
+        // done there. Queueing it again when the count changes is harmless since updates are deduplicated.
+        queue_update();
+    }
+
+    void VirtualList::refresh() {
+        for (size_t i = 0; i < rows.size(); i++) {
+            bind_row_at(i);
+        }
+    }
+
+    Element *VirtualList::get_row(size_t index) {
+        if (index < first_index || index >= first_index + rows.size()) {
+            return nullptr;
+        }
+
+        return rows[index - first_index];
+    }
+
+    float VirtualList::get_row_middle(size_t index) {
+        float row_height_px = row_height * get_dp_ratio();
+        return get_absolute_top() + get_client_top() - get_scroll_top() + (index + 0.5f) * row_height_px;
+    }
+
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <functional>
+
+#include "ui_scroll_container.h"
+
+namespace recompui {
+
+    // Vertical scroll container that only creates elements for the rows that are currently visible, plus a small
+    // overscan above and below. Rows are recycled as the list scrolls, so the amount of live elements depends on the
+    // size of the viewport instead of the number of items. Every row is expected to have the same height.
+    class VirtualList : public ScrollContainer {
+    public:
+        using RowFactory = std::function<Element *(Element *parent)>;
+        using RowBinder = std::function<void(Element *row, size_t index)>;
+    private:
+        RowFactory create_row;
+        RowBinder bind_row;
+        float row_height;
+        size_t overscan;
+        size_t item_count = 0;
+        size_t first_index = 0;
+        Element *top_padding = nullptr;
+        Element *row_container = nullptr;
+        Element *bottom_padding = nullptr;
+        std::vector<Element *> rows;
+        float last_scroll_top = -1.0f;
+        float last_viewport_height = -1.0f;
+
+        void update_visible_rows(bool force_rebind);
+        void bind_row_at(size_t row_index);
+    protected:
+        virtual void process_event(const Event &e) override;
+        std::string_view get_type_name() override { return "VirtualList"; }
+    public:
+        // The row height is specified in dp.
+        VirtualList(Element *parent, float row_height, RowFactory create_row, RowBinder bind_row, size_t overscan = 2);
+        void set_item_count(size_t count);
+        size_t get_item_count() const { return item_count; }
+        void refresh();
+        Element *get_row(size_t index);
+        float get_row_middle(size_t index);
+    };
+
+} // namespace recompui
@@ -1,4 +1,5 @@
 #include "recomp_ui.h"
+#include "recomp_profiler.h"
 
 #include "ui_helpers.h"
 #include "ui_api_images.h"
@@ -28,6 +29,24 @@
 
 using namespace recompui;
 
+// Queues a style change for the resource passed as the first argument. The change is buffered on the open context
+// and applied when the context processes its updates, so a batch of style calls from a mod only touches Rml once.
+static void queue_style(Style* resource, StyleProperty property, Unit unit, StyleValue value) {
+    ResourceId resource_id = resource->get_resource_id();
+
+    // The root element isn't a resource in the context, so apply changes to it immediately.
+    if (resource_id == ResourceId::null()) {
+        resource->set_style_property(property, unit, value);
+        return;
+    }
+
+    recompui::get_current_context().queue_style_command(StyleCommand{ resource_id, property, unit, value });
+}
+
+static void queue_style(uint8_t* rdram, recomp_context* ctx, StyleProperty property, Unit unit, StyleValue value) {
+    queue_style(arg_style<0>(rdram, ctx), property, unit, value);
+}
+
 // Contexts
 void recompui_create_context(uint8_t* rdram, recomp_context* ctx) {
     (void)rdram;
@@ -195,448 +214,380 @@ void recompui_create_slider(uint8_t* rdram, recomp_context* ctx) {
 
 // Position and Layout
 void recompui_set_visibility(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     uint32_t visibility = _arg<1, uint32_t>(rdram, ctx);
 
-    resource->set_visibility(static_cast<Visibility>(visibility));
+    queue_style(rdram, ctx, StyleProperty::Visibility, Unit::Dp, { .u32 = visibility });
 }
 
 void recompui_set_position(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     uint32_t position = _arg<1, uint32_t>(rdram, ctx);
 
-    resource->set_position(static_cast<Position>(position));
+    queue_style(rdram, ctx, StyleProperty::Position, Unit::Dp, { .u32 = position });
 }
 
 void recompui_set_left(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float left = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_left(left, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::Left, static_cast<Unit>(unit), { .f32 = left });
 }
 
 void recompui_set_top(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float top = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_top(top, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::Top, static_cast<Unit>(unit), { .f32 = top });
 }
 
 void recompui_set_right(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float right = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_right(right, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::Right, static_cast<Unit>(unit), { .f32 = right });
 }
 
 void recompui_set_bottom(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float bottom = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_bottom(bottom, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::Bottom, static_cast<Unit>(unit), { .f32 = bottom });
 }
 
 // Sizing
 void recompui_set_width(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float width = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_width(width, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::Width, static_cast<Unit>(unit), { .f32 = width });
 }
 
 void recompui_set_width_auto(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
-
-    resource->set_width_auto();
+    queue_style(rdram, ctx, StyleProperty::WidthAuto, Unit::Dp, { .u32 = 0 });
 }
 
 void recompui_set_height(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float height = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_height(height, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::Height, static_cast<Unit>(unit), { .f32 = height });
 }
 
 void recompui_set_height_auto(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
-
-    resource->set_height_auto();
+    queue_style(rdram, ctx, StyleProperty::HeightAuto, Unit::Dp, { .u32 = 0 });
 }
 
 void recompui_set_min_width(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float width = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_min_width(width, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::MinWidth, static_cast<Unit>(unit), { .f32 = width });
 }
 
 void recompui_set_min_height(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float height = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_min_height(height, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::MinHeight, static_cast<Unit>(unit), { .f32 = height });
 }
 
 void recompui_set_max_width(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float width = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_max_width(width, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::MaxWidth, static_cast<Unit>(unit), { .f32 = width });
 }
 
 void recompui_set_max_height(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float height = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_max_height(height, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::MaxHeight, static_cast<Unit>(unit), { .f32 = height });
 }
 
 // Padding
 void recompui_set_padding(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float padding = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_padding(padding, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::Padding, static_cast<Unit>(unit), { .f32 = padding });
 }
 
 void recompui_set_padding_left(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float padding = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_padding_left(padding, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::PaddingLeft, static_cast<Unit>(unit), { .f32 = padding });
 }
 
 void recompui_set_padding_top(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float padding = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_padding_top(padding, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::PaddingTop, static_cast<Unit>(unit), { .f32 = padding });
 }
 
 void recompui_set_padding_right(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float padding = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_padding_right(padding, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::PaddingRight, static_cast<Unit>(unit), { .f32 = padding });
 }
 
 void recompui_set_padding_bottom(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float padding = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_padding_bottom(padding, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::PaddingBottom, static_cast<Unit>(unit), { .f32 = padding });
 }
 
 // Margins
 void recompui_set_margin(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float margin = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_margin(margin, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::Margin, static_cast<Unit>(unit), { .f32 = margin });
 }
 
 void recompui_set_margin_left(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float margin = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_margin_left(margin, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::MarginLeft, static_cast<Unit>(unit), { .f32 = margin });
 }
 
 void recompui_set_margin_top(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float margin = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_margin_top(margin, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::MarginTop, static_cast<Unit>(unit), { .f32 = margin });
 }
 
 void recompui_set_margin_right(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float margin = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_margin_right(margin, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::MarginRight, static_cast<Unit>(unit), { .f32 = margin });
 }
 
 void recompui_set_margin_bottom(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float margin = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_margin_bottom(margin, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::MarginBottom, static_cast<Unit>(unit), { .f32 = margin });
 }
 
 void recompui_set_margin_auto(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
-
-    resource->set_margin_auto();
+    queue_style(rdram, ctx, StyleProperty::MarginAuto, Unit::Dp, { .u32 = 0 });
 }
 
 void recompui_set_margin_left_auto(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
-
-    resource->set_margin_left_auto();
+    queue_style(rdram, ctx, StyleProperty::MarginLeftAuto, Unit::Dp, { .u32 = 0 });
 }
 
 void recompui_set_margin_top_auto(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
-
-    resource->set_margin_top_auto();
+    queue_style(rdram, ctx, StyleProperty::MarginTopAuto, Unit::Dp, { .u32 = 0 });
 }
 
 void recompui_set_margin_right_auto(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
-
-    resource->set_margin_right_auto();
+    queue_style(rdram, ctx, StyleProperty::MarginRightAuto, Unit::Dp, { .u32 = 0 });
 }
 
 void recompui_set_margin_bottom_auto(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
-
-    resource->set_margin_bottom_auto();
+    queue_style(rdram, ctx, StyleProperty::MarginBottomAuto, Unit::Dp, { .u32 = 0 });
 }
 
 // Borders
 void recompui_set_border_width(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float width = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_border_width(width, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::BorderWidth, static_cast<Unit>(unit), { .f32 = width });
 }
 
 void recompui_set_border_left_width(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float width = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_border_left_width(width, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::BorderLeftWidth, static_cast<Unit>(unit), { .f32 = width });
 }
 
 void recompui_set_border_top_width(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float width = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_border_top_width(width, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::BorderTopWidth, static_cast<Unit>(unit), { .f32 = width });
 }
 
 void recompui_set_border_right_width(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float width = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_border_right_width(width, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::BorderRightWidth, static_cast<Unit>(unit), { .f32 = width });
 }
 
 void recompui_set_border_bottom_width(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float width = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_border_bottom_width(width, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::BorderBottomWidth, static_cast<Unit>(unit), { .f32 = width });
 }
 
 void recompui_set_border_radius(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float radius = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_border_radius(radius, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::BorderRadius, static_cast<Unit>(unit), { .f32 = radius });
 }
 
 void recompui_set_border_top_left_radius(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float radius = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_border_top_left_radius(radius, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::BorderTopLeftRadius, static_cast<Unit>(unit), { .f32 = radius });
 }
 
 void recompui_set_border_top_right_radius(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float radius = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_border_top_right_radius(radius, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::BorderTopRightRadius, static_cast<Unit>(unit), { .f32 = radius });
 }
 
 void recompui_set_border_bottom_left_radius(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float radius = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_border_bottom_left_radius(radius, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::BorderBottomLeftRadius, static_cast<Unit>(unit), { .f32 = radius });
 }
 
 void recompui_set_border_bottom_right_radius(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float radius = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_border_bottom_right_radius(radius, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::BorderBottomRightRadius, static_cast<Unit>(unit), { .f32 = radius });
 }
 
 // Colors
 void recompui_set_background_color(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     Color color = arg_color<1>(rdram, ctx);
 
-    resource->set_background_color(color);
+    queue_style(rdram, ctx, StyleProperty::BackgroundColor, Unit::Dp, { .u32 = pack_color(color) });
 }
 
 void recompui_set_border_color(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     Color color = arg_color<1>(rdram, ctx);
 
-    resource->set_border_color(color);
-
+    queue_style(rdram, ctx, StyleProperty::BorderColor, Unit::Dp, { .u32 = pack_color(color) });
 }
 
 void recompui_set_border_left_color(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     Color color = arg_color<1>(rdram, ctx);
 
-    resource->set_border_left_color(color);
+    queue_style(rdram, ctx, StyleProperty::BorderLeftColor, Unit::Dp, { .u32 = pack_color(color) });
 }
 
 void recompui_set_border_top_color(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     Color color = arg_color<1>(rdram, ctx);
 
-    resource->set_border_top_color(color);
+    queue_style(rdram, ctx, StyleProperty::BorderTopColor, Unit::Dp, { .u32 = pack_color(color) });
 }
 
 void recompui_set_border_right_color(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     Color color = arg_color<1>(rdram, ctx);
 
-    resource->set_border_right_color(color);
+    queue_style(rdram, ctx, StyleProperty::BorderRightColor, Unit::Dp, { .u32 = pack_color(color) });
 }
 
 void recompui_set_border_bottom_color(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     Color color = arg_color<1>(rdram, ctx);
 
-    resource->set_border_bottom_color(color);
+    queue_style(rdram, ctx, StyleProperty::BorderBottomColor, Unit::Dp, { .u32 = pack_color(color) });
 }
 
 void recompui_set_color(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     Color color = arg_color<1>(rdram, ctx);
 
-    resource->set_color(color);
+    queue_style(rdram, ctx, StyleProperty::Color, Unit::Dp, { .u32 = pack_color(color) });
 }
 
 // Cursor and Display
 void recompui_set_cursor(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     uint32_t cursor = _arg<1, uint32_t>(rdram, ctx);
 
-    resource->set_cursor(static_cast<Cursor>(cursor));
+    queue_style(rdram, ctx, StyleProperty::Cursor, Unit::Dp, { .u32 = cursor });
 }
 
 void recompui_set_opacity(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float opacity = _arg_float_a1(rdram, ctx);
 
-    resource->set_opacity(opacity);
+    queue_style(rdram, ctx, StyleProperty::Opacity, Unit::Dp, { .f32 = opacity });
 }
 
 void recompui_set_display(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     uint32_t display = _arg<1, uint32_t>(rdram, ctx);
 
-    resource->set_display(static_cast<Display>(display));
+    queue_style(rdram, ctx, StyleProperty::Display, Unit::Dp, { .u32 = display });
 }
 
 // Flexbox
 void recompui_set_justify_content(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     uint32_t justify_content = _arg<1, uint32_t>(rdram, ctx);
 
-    resource->set_justify_content(static_cast<JustifyContent>(justify_content));
+    queue_style(rdram, ctx, StyleProperty::JustifyContent, Unit::Dp, { .u32 = justify_content });
 }
 
 void recompui_set_flex_grow(uint8_t* rdram, recomp_context* ctx) { // float grow
-    Style* resource = arg_style<0>(rdram, ctx);
     float grow = _arg_float_a1(rdram, ctx);
 
-    resource->set_flex_grow(grow);
+    queue_style(rdram, ctx, StyleProperty::FlexGrow, Unit::Dp, { .f32 = grow });
 }
 
 void recompui_set_flex_shrink(uint8_t* rdram, recomp_context* ctx) { // float shrink
-    Style* resource = arg_style<0>(rdram, ctx);
     float shrink = _arg_float_a1(rdram, ctx);
 
-    resource->set_flex_shrink(shrink);
+    queue_style(rdram, ctx, StyleProperty::FlexShrink, Unit::Dp, { .f32 = shrink });
 }
 
 void recompui_set_flex_basis_auto(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
-
-    resource->set_flex_basis_auto();
+    queue_style(rdram, ctx, StyleProperty::FlexBasisAuto, Unit::Dp, { .u32 = 0 });
 }
 
 void recompui_set_flex_basis(uint8_t* rdram, recomp_context* ctx) { // float basis, Unit unit = Unit::Percent
-    Style* resource = arg_style<0>(rdram, ctx);
     float basis = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_flex_basis(basis, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::FlexBasis, static_cast<Unit>(unit), { .f32 = basis });
 }
 
 void recompui_set_flex_direction(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     uint32_t direction = _arg<1, uint32_t>(rdram, ctx);
 
-    resource->set_flex_direction(static_cast<FlexDirection>(direction));
+    queue_style(rdram, ctx, StyleProperty::FlexDirection, Unit::Dp, { .u32 = direction });
 }
 
 void recompui_set_align_items(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     uint32_t align_items = _arg<1, uint32_t>(rdram, ctx);
 
-    resource->set_align_items(static_cast<AlignItems>(align_items));
+    queue_style(rdram, ctx, StyleProperty::AlignItems, Unit::Dp, { .u32 = align_items });
 }
 
 // Overflow
 void recompui_set_overflow(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     uint32_t overflow = _arg<1, uint32_t>(rdram, ctx);
 
-    resource->set_overflow(static_cast<Overflow>(overflow));
+    queue_style(rdram, ctx, StyleProperty::Overflow, Unit::Dp, { .u32 = overflow });
 }
 
 void recompui_set_overflow_x(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     uint32_t overflow = _arg<1, uint32_t>(rdram, ctx);
 
-    resource->set_overflow_x(static_cast<Overflow>(overflow));
+    queue_style(rdram, ctx, StyleProperty::OverflowX, Unit::Dp, { .u32 = overflow });
 }
 
 void recompui_set_overflow_y(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     uint32_t overflow = _arg<1, uint32_t>(rdram, ctx);
 
-    resource->set_overflow_y(static_cast<Overflow>(overflow));
+    queue_style(rdram, ctx, StyleProperty::OverflowY, Unit::Dp, { .u32 = overflow });
 }
 
 // Text and Fonts
@@ -654,89 +605,111 @@ void recompui_set_text(uint8_t* rdram, recomp_context* ctx) {
 }
 
 void recompui_set_font_size(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float size = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_font_size(size, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::FontSize, static_cast<Unit>(unit), { .f32 = size });
 }
 
 void recompui_set_letter_spacing(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float spacing = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_letter_spacing(spacing, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::LetterSpacing, static_cast<Unit>(unit), { .f32 = spacing });
 }
 
 void recompui_set_line_height(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float height = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_line_height(height, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::LineHeight, static_cast<Unit>(unit), { .f32 = height });
 }
 
 void recompui_set_font_style(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     uint32_t style = _arg<1, uint32_t>(rdram, ctx);
 
-    resource->set_font_style(static_cast<FontStyle>(style));
+    queue_style(rdram, ctx, StyleProperty::FontStyle, Unit::Dp, { .u32 = style });
 }
 
 void recompui_set_font_weight(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     int32_t weight = _arg<1, int32_t>(rdram, ctx);
 
-    resource->set_font_weight(weight);
+    queue_style(rdram, ctx, StyleProperty::FontWeight, Unit::Dp, { .u32 = static_cast<uint32_t>(weight) });
 }
 
 void recompui_set_text_align(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     uint32_t text_align = _arg<1, uint32_t>(rdram, ctx);
 
-    resource->set_text_align(static_cast<TextAlign>(text_align));
+    queue_style(rdram, ctx, StyleProperty::TextAlign, Unit::Dp, { .u32 = text_align });
 }
 
 // Gaps
 void recompui_set_gap(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float size = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_gap(size, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::Gap, static_cast<Unit>(unit), { .f32 = size });
 }
 
 void recompui_set_row_gap(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float size = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_row_gap(size, static_cast<Unit>(unit));
-
+    queue_style(rdram, ctx, StyleProperty::RowGap, static_cast<Unit>(unit), { .f32 = size });
 }
 
 void recompui_set_column_gap(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     float size = _arg_float_a1(rdram, ctx);
     uint32_t unit = _arg<2, uint32_t>(rdram, ctx);
 
-    resource->set_column_gap(size, static_cast<Unit>(unit));
+    queue_style(rdram, ctx, StyleProperty::ColumnGap, static_cast<Unit>(unit), { .f32 = size });
 }
 
 // Drag and Focus
 void recompui_set_drag(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     uint32_t drag = _arg<1, uint32_t>(rdram, ctx);
 
-    resource->set_drag(static_cast<Drag>(drag));
+    queue_style(rdram, ctx, StyleProperty::Drag, Unit::Dp, { .u32 = drag });
 }
 
 void recompui_set_tab_index(uint8_t* rdram, recomp_context* ctx) {
-    Style* resource = arg_style<0>(rdram, ctx);
     uint32_t tab_index = _arg<1, uint32_t>(rdram, ctx);
 
-    resource->set_tab_index(static_cast<TabIndex>(tab_index));
+    queue_style(rdram, ctx, StyleProperty::TabIndex, Unit::Dp, { .u32 = tab_index });
+}
+
+// Bulk styling
+// Layout of RecompuiStyleRecord in patches/ui_funcs.h.
+constexpr uint32_t style_record_size = 0xC;
+constexpr uint32_t style_record_property_offset = 0x0;
+constexpr uint32_t style_record_unit_offset = 0x4;
+constexpr uint32_t style_record_value_offset = 0x8;
+
+void recompui_apply_style_block(uint8_t* rdram, recomp_context* ctx) {
+    Style* resource = arg_style<0>(rdram, ctx);
+    PTR(void) records = _arg<1, PTR(void)>(rdram, ctx);
+    uint32_t count = _arg<2, uint32_t>(rdram, ctx);
+
+    if (resource == nullptr) {
+        recompui::message_box("Fatal error in mod - attempted to apply a style block to a resource not found in context");
+        assert(false);
+        ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t record_offset = i * style_record_size;
+        uint32_t property = MEM_W(record_offset + style_record_property_offset, records);
+        uint32_t unit = MEM_W(record_offset + style_record_unit_offset, records);
+        StyleValue value{ .u32 = static_cast<uint32_t>(MEM_W(record_offset + style_record_value_offset, records)) };
+
+        if (property >= static_cast<uint32_t>(StyleProperty::Count)) {
+            recompui::message_box("Fatal error in mod - invalid style property in style block");
+            assert(false);
+            ultramodern::error_handling::quick_exit(__FILE__, __LINE__, __FUNCTION__);
+        }
+
+        queue_style(resource, static_cast<StyleProperty>(property), static_cast<Unit>(unit), value);
+    }
 }
 
 // Values
@@ -925,7 +898,7 @@ void recompui_set_nav(uint8_t* rdram, recomp_context* ctx) {
     element->set_nav(static_cast<recompui::NavDirection>(nav_dir), target_element);
 }
 
-#define REGISTER_FUNC(name) recomp::overlays::register_base_export(#name, name)
+#define REGISTER_FUNC(name) REGISTER_PROFILED_FUNC(recomputil::ProfileCategory::UiApi, name)
 
 void recompui::register_ui_exports() {
     REGISTER_FUNC(recompui_create_context);
@@ -1017,6 +990,7 @@ void recompui::register_ui_exports() {
     REGISTER_FUNC(recompui_set_column_gap);
     REGISTER_FUNC(recompui_set_drag);
     REGISTER_FUNC(recompui_set_tab_index);
+    REGISTER_FUNC(recompui_apply_style_block);
     REGISTER_FUNC(recompui_get_input_value_u32);
     REGISTER_FUNC(recompui_get_input_value_float);
     REGISTER_FUNC(recompui_get_input_text);
@@ -2,6 +2,7 @@
 
 #include "overloaded.h"
 #include "recomp_ui.h"
+#include "recomp_profiler.h"
 
 #include "core/ui_context.h"
 #include "core/ui_resource.h"
@@ -93,6 +94,9 @@ bool convert_event(const recompui::Event& in, RecompuiEventData& out) {
 }
 
 extern "C" void recomp_run_ui_callbacks(uint8_t* rdram, recomp_context* ctx) {
+    static recomputil::ProfileCounterId callback_counter =
+        recomputil::register_profile_counter(recomputil::ProfileCategory::UiCallback, "recompui callbacks");
+
     // Allocate the event on the stack.
     gpr stack_frame = ctx->r29;
     ctx->r29 -= sizeof(RecompuiEventData);
@@ -109,7 +113,10 @@ extern "C" void recomp_run_ui_callbacks(uint8_t* rdram, recomp_context* ctx) {
             ctx->r5 = stack_frame;
             ctx->r6 = cur_callback.callback.userdata;
 
-            LOOKUP_FUNC(cur_callback.callback.callback)(rdram, ctx);
+            {
+                recomputil::ProfileScope scope{callback_counter};
+                LOOKUP_FUNC(cur_callback.callback.callback)(rdram, ctx);
+            }
             cur_context.close();
         }
     }
@@ -2,6 +2,7 @@
 #include <unordered_set>
 
 #include "recomp_ui.h"
+#include "recomp_profiler.h"
 #include "librecomp/overlays.hpp"
 #include "librecomp/helpers.hpp"
 #include "ultramodern/error_handling.hpp"
@@ -120,7 +121,7 @@ void recompui_set_imageview_texture(uint8_t* rdram, recomp_context* ctx) {
     element->set_src(get_texture_name(texture_id));
 }
 
-#define REGISTER_FUNC(name) recomp::overlays::register_base_export(#name, name)
+#define REGISTER_FUNC(name) REGISTER_PROFILED_FUNC(recomputil::ProfileCategory::UiApi, name)
 
 void recompui::register_ui_image_exports() {
     REGISTER_FUNC(recompui_create_texture_rgba32);
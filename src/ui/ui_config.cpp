@@ -3,6 +3,10 @@
 #include "zelda_sound.h"
 #include "zelda_config.h"
 #include "zelda_debug.h"
+#include "recomp_profiler.h"
+#include "zelda_latency.h"
+#include "zelda_pacer.h"
+#include "zelda_gfx_arena.h"
 #include "zelda_render.h"
 #include "zelda_support.h"
 #include "promptfont.h"
@@ -442,8 +446,34 @@ bool zelda64::get_low_health_beeps_enabled() {
     return (bool)sound_options_context.low_health_beeps_enabled.load();
 }
 
+// One row of the mod profiler table in the debug menu. Times are averaged over the frames in which the counter was
+// actually called, so hooks that only run occasionally aren't diluted by idle frames.
+struct ProfilerRow {
+    std::string name;
+    std::string category;
+    std::string calls;
+    std::string avg_time;
+    std::string max_time;
+};
+
+// One row of the input latency table in the debug menu, with the distribution of one stage over the probes that
+// completed.
+struct LatencyRow {
+    std::string stage;
+    std::string min_time;
+    std::string median_time;
+    std::string p95_time;
+    std::string max_time;
+};
+
 struct DebugContext {
     Rml::DataModelHandle model_handle;
+    std::vector<ProfilerRow> profiler_rows;
+    std::string profiler_status;
+    std::vector<LatencyRow> latency_rows;
+    std::string latency_status;
+    std::string frame_pacing_status;
+    std::string gfx_arena_status;
     std::vector<std::string> area_names;
     std::vector<std::string> scene_names;
     std::vector<std::string> entrance_names; 
@@ -470,6 +500,58 @@ struct DebugContext {
         
         entrance_names = zelda64::game_warps[area_index].scenes[scene_index].entrances;
     }
+
+    void update_profiler_rows() {
+        char buffer[64];
+        profiler_rows.clear();
+        for (const recomputil::ProfileSummary& summary : recomputil::get_profile_summary()) {
+            ProfilerRow& row = profiler_rows.emplace_back();
+            row.name = summary.name;
+            row.category = recomputil::get_profile_category_name(summary.category);
+            snprintf(buffer, sizeof(buffer), "%.1f", double(summary.total_calls) / summary.frame_count);
+            row.calls = buffer;
+            snprintf(buffer, sizeof(buffer), "%.1f us", double(summary.total_ns) / summary.frame_count / 1000.0);
+            row.avg_time = buffer;
+            snprintf(buffer, sizeof(buffer), "%.1f us", summary.max_frame_ns / 1000.0);
+            row.max_time = buffer;
+        }
+    }
+
+    void update_latency_rows() {
+        char buffer[64];
+        latency_rows.clear();
+        for (const zelda64::LatencyStageSummary& summary : zelda64::get_latency_summary()) {
+            LatencyRow& row = latency_rows.emplace_back();
+            row.stage = summary.name;
+            snprintf(buffer, sizeof(buffer), "%.2f ms", summary.min_ms);
+            row.min_time = buffer;
+            snprintf(buffer, sizeof(buffer), "%.2f ms", summary.median_ms);
+            row.median_time = buffer;
+            snprintf(buffer, sizeof(buffer), "%.2f ms", summary.p95_ms);
+            row.p95_time = buffer;
+            snprintf(buffer, sizeof(buffer), "%.2f ms", summary.max_ms);
+            row.max_time = buffer;
+        }
+
+        latency_status = std::to_string(zelda64::get_latency_sample_count()) + " inputs probed";
+    }
+
+    void update_frame_pacing_status() {
+        char buffer[128];
+        zelda64::FramePacingStats stats = zelda64::get_frame_pacing_stats();
+        snprintf(buffer, sizeof(buffer), "%.2f ms +/- %.2f ms (%.1f FPS), sleep overshoot %.0f us, spin %.0f us",
+            stats.mean_frame_ms, stats.frame_stddev_ms, stats.measured_rate, stats.sleep_overshoot_us, stats.spin_margin_us);
+        frame_pacing_status = buffer;
+    }
+
+    void update_gfx_arena_status() {
+        char buffer[160];
+        zelda64::GfxArenaStats stats = zelda64::get_gfx_arena_stats();
+        snprintf(buffer, sizeof(buffer), "Display list %u KiB (peak %u KiB), matrices %u KiB (peak %u KiB), %zu chunks, %zu KiB reserved",
+            stats.frame_dl_bytes / 1024, stats.peak_dl_bytes / 1024, stats.frame_mtx_bytes / 1024, stats.peak_mtx_bytes / 1024,
+            stats.chunk_count, stats.reserved_bytes / 1024);
+        gfx_arena_status = buffer;
+    }
 };
 
 DebugContext debug_context;
@@ -608,6 +690,57 @@ public:
             [](const std::string& param, Rml::Event& event) {
                 zelda64::set_time(debug_context.set_time_day, debug_context.set_time_hour, debug_context.set_time_minute);
             });
+
+        recompui::register_event(listener, "refresh_profiler",
+            [](const std::string& param, Rml::Event& event) {
+                debug_context.update_profiler_rows();
+                debug_context.profiler_status.clear();
+                debug_context.model_handle.DirtyVariable("profiler_rows");
+                debug_context.model_handle.DirtyVariable("profiler_status");
+            });
+
+        recompui::register_event(listener, "export_profiler_csv",
+            [](const std::string& param, Rml::Event& event) {
+                std::filesystem::path csv_path = zelda64::get_app_folder_path() / "mod_profile.csv";
+                if (recomputil::export_profile_csv(csv_path)) {
+                    debug_context.profiler_status = "Saved to " + csv_path.string();
+                }
+                else {
+                    debug_context.profiler_status = "Failed to write " + csv_path.string();
+                }
+                debug_context.model_handle.DirtyVariable("profiler_status");
+            });
+
+        recompui::register_event(listener, "refresh_latency",
+            [](const std::string& param, Rml::Event& event) {
+                debug_context.update_latency_rows();
+                debug_context.model_handle.DirtyVariable("latency_rows");
+                debug_context.model_handle.DirtyVariable("latency_status");
+            });
+
+        recompui::register_event(listener, "refresh_frame_pacing",
+            [](const std::string& param, Rml::Event& event) {
+                debug_context.update_frame_pacing_status();
+                debug_context.model_handle.DirtyVariable("frame_pacing_status");
+            });
+
+        recompui::register_event(listener, "refresh_gfx_arena",
+            [](const std::string& param, Rml::Event& event) {
+                debug_context.update_gfx_arena_status();
+                debug_context.model_handle.DirtyVariable("gfx_arena_status");
+            });
+
+        recompui::register_event(listener, "export_latency_csv",
+            [](const std::string& param, Rml::Event& event) {
+                std::filesystem::path csv_path = zelda64::get_app_folder_path() / "latency.csv";
+                if (zelda64::export_latency_csv(csv_path)) {
+                    debug_context.latency_status = "Saved to " + csv_path.string();
+                }
+                else {
+                    debug_context.latency_status = "Failed to write " + csv_path.string();
+                }
+                debug_context.model_handle.DirtyVariable("latency_status");
+            });
     }
 
     void bind_config_list_events(Rml::DataModelConstructor &constructor) {
@@ -997,6 +1130,53 @@ public:
         constructor.Bind("debug_time_hour", &debug_context.set_time_hour);
         constructor.Bind("debug_time_minute", &debug_context.set_time_minute);
 
+        constructor.BindFunc("profiler_enabled",
+            [](Rml::Variant& out) {
+                out = recomputil::is_profiling_enabled() ? "On" : "Off";
+            },
+            [](const Rml::Variant& in) {
+                recomputil::set_profiling_enabled(in.Get<std::string>() == "On");
+                debug_context.model_handle.DirtyVariable("profiler_enabled");
+            });
+
+        if (Rml::StructHandle<ProfilerRow> row_handle = constructor.RegisterStruct<ProfilerRow>()) {
+            row_handle.RegisterMember("name", &ProfilerRow::name);
+            row_handle.RegisterMember("category", &ProfilerRow::category);
+            row_handle.RegisterMember("calls", &ProfilerRow::calls);
+            row_handle.RegisterMember("avg_time", &ProfilerRow::avg_time);
+            row_handle.RegisterMember("max_time", &ProfilerRow::max_time);
+        }
+        constructor.RegisterArray<std::vector<ProfilerRow>>();
+        constructor.Bind("profiler_rows", &debug_context.profiler_rows);
+        constructor.Bind("profiler_status", &debug_context.profiler_status);
+
+        constructor.BindFunc("latency_probe_enabled",
+            [](Rml::Variant& out) {
+                out = zelda64::is_latency_probe_enabled() ? "On" : "Off";
+            },
+            [](const Rml::Variant& in) {
+                bool enabled = in.Get<std::string>() == "On";
+                // Start every capture from scratch so the results aren't mixed with an older session.
+                if (enabled && !zelda64::is_latency_probe_enabled()) {
+                    zelda64::clear_latency_samples();
+                }
+                zelda64::set_latency_probe_enabled(enabled);
+                debug_context.model_handle.DirtyVariable("latency_probe_enabled");
+            });
+
+        if (Rml::StructHandle<LatencyRow> row_handle = constructor.RegisterStruct<LatencyRow>()) {
+            row_handle.RegisterMember("stage", &LatencyRow::stage);
+            row_handle.RegisterMember("min_time", &LatencyRow::min_time);
+            row_handle.RegisterMember("median_time", &LatencyRow::median_time);
+            row_handle.RegisterMember("p95_time", &LatencyRow::p95_time);
+            row_handle.RegisterMember("max_time", &LatencyRow::max_time);
+        }
+        constructor.RegisterArray<std::vector<LatencyRow>>();
+        constructor.Bind("latency_rows", &debug_context.latency_rows);
+        constructor.Bind("latency_status", &debug_context.latency_status);
+        constructor.Bind("frame_pacing_status", &debug_context.frame_pacing_status);
+        constructor.Bind("gfx_arena_status", &debug_context.gfx_arena_status);
+
         debug_context.model_handle = constructor.GetModelHandle();
     }
 
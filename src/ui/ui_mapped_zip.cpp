@@ -0,0 +1,352 @@
+#include "ui_mapped_zip.h"
+
+#include <cstring>
+
+#include "miniz.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace recompui {
+    static const uint32_t LocalHeaderSignature = 0x04034b50;
+    static const uint32_t CentralHeaderSignature = 0x02014b50;
+    static const uint32_t EndOfCentralDirectorySignature = 0x06054b50;
+    static const uint32_t Zip64EndOfCentralDirectorySignature = 0x06064b50;
+    static const uint32_t Zip64LocatorSignature = 0x07064b50;
+    static const uint16_t Zip64ExtraFieldId = 0x0001;
+    static const uint64_t LocalHeaderSize = 30;
+    static const uint64_t CentralHeaderSize = 46;
+    static const uint64_t EndOfCentralDirectorySize = 22;
+    static const uint64_t Zip64LocatorSize = 20;
+    static const uint64_t Zip64EndOfCentralDirectorySize = 56;
+    static const uint64_t MaxCommentSize = 0xFFFF;
+    static const uint16_t MethodStored = 0;
+    static const uint16_t MethodDeflated = 8;
+    // Deflate can't compress better than about 1032:1, so anything claiming more is damaged.
+    static const uint64_t MaxDeflateRatio = 1032;
+
+    static uint16_t read_u16(const uint8_t *p) {
+        return uint16_t(p[0]) | (uint16_t(p[1]) << 8);
+    }
+
+    static uint32_t read_u32(const uint8_t *p) {
+        return uint32_t(read_u16(p)) | (uint32_t(read_u16(p + 2)) << 16);
+    }
+
+    static uint64_t read_u64(const uint8_t *p) {
+        return uint64_t(read_u32(p)) | (uint64_t(read_u32(p + 4)) << 32);
+    }
+
+    MappedZipArchive::~MappedZipArchive() {
+        close();
+    }
+
+    bool MappedZipArchive::open(const std::filesystem::path &path) {
+        close();
+
+        if (!map_file(path)) {
+            return false;
+        }
+
+        if (!parse_central_directory()) {
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void MappedZipArchive::close() {
+        entries.clear();
+        unmap_file();
+    }
+
+#if defined(_WIN32)
+    bool MappedZipArchive::map_file(const std::filesystem::path &path) {
+        // FILE_SHARE_DELETE lets the installer replace a mod while its archive is still being read.
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+            CloseHandle(file);
+            return false;
+        }
+
+        void *mapped_view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (mapped_view == nullptr) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        file_handle = file;
+        mapping_handle = mapping;
+        view = (const uint8_t *)(mapped_view);
+        view_size = uint64_t(file_size.QuadPart);
+        return true;
+    }
+
+    void MappedZipArchive::unmap_file() {
+        if (view != nullptr) {
+            UnmapViewOfFile(view);
+            CloseHandle(mapping_handle);
+            CloseHandle(file_handle);
+        }
+
+        view = nullptr;
+        view_size = 0;
+        file_handle = nullptr;
+        mapping_handle = nullptr;
+    }
+#else
+    bool MappedZipArchive::map_file(const std::filesystem::path &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+
+        // The mapping stays valid after the descriptor is closed.
+        void *mapped_view = mmap(nullptr, size_t(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped_view == MAP_FAILED) {
+            return false;
+        }
+
+        view = (const uint8_t *)(mapped_view);
+        view_size = uint64_t(file_stat.st_size);
+        return true;
+    }
+
+    void MappedZipArchive::unmap_file() {
+        if (view != nullptr) {
+            munmap((void *)(view), size_t(view_size));
+        }
+
+        view = nullptr;
+        view_size = 0;
+    }
+#endif
+
+    bool MappedZipArchive::parse_central_directory() {
+        if (view_size < EndOfCentralDirectorySize) {
+            return false;
+        }
+
+        // The end of central directory record is followed by a comment of up to 64 KiB, so search backwards for it.
+        uint64_t search_start = (view_size > EndOfCentralDirectorySize + MaxCommentSize) ? (view_size - EndOfCentralDirectorySize - MaxCommentSize) : 0;
+        uint64_t eocd_offset = UINT64_MAX;
+        for (uint64_t offset = view_size - EndOfCentralDirectorySize + 1; offset-- > search_start;) {
+            if (read_u32(view + offset) == EndOfCentralDirectorySignature) {
+                eocd_offset = offset;
+                break;
+            }
+        }
+
+        if (eocd_offset == UINT64_MAX) {
+            return false;
+        }
+
+        const uint8_t *eocd = view + eocd_offset;
+        uint64_t entry_count = read_u16(eocd + 10);
+        uint64_t directory_size = read_u32(eocd + 12);
+        uint64_t directory_offset = read_u32(eocd + 16);
+
+        // Texture packs easily go past 4 GiB, in which case the real values are in the zip64 record.
+        if ((entry_count == 0xFFFF || directory_size == 0xFFFFFFFF || directory_offset == 0xFFFFFFFF) && eocd_offset >= Zip64LocatorSize) {
+            const uint8_t *locator = eocd - Zip64LocatorSize;
+            if (read_u32(locator) == Zip64LocatorSignature) {
+                uint64_t zip64_offset = read_u64(locator + 8);
+                if (view_size < Zip64EndOfCentralDirectorySize || zip64_offset > view_size - Zip64EndOfCentralDirectorySize) {
+                    return false;
+                }
+
+                const uint8_t *zip64_eocd = view + zip64_offset;
+                if (read_u32(zip64_eocd) != Zip64EndOfCentralDirectorySignature) {
+                    return false;
+                }
+
+                entry_count = read_u64(zip64_eocd + 32);
+                directory_size = read_u64(zip64_eocd + 40);
+                directory_offset = read_u64(zip64_eocd + 48);
+            }
+        }
+
+        if (directory_offset > view_size || directory_size > view_size - directory_offset) {
+            return false;
+        }
+
+        // Every entry takes at least a fixed-size header in the directory, which bounds how many there can be before
+        // anything gets allocated for them.
+        if (entry_count > directory_size / CentralHeaderSize) {
+            return false;
+        }
+
+        entries.reserve(size_t(entry_count));
+
+        const uint8_t *cursor = view + directory_offset;
+        const uint8_t *directory_end = cursor + directory_size;
+        for (uint64_t i = 0; i < entry_count; i++) {
+            if (uint64_t(directory_end - cursor) < CentralHeaderSize || read_u32(cursor) != CentralHeaderSignature) {
+                return false;
+            }
+
+            uint16_t name_length = read_u16(cursor + 28);
+            uint16_t extra_length = read_u16(cursor + 30);
+            uint16_t comment_length = read_u16(cursor + 32);
+            uint64_t header_size = CentralHeaderSize + name_length + extra_length + comment_length;
+            if (uint64_t(directory_end - cursor) < header_size) {
+                return false;
+            }
+
+            Entry entry;
+            entry.method = read_u16(cursor + 10);
+            entry.crc32 = read_u32(cursor + 16);
+            entry.compressed_size = read_u32(cursor + 20);
+            entry.uncompressed_size = read_u32(cursor + 24);
+            entry.local_header_offset = read_u32(cursor + 42);
+
+            // The zip64 extra field only holds the values that didn't fit, in this order.
+            const uint8_t *extra = cursor + CentralHeaderSize + name_length;
+            const uint8_t *extra_end = extra + extra_length;
+            while (extra_end - extra >= 4) {
+                uint16_t field_id = read_u16(extra);
+                uint16_t field_size = read_u16(extra + 2);
+                const uint8_t *field = extra + 4;
+                if (extra_end - field < field_size) {
+                    break;
+                }
+
+                if (field_id == Zip64ExtraFieldId) {
+                    const uint8_t *field_end = field + field_size;
+                    uint64_t *values[] = { &entry.uncompressed_size, &entry.compressed_size, &entry.local_header_offset };
+                    for (uint64_t *value : values) {
+                        if (*value == 0xFFFFFFFF && field_end - field >= 8) {
+                            *value = read_u64(field);
+                            field += 8;
+                        }
+                    }
+                }
+
+                extra += 4 + field_size;
+            }
+
+            std::string name((const char *)(cursor + CentralHeaderSize), name_length);
+            entries.emplace(std::move(name), entry);
+            cursor += header_size;
+        }
+
+        return true;
+    }
+
+    bool MappedZipArchive::get_entry_data(const Entry &entry, std::span<const char> &data) const {
+        // The name and extra field lengths in the local header can differ from the central directory's, so the
+        // position of the data has to come from the local header.
+        if (entry.local_header_offset > view_size - LocalHeaderSize) {
+            return false;
+        }
+
+        const uint8_t *local_header = view + entry.local_header_offset;
+        if (read_u32(local_header) != LocalHeaderSignature) {
+            return false;
+        }
+
+        uint64_t data_offset = entry.local_header_offset + LocalHeaderSize + read_u16(local_header + 26) + read_u16(local_header + 28);
+        if (data_offset > view_size || entry.compressed_size > view_size - data_offset) {
+            return false;
+        }
+
+        data = std::span<const char>((const char *)(view + data_offset), size_t(entry.compressed_size));
+        return true;
+    }
+
+    bool MappedZipArchive::contains(const std::string &filename) const {
+        return entries.find(filename) != entries.end();
+    }
+
+    bool MappedZipArchive::read_file(const std::string &filename, std::span<const char> &data, std::vector<char> &storage) const {
+        auto it = entries.find(filename);
+        if (it == entries.end()) {
+            return false;
+        }
+
+        const Entry &entry = it->second;
+        if (entry.uncompressed_size > MaxReadSize) {
+            return false;
+        }
+
+        std::span<const char> compressed_data;
+        if (!get_entry_data(entry, compressed_data)) {
+            return false;
+        }
+
+        if (entry.method == MethodStored) {
+            if (entry.compressed_size != entry.uncompressed_size) {
+                return false;
+            }
+
+            data = compressed_data;
+            return true;
+        }
+        else if (entry.method == MethodDeflated) {
+            if (entry.uncompressed_size == 0) {
+                storage.clear();
+                data = std::span<const char>();
+                return true;
+            }
+
+            if (entry.uncompressed_size > entry.compressed_size * MaxDeflateRatio) {
+                return false;
+            }
+
+            storage.resize(size_t(entry.uncompressed_size));
+            size_t inflated_size = tinfl_decompress_mem_to_mem(storage.data(), storage.size(), compressed_data.data(), compressed_data.size(), 0);
+            if (inflated_size != storage.size() || mz_crc32(MZ_CRC32_INIT, (const unsigned char *)(storage.data()), storage.size()) != entry.crc32) {
+                storage.clear();
+                return false;
+            }
+
+            data = std::span<const char>(storage.data(), storage.size());
+            return true;
+        }
+
+        return false;
+    }
+
+    bool MappedZipArchive::read_file(const std::string &filename, std::vector<char> &bytes) const {
+        std::span<const char> data;
+        std::vector<char> storage;
+        if (!read_file(filename, data, storage)) {
+            return false;
+        }
+
+        if (data.data() == storage.data()) {
+            bytes = std::move(storage);
+        }
+        else {
+            bytes.assign(data.begin(), data.end());
+        }
+
+        return true;
+    }
+};
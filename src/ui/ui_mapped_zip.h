@@ -0,0 +1,66 @@
+#ifndef RECOMPUI_MAPPED_ZIP_H
+#define RECOMPUI_MAPPED_ZIP_H
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace recompui {
+    // Read-only zip reader that maps the whole archive into memory and indexes its central directory once when opened.
+    // Stored entries are returned as spans that point straight into the mapping, so reading them never allocates or
+    // copies anything. Only deflated entries are inflated into a buffer. Meant for mod containers like .rtz texture
+    // packs, where most entries are already-compressed images that are stored as-is.
+    class MappedZipArchive {
+    public:
+        struct Entry {
+            uint64_t local_header_offset;
+            uint64_t compressed_size;
+            uint64_t uncompressed_size;
+            uint32_t crc32;
+            uint16_t method;
+        };
+
+        // Largest file read_file returns. It's only used for manifests and thumbnails, which are far smaller, and a
+        // damaged or malicious archive can claim any size in its headers.
+        static constexpr uint64_t MaxReadSize = 32 * 1024 * 1024;
+
+        MappedZipArchive() = default;
+        ~MappedZipArchive();
+        MappedZipArchive(const MappedZipArchive &) = delete;
+        MappedZipArchive &operator=(const MappedZipArchive &) = delete;
+
+        bool open(const std::filesystem::path &path);
+        void close();
+        bool is_open() const { return view != nullptr; }
+
+        bool contains(const std::string &filename) const;
+        const std::unordered_map<std::string, Entry> &get_entries() const { return entries; }
+
+        // Returns the contents of a file. For stored entries the span points into the mapping and storage is left
+        // untouched, otherwise the file is inflated into storage, checked against its CRC, and the span points there.
+        // The span is only valid while the archive is open and storage isn't modified. Files larger than MaxReadSize
+        // are rejected.
+        bool read_file(const std::string &filename, std::span<const char> &data, std::vector<char> &storage) const;
+
+        // Convenience for callers that need to own the bytes anyway.
+        bool read_file(const std::string &filename, std::vector<char> &bytes) const;
+    private:
+        const uint8_t *view = nullptr;
+        uint64_t view_size = 0;
+#if defined(_WIN32)
+        void *file_handle = nullptr;
+        void *mapping_handle = nullptr;
+#endif
+        std::unordered_map<std::string, Entry> entries;
+
+        bool map_file(const std::filesystem::path &path);
+        void unmap_file();
+        bool parse_central_directory();
+        bool get_entry_data(const Entry &entry, std::span<const char> &data) const;
+    };
+};
+
+#endif
@@ -0,0 +1,386 @@
+#include "ui_mod_index.h"
+#include "ui_mapped_zip.h"
+#include "zelda_config.h"
+#include "recomp_ui.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "json/json.hpp"
+#include "librecomp/mods.hpp"
+
+namespace recompui {
+    static const std::string ManifestFilename = "mod.json";
+    static const char *TextureDatabaseFilename = "rt64.json";
+    static const char *CodeFilename = "mod_binary.bin";
+    static const char *ThumbnailFilenames[] = { "thumb.dds", "thumb.png" };
+    static const std::u8string TemporaryExtension = u8".tmp";
+    static const int ModIndexVersion = 1;
+
+    static std::filesystem::path get_mod_index_path() {
+        return zelda64::get_app_folder_path() / "cache" / "mod_index.json";
+    }
+
+    static int64_t get_write_time(const std::filesystem::path &path, std::error_code &ec) {
+        return std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    }
+
+    // Extensions of the container formats registered with the runtime. Mods in the runtime's own format are always
+    // scanned, every other format is added by register_mod_index_container_type alongside its runtime registration.
+    static std::vector<std::filesystem::path> mod_file_extensions = { ".nrm" };
+
+    static bool is_mod_file(const std::filesystem::path &path) {
+        return std::find(mod_file_extensions.begin(), mod_file_extensions.end(), path.extension()) != mod_file_extensions.end();
+    }
+
+    // Reads the manifest and the list of contents of a mod. Mods that fail to parse are still kept in the index with
+    // an empty mod ID so they aren't opened again until they change. The archive is mapped instead of going through
+    // the runtime's file handle, so only the central directory and the manifest are ever paged in, even for large
+    // texture packs.
+    static void parse_mod_file(ModIndexEntry &entry) {
+        MappedZipArchive archive;
+        if (!archive.open(entry.path)) {
+            return;
+        }
+
+        std::vector<char> manifest_bytes;
+        if (!archive.read_file(ManifestFilename, manifest_bytes)) {
+            return;
+        }
+
+        std::string error;
+        recomp::mods::ModManifest manifest;
+        if (parse_manifest(manifest, manifest_bytes, error) != recomp::mods::ModOpenError::Good) {
+            return;
+        }
+
+        entry.mod_id = manifest.mod_id;
+        entry.display_name = manifest.display_name;
+        entry.version = manifest.version.to_string();
+        entry.has_code = archive.contains(CodeFilename);
+        entry.has_texture_pack = archive.contains(TextureDatabaseFilename);
+        for (const char *thumbnail_filename : ThumbnailFilenames) {
+            if (archive.contains(thumbnail_filename)) {
+                entry.thumbnail_file = thumbnail_filename;
+                break;
+            }
+        }
+    }
+
+    static std::vector<ModIndexEntry> read_mod_index(const std::filesystem::path &path) {
+        std::vector<ModIndexEntry> entries;
+        std::ifstream stream(path);
+        if (!stream.good()) {
+            return entries;
+        }
+
+        try {
+            nlohmann::json json = nlohmann::json::parse(stream);
+            if (json.at("version").get<int>() != ModIndexVersion) {
+                return entries;
+            }
+
+            for (const nlohmann::json &mod_json : json.at("mods")) {
+                ModIndexEntry &entry = entries.emplace_back();
+                entry.path = std::filesystem::path(std::u8string(reinterpret_cast<const char8_t *>(mod_json.at("path").get<std::string>().c_str())));
+                entry.file_size = mod_json.at("size").get<uint64_t>();
+                entry.write_time = mod_json.at("write_time").get<int64_t>();
+                entry.mod_id = mod_json.at("mod_id").get<std::string>();
+                entry.display_name = mod_json.at("display_name").get<std::string>();
+                entry.version = mod_json.at("version").get<std::string>();
+                entry.thumbnail_file = mod_json.at("thumbnail").get<std::string>();
+                entry.has_code = mod_json.at("has_code").get<bool>();
+                entry.has_texture_pack = mod_json.at("has_texture_pack").get<bool>();
+            }
+        }
+        catch (const nlohmann::json::exception &) {
+            // A broken index just means every mod gets parsed again.
+            entries.clear();
+        }
+
+        return entries;
+    }
+
+    static void write_mod_index(const std::filesystem::path &path, const std::vector<ModIndexEntry> &entries) {
+        nlohmann::json mods_json = nlohmann::json::array();
+        for (const ModIndexEntry &entry : entries) {
+            std::u8string path_u8 = entry.path.u8string();
+            mods_json.push_back({
+                { "path", std::string(path_u8.begin(), path_u8.end()) },
+                { "size", entry.file_size },
+                { "write_time", entry.write_time },
+                { "mod_id", entry.mod_id },
+                { "display_name", entry.display_name },
+                { "version", entry.version },
+                { "thumbnail", entry.thumbnail_file },
+                { "has_code", entry.has_code },
+                { "has_texture_pack", entry.has_texture_pack },
+            });
+        }
+
+        nlohmann::json json = { { "version", ModIndexVersion }, { "mods", mods_json } };
+
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+
+        // Write to a temporary file first so an interrupted write never leaves a truncated index behind.
+        std::filesystem::path temporary_path = path;
+        temporary_path += TemporaryExtension;
+        {
+            std::ofstream stream(temporary_path);
+            stream << json.dump();
+            if (!stream.good()) {
+                stream.close();
+                std::filesystem::remove(temporary_path, ec);
+                return;
+            }
+        }
+
+        std::filesystem::rename(temporary_path, path, ec);
+        if (ec) {
+            std::filesystem::remove(temporary_path, ec);
+        }
+    }
+
+    static void parse_mod_files_parallel(std::vector<ModIndexEntry> &entries, const std::vector<size_t> &stale_indices) {
+        if (stale_indices.empty()) {
+            return;
+        }
+
+        // Parsing is mostly waiting on decompression and the disk, so every core gets a worker.
+        size_t worker_count = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), stale_indices.size());
+        std::atomic<size_t> next_index = 0;
+        auto worker_func = [&]() {
+            size_t i;
+            while ((i = next_index.fetch_add(1)) < stale_indices.size()) {
+                // An exception escaping a worker would terminate the process, so a mod that fails to parse for any
+                // reason is just left without a manifest.
+                try {
+                    parse_mod_file(entries[stale_indices[i]]);
+                }
+                catch (const std::exception &) {
+                    entries[stale_indices[i]].mod_id.clear();
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(worker_count - 1);
+        for (size_t i = 1; i < worker_count; i++) {
+            workers.emplace_back(worker_func);
+        }
+
+        // The refresh thread does its share of the work too.
+        worker_func();
+
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Size and modification time of every mod file by path, which is what decides whether the runtime has to scan the
+    // mods folder again.
+    using ModFileSet = std::map<std::u8string, std::pair<uint64_t, int64_t>>;
+
+    class ModIndex {
+    private:
+        std::mutex entries_mutex;
+        std::vector<ModIndexEntry> entries;
+        std::unordered_map<std::string, size_t> mod_id_to_entry;
+        std::mutex refresh_mutex;
+        std::thread refresh_thread;
+        bool refresh_running = false;
+        bool refresh_pending = false;
+        bool shutting_down = false;
+        // The mod files as of the last time the runtime scanned them. The first refresh happens after the runtime's
+        // own scan at startup, so its results are taken as scanned.
+        std::optional<ModFileSet> scanned_files;
+        std::function<void()> changed_callback;
+
+        // Returns whether the mod files differ from the ones the runtime last scanned.
+        bool refresh_once(const std::filesystem::path &mods_directory) {
+            std::filesystem::path index_path = get_mod_index_path();
+            std::vector<ModIndexEntry> cached_entries = read_mod_index(index_path);
+            std::unordered_map<std::u8string, size_t> path_to_cached_entry;
+            for (size_t i = 0; i < cached_entries.size(); i++) {
+                path_to_cached_entry[cached_entries[i].path.u8string()] = i;
+            }
+
+            std::vector<ModIndexEntry> new_entries;
+            std::vector<size_t> stale_indices;
+            ModFileSet files;
+            std::error_code ec;
+            for (const std::filesystem::directory_entry &dir_entry : std::filesystem::directory_iterator(mods_directory, ec)) {
+                if (!dir_entry.is_regular_file(ec) || !is_mod_file(dir_entry.path())) {
+                    continue;
+                }
+
+                uint64_t file_size = dir_entry.file_size(ec);
+                int64_t write_time = get_write_time(dir_entry.path(), ec);
+                files[dir_entry.path().u8string()] = { file_size, write_time };
+                auto cached_it = path_to_cached_entry.find(dir_entry.path().u8string());
+                if (cached_it != path_to_cached_entry.end()) {
+                    const ModIndexEntry &cached_entry = cached_entries[cached_it->second];
+                    if (cached_entry.file_size == file_size && cached_entry.write_time == write_time) {
+                        new_entries.emplace_back(cached_entry);
+                        continue;
+                    }
+                }
+
+                stale_indices.emplace_back(new_entries.size());
+                new_entries.emplace_back(ModIndexEntry{ .path = dir_entry.path(), .file_size = file_size, .write_time = write_time });
+            }
+
+            parse_mod_files_parallel(new_entries, stale_indices);
+
+            // Only rewrite the index if something actually changed.
+            if (!stale_indices.empty() || new_entries.size() != cached_entries.size()) {
+                write_mod_index(index_path, new_entries);
+            }
+
+            {
+                std::lock_guard lock{ entries_mutex };
+                entries = std::move(new_entries);
+                mod_id_to_entry.clear();
+                for (size_t i = 0; i < entries.size(); i++) {
+                    if (!entries[i].mod_id.empty()) {
+                        mod_id_to_entry[entries[i].mod_id] = i;
+                    }
+                }
+            }
+
+            std::lock_guard lock{ refresh_mutex };
+            if (!scanned_files.has_value()) {
+                scanned_files = std::move(files);
+                return false;
+            }
+
+            if (files == *scanned_files) {
+                return false;
+            }
+
+            scanned_files = std::move(files);
+            return true;
+        }
+
+        void refresh_thread_func(std::filesystem::path mods_directory) {
+            while (true) {
+                if (refresh_once(mods_directory)) {
+                    std::function<void()> callback;
+                    {
+                        std::lock_guard lock{ refresh_mutex };
+                        if (!shutting_down) {
+                            callback = changed_callback;
+                        }
+                    }
+
+                    if (callback) {
+                        callback();
+                    }
+                }
+
+                // Refreshes requested while this one was running are folded into a single extra pass.
+                std::lock_guard lock{ refresh_mutex };
+                if (!refresh_pending || shutting_down) {
+                    refresh_running = false;
+                    return;
+                }
+
+                refresh_pending = false;
+            }
+        }
+    public:
+        ~ModIndex() {
+            wait();
+        }
+
+        void refresh() {
+            std::lock_guard lock{ refresh_mutex };
+            if (shutting_down) {
+                return;
+            }
+
+            if (refresh_running) {
+                refresh_pending = true;
+                return;
+            }
+
+            // The previous thread has already finished its work at this point, so this doesn't block.
+            if (refresh_thread.joinable()) {
+                refresh_thread.join();
+            }
+
+            refresh_running = true;
+            refresh_thread = std::thread([this](std::filesystem::path mods_directory) { refresh_thread_func(mods_directory); }, recomp::mods::get_mods_directory());
+        }
+
+        void set_changed_callback(std::function<void()> callback) {
+            std::lock_guard lock{ refresh_mutex };
+            changed_callback = std::move(callback);
+        }
+
+        void wait() {
+            std::thread finishing_thread;
+            {
+                std::lock_guard lock{ refresh_mutex };
+                shutting_down = true;
+                refresh_pending = false;
+                finishing_thread = std::move(refresh_thread);
+            }
+
+            if (finishing_thread.joinable()) {
+                finishing_thread.join();
+            }
+        }
+
+        bool find(const std::string &mod_id, ModIndexEntry &entry) {
+            std::lock_guard lock{ entries_mutex };
+            auto it = mod_id_to_entry.find(mod_id);
+            if (it == mod_id_to_entry.end()) {
+                return false;
+            }
+
+            entry = entries[it->second];
+            return true;
+        }
+    };
+
+    static ModIndex mod_index;
+
+    void register_mod_index_container_type(const std::string &extension) {
+        mod_file_extensions.emplace_back("." + extension);
+    }
+
+    void refresh_mod_index() {
+        mod_index.refresh();
+    }
+
+    void set_mod_index_changed_callback(std::function<void()> callback) {
+        mod_index.set_changed_callback(std::move(callback));
+    }
+
+    bool find_mod_index_entry(const std::string &mod_id, ModIndexEntry &entry) {
+        return mod_index.find(mod_id, entry);
+    }
+
+    bool read_mod_index_file(const ModIndexEntry &entry, const std::string &filename, std::vector<char> &bytes) {
+        MappedZipArchive archive;
+        if (!archive.open(entry.path)) {
+            return false;
+        }
+
+        return archive.read_file(filename, bytes);
+    }
+
+    void wait_for_mod_index() {
+        mod_index.wait();
+    }
+};
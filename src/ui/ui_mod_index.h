@@ -0,0 +1,45 @@
+#ifndef RECOMPUI_MOD_INDEX_H
+#define RECOMPUI_MOD_INDEX_H
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace recompui {
+    // What the mod index knows about a mod file without having to open it again.
+    struct ModIndexEntry {
+        std::filesystem::path path;
+        uint64_t file_size = 0;
+        int64_t write_time = 0;
+        std::string mod_id;
+        std::string display_name;
+        std::string version;
+        // Name of the thumbnail inside the mod's archive, or empty if the mod doesn't have one.
+        std::string thumbnail_file;
+        bool has_code = false;
+        bool has_texture_pack = false;
+    };
+
+    // Rescans the mods folder on a background thread. Entries whose path, size and modification time match the
+    // on-disk index are reused as-is, while new or modified mods are parsed in parallel. A refresh requested while
+    // another is running is queued behind it instead of waiting for it.
+    void refresh_mod_index();
+
+    // Sets the function the refresh thread calls when it finds mod files that were added, removed or modified since
+    // the last time it was called, which is when the runtime needs to scan the mods folder again.
+    void set_mod_index_changed_callback(std::function<void()> callback);
+
+    // Looks up a mod in the index. Returns false if the mod isn't indexed yet, in which case the caller is expected to
+    // go through the runtime instead. The results of the previous refresh are used while a new one is in progress.
+    bool find_mod_index_entry(const std::string &mod_id, ModIndexEntry &entry);
+
+    // Reads a file from an indexed mod's archive. Safe to call from any thread.
+    bool read_mod_index_file(const ModIndexEntry &entry, const std::string &filename, std::vector<char> &bytes);
+
+    // Waits for any refresh that's in progress and stops further refreshes. Must be called before shutting down.
+    void wait_for_mod_index();
+};
+
+#endif
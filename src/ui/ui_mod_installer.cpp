@@ -1,5 +1,14 @@
 #include "ui_mod_installer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
 #include "librecomp/mods.hpp"
 
 namespace recompui {
@@ -20,11 +29,277 @@ namespace recompui {
 #endif
     }
 
-    size_t zip_write_func(void *opaque, mz_uint64 offset, const void *bytes, size_t count) {
-        std::ofstream &stream = *(std::ofstream *)(opaque);
-        stream.seekp(offset, std::ios::beg);
-        stream.write((const char *)(bytes), count);
-        return stream.bad() ? 0 : count;
+    // Installed files are written in large sequential chunks instead of one write per block that miniz inflates, which
+    // keeps the disk busy while the decompression runs on other cores.
+    static const size_t WriteBufferSize = 4 * 1024 * 1024;
+
+    // How often progress is reported while files are being installed.
+    static const std::chrono::milliseconds ProgressInterval(50);
+
+    // Writes a file sequentially through a large buffer. The buffer is owned by the caller so that a worker can reuse
+    // it for every file it writes.
+    class InstallFileWriter {
+    private:
+        std::ofstream stream;
+        std::vector<char> &buffer;
+        size_t buffer_used = 0;
+        uint64_t bytes_written = 0;
+
+        bool flush() {
+            if (buffer_used > 0) {
+                stream.write(buffer.data(), buffer_used);
+                buffer_used = 0;
+            }
+
+            return !stream.bad();
+        }
+    public:
+        InstallFileWriter(std::vector<char> &buffer) : buffer(buffer) {
+        }
+
+        bool open(const std::filesystem::path &path) {
+            stream.open(path, std::ios::binary | std::ios::trunc);
+            return stream.is_open();
+        }
+
+        bool write(const void *bytes, size_t count) {
+            bytes_written += count;
+
+            // Chunks that don't fit in the buffer skip it entirely to avoid a pointless copy.
+            if (buffer_used + count > buffer.size()) {
+                if (!flush()) {
+                    return false;
+                }
+
+                if (count >= buffer.size()) {
+                    stream.write((const char *)(bytes), count);
+                    return !stream.bad();
+                }
+            }
+
+            memcpy(buffer.data() + buffer_used, bytes, count);
+            buffer_used += count;
+            return true;
+        }
+
+        bool close() {
+            bool flushed = flush();
+            stream.close();
+            return flushed && !stream.fail();
+        }
+
+        uint64_t get_size() const {
+            return bytes_written;
+        }
+    };
+
+    // A reader for the source archive. Each extraction worker needs its own because an mz_zip_archive can't be read from
+    // several threads at once.
+    class InstallArchiveReader {
+    private:
+        std::ifstream stream;
+        mz_zip_archive archive;
+
+        static size_t read_func(void *opaque, mz_uint64 offset, void *bytes, size_t count) {
+            std::ifstream &stream = *(std::ifstream *)(opaque);
+            stream.clear();
+            stream.seekg(offset, std::ios::beg);
+            stream.read((char *)(bytes), count);
+            return size_t(stream.gcount());
+        }
+    public:
+        InstallArchiveReader() {
+            mz_zip_zero_struct(&archive);
+        }
+
+        ~InstallArchiveReader() {
+            mz_zip_reader_end(&archive);
+        }
+
+        bool open(const std::filesystem::path &path) {
+            std::error_code ec;
+            uint64_t file_size = std::filesystem::file_size(path, ec);
+            if (ec) {
+                return false;
+            }
+
+            stream.open(path, std::ios::binary);
+            if (!stream.is_open()) {
+                return false;
+            }
+
+            archive.m_pRead = &read_func;
+            archive.m_pIO_opaque = &stream;
+            return mz_zip_reader_init(&archive, file_size, 0);
+        }
+
+        mz_zip_archive *get() {
+            return &archive;
+        }
+    };
+
+    enum class ExtractionStatus {
+        Pending,
+        Success,
+        WriteFailed,
+        ExtractFailed,
+        Corrupted
+    };
+
+    struct ExtractionJob {
+        mz_uint file_index;
+        std::filesystem::path target_path;
+        std::filesystem::path target_write_path;
+        uint64_t size;
+        ExtractionStatus status = ExtractionStatus::Pending;
+    };
+
+    struct ExtractionStream {
+        InstallFileWriter &writer;
+        std::atomic<uint64_t> &bytes_done;
+    };
+
+    static size_t extraction_write_func(void *opaque, mz_uint64 offset, const void *bytes, size_t count) {
+        ExtractionStream &stream = *(ExtractionStream *)(opaque);
+
+        // Entries are always inflated in order, so anything but the next offset means the data can't be trusted.
+        if (offset != stream.writer.get_size() || !stream.writer.write(bytes, count)) {
+            return 0;
+        }
+
+        stream.bytes_done.fetch_add(count, std::memory_order_relaxed);
+        return count;
+    }
+
+    static ExtractionStatus extract_entry(mz_zip_archive *zip_archive, const ExtractionJob &job, std::vector<char> &write_buffer, std::atomic<uint64_t> &bytes_done) {
+        InstallFileWriter writer(write_buffer);
+        if (!writer.open(job.target_write_path)) {
+            return ExtractionStatus::WriteFailed;
+        }
+
+        // miniz checks the size and CRC-32 of the inflated data against the archive on its own.
+        ExtractionStream stream{ writer, bytes_done };
+        bool extracted = mz_zip_reader_extract_to_callback(zip_archive, job.file_index, &extraction_write_func, &stream, 0);
+        if (!writer.close()) {
+            return ExtractionStatus::WriteFailed;
+        }
+        else if (!extracted) {
+            mz_zip_error error = mz_zip_get_last_error(zip_archive);
+            if (error == MZ_ZIP_CRC_CHECK_FAILED || error == MZ_ZIP_UNEXPECTED_DECOMPRESSED_SIZE) {
+                return ExtractionStatus::Corrupted;
+            }
+
+            return ExtractionStatus::ExtractFailed;
+        }
+
+        return ExtractionStatus::Success;
+    }
+
+    // Extracts all the jobs in parallel, with each worker reading the archive through its own handle. Returns once every
+    // job has a status. Progress is reported from the calling thread so the callback never has to be thread-safe.
+    static void extract_entries_parallel(const std::filesystem::path &path, std::vector<ExtractionJob> &jobs, std::function<void(std::filesystem::path, size_t, size_t)> progress_callback) {
+        if (jobs.empty()) {
+            return;
+        }
+
+        // Start with the largest entries so a big texture pack isn't left for last while every other worker sits idle.
+        std::vector<size_t> job_order(jobs.size());
+        for (size_t i = 0; i < jobs.size(); i++) {
+            job_order[i] = i;
+        }
+
+        std::stable_sort(job_order.begin(), job_order.end(), [&](size_t a, size_t b) { return jobs[a].size > jobs[b].size; });
+
+        uint64_t total_bytes = 0;
+        for (const ExtractionJob &job : jobs) {
+            total_bytes += job.size;
+        }
+
+        size_t worker_count = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), jobs.size());
+        std::atomic<size_t> next_job = 0;
+        std::atomic<uint64_t> bytes_done = 0;
+        std::mutex workers_mutex;
+        std::condition_variable workers_finished;
+        size_t workers_running = worker_count;
+        auto worker_func = [&]() {
+            InstallArchiveReader reader;
+            bool reader_open = reader.open(path);
+            std::vector<char> write_buffer(WriteBufferSize);
+            size_t i;
+            while ((i = next_job.fetch_add(1)) < jobs.size()) {
+                ExtractionJob &job = jobs[job_order[i]];
+                job.status = reader_open ? extract_entry(reader.get(), job, write_buffer, bytes_done) : ExtractionStatus::ExtractFailed;
+            }
+
+            std::lock_guard lock{ workers_mutex };
+            workers_running--;
+            workers_finished.notify_all();
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(worker_count);
+        for (size_t i = 0; i < worker_count; i++) {
+            workers.emplace_back(worker_func);
+        }
+
+        {
+            std::unique_lock lock{ workers_mutex };
+            while (!workers_finished.wait_for(lock, ProgressInterval, [&]() { return workers_running == 0; })) {
+                if (progress_callback) {
+                    lock.unlock();
+                    progress_callback(path, bytes_done.load(std::memory_order_relaxed), total_bytes);
+                    lock.lock();
+                }
+            }
+        }
+
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+
+        if (progress_callback) {
+            progress_callback(path, total_bytes, total_bytes);
+        }
+    }
+
+    // Copies a file through the install writer so progress can be reported along the way.
+    static bool copy_file_with_progress(const std::filesystem::path &source_path, const std::filesystem::path &target_path, std::function<void(std::filesystem::path, size_t, size_t)> progress_callback) {
+        std::error_code ec;
+        uint64_t total_bytes = std::filesystem::file_size(source_path, ec);
+        if (ec) {
+            return false;
+        }
+
+        std::ifstream input_stream(source_path, std::ios::binary);
+        std::vector<char> write_buffer(WriteBufferSize);
+        InstallFileWriter writer(write_buffer);
+        if (!input_stream.is_open() || !writer.open(target_path)) {
+            return false;
+        }
+
+        std::vector<char> buffer(WriteBufferSize);
+        auto last_report = std::chrono::steady_clock::now();
+        while (writer.get_size() < total_bytes) {
+            input_stream.read(buffer.data(), buffer.size());
+            size_t count = size_t(input_stream.gcount());
+            if ((count == 0) || !writer.write(buffer.data(), count)) {
+                writer.close();
+                return false;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_report >= ProgressInterval) {
+                progress_callback(source_path, writer.get_size(), total_bytes);
+                last_report = now;
+            }
+        }
+
+        if (!writer.close()) {
+            return false;
+        }
+
+        progress_callback(source_path, total_bytes, total_bytes);
+        return true;
     }
 
     void start_single_mod_installation(const std::filesystem::path &file_path, recomp::mods::ZipModFileHandle &file_handle, std::function<void(std::filesystem::path, size_t, size_t)> progress_callback, ModInstaller::Result &result) {
@@ -63,8 +338,18 @@ namespace recompui {
 
         std::error_code ec;
         if (exists) {
-            std::filesystem::copy(file_path, target_write_path, ec);
-            if (ec) {
+            // Without a progress callback the copy is left to the OS, which can use its own fast paths for it.
+            bool copied;
+            if (progress_callback) {
+                copied = copy_file_with_progress(file_path, target_write_path, progress_callback);
+            }
+            else {
+                std::filesystem::copy(file_path, target_write_path, ec);
+                copied = !ec;
+            }
+
+            if (!copied) {
+                std::filesystem::remove(target_write_path, ec);
                 result.error_messages.emplace_back("Unable to install " + file_path.filename().string() + " to mod directory.");
                 return;
             }
@@ -101,6 +386,10 @@ namespace recompui {
         std::list<std::filesystem::path> dynamic_lib_files;
         std::list<ModInstaller::Installation>::iterator first_nrm_iterator = result.pending_installations.end();
         bool found_mod = false;
+
+        // Collect every entry that needs to be extracted first so they can all be extracted at once.
+        std::vector<ExtractionJob> jobs;
+        std::unordered_set<std::u8string> job_targets;
         for (mz_uint i = 0; i < num_files; i++) {
             mz_uint filename_length = mz_zip_reader_get_filename(zip_archive, i, filename, sizeof(filename));
             if (filename_length == 0) {
@@ -108,121 +397,124 @@ namespace recompui {
             }
 
             std::filesystem::path target_path = mods_directory / std::u8string_view((const char8_t *)(filename));
-            if ((target_path.extension() == ".rtz") || (target_path.extension() == ".nrm")) {
-                found_mod = true;
-                ModInstaller::Installation installation;
-                std::filesystem::path target_write_path = target_path.u8string() + NewExtension;
-                std::ofstream output_stream(target_write_path, std::ios::binary);
-                if (!output_stream.is_open()) {
-                    result.error_messages.emplace_back("Unable to write to mod directory.");
-                    continue;
-                }
+            bool is_mod = (target_path.extension() == ".rtz") || (target_path.extension() == ".nrm");
+            if (!is_mod && !is_dynamic_lib(target_path)) {
+                continue;
+            }
 
-                if (!mz_zip_reader_extract_to_callback(zip_archive, i, &zip_write_func, &output_stream, 0)) {
-                    output_stream.close();
-                    std::filesystem::remove(target_write_path, ec);
-                    result.error_messages.emplace_back("Failed to install " + path.filename().string() + " to mod directory.");
-                    continue;
-                }
+            found_mod = found_mod || is_mod;
 
-                output_stream.close();
-                if (output_stream.bad()) {
-                    std::filesystem::remove(target_write_path, ec);
-                    result.error_messages.emplace_back("Failed to install " + path.filename().string() + " to mod directory.");
-                    continue;
-                }
+            mz_zip_archive_file_stat file_stat;
+            if (!mz_zip_reader_file_stat(zip_archive, i, &file_stat)) {
+                result.error_messages.emplace_back("Failed to install " + path.filename().string() + " to mod directory.");
+                continue;
+            }
 
-                // Try to load the extracted file as a mod file handle.
-                recomp::mods::ModOpenError open_error;
-                std::unique_ptr<recomp::mods::ZipModFileHandle> extracted_file_handle = std::make_unique<recomp::mods::ZipModFileHandle>(target_write_path, open_error);
-                if (open_error != recomp::mods::ModOpenError::Good) {
-                    result.error_messages.emplace_back("Invalid mod (" + target_path.filename().string() + ") in " + path.filename().string() + ".");
-                    extracted_file_handle.reset();
-                    std::filesystem::remove(target_write_path, ec);
-                    continue;
-                }
+            // Two workers can't write to the same file, so only the first entry with a given name is extracted.
+            if (!job_targets.emplace(target_path.u8string()).second) {
+                continue;
+            }
 
-                // Check for the existence of the manifest file.
-                bool exists = false;
-                std::vector<char> manifest_bytes = extracted_file_handle->read_file(ManifestFilename, exists);
-                if (exists) {
-                    // Parse the manifest file to check for its validity.
-                    std::string error;
-                    recomp::mods::ModManifest manifest;
-                    open_error = parse_manifest(manifest, manifest_bytes, error);
-                    exists = (open_error == recomp::mods::ModOpenError::Good);
-
-                    if (exists) {
-                        installation.mod_id = manifest.mod_id;
-                        installation.display_name = manifest.display_name;
-                        installation.mod_version = manifest.version;
-                        installation.mod_file = target_path;
-                    }
-                }
-                else if (target_path.extension() == ".rtz") {
-                    // When it's an rtz file, check if the texture database file exists.
-                    exists = mz_zip_reader_locate_file(extracted_file_handle->archive.get(), TextureDatabaseFilename, nullptr, 0) >= 0;
-
-                    if (exists) {
-                        installation.mod_id = std::string((const char *)(target_path.stem().u8string().c_str()));
-                        installation.display_name = installation.mod_id;
-                        installation.mod_version = recomp::Version();
-                        installation.mod_file = target_path;
-                    }
-                }
+            jobs.emplace_back(ExtractionJob{
+                .file_index = i,
+                .target_path = target_path,
+                .target_write_path = target_path.u8string() + NewExtension,
+                .size = file_stat.m_uncomp_size
+            });
+        }
 
-                if (!exists) {
-                    result.error_messages.emplace_back("Invalid mod (" + target_path.filename().string() + ") in " + path.filename().string() + ".");
-                    extracted_file_handle.reset();
-                    std::filesystem::remove(target_write_path, ec);
-                    continue;
-                }
+        extract_entries_parallel(path, jobs, progress_callback);
 
-                if (std::filesystem::exists(installation.mod_file, ec)) {
-                    installation.needs_overwrite_confirmation = true;
+        // Validate the extracted files in the order they were found in the archive.
+        for (const ExtractionJob &job : jobs) {
+            const std::filesystem::path &target_path = job.target_path;
+            const std::filesystem::path &target_write_path = job.target_write_path;
+            if (job.status != ExtractionStatus::Success) {
+                std::filesystem::remove(target_write_path, ec);
+                if (job.status == ExtractionStatus::Corrupted) {
+                    result.error_messages.emplace_back("Corrupted file (" + target_path.filename().string() + ") in " + path.filename().string() + ".");
                 }
-                if (!installation.needs_overwrite_confirmation) {
-                    // This check isn't really needed as additional_files will be empty at this point,
-                    // but it's good to have in case this logic ever changes.
-                    for (const std::filesystem::path &path : installation.additional_files) {
-                        if (std::filesystem::exists(path, ec)) {
-                            installation.needs_overwrite_confirmation = true;
-                            break;
-                        }
-                    }
+                else if ((job.status == ExtractionStatus::WriteFailed) && !is_dynamic_lib(target_path)) {
+                    result.error_messages.emplace_back("Unable to write to mod directory.");
                 }
-
-                result.pending_installations.emplace_back(installation);
-
-                // Store the first nrm found for any dynamic libraries that might be found.
-                if ((first_nrm_iterator == result.pending_installations.end()) && (target_path.extension() == ".nrm")) {
-                    first_nrm_iterator = std::prev(result.pending_installations.end());
+                else {
+                    result.error_messages.emplace_back("Failed to install " + path.filename().string() + " to mod directory.");
                 }
+
+                continue;
             }
-            
+
             if (is_dynamic_lib(target_path)) {
-                std::filesystem::path target_write_path = target_path.u8string() + NewExtension;
-                std::ofstream output_stream(target_write_path, std::ios::binary);
-                if (!output_stream.is_open()) {
-                    result.error_messages.emplace_back("Failed to install " + path.filename().string() + " to mod directory.");
-                    continue;
+                dynamic_lib_files.emplace_back(target_path);
+                continue;
+            }
+
+            // Try to load the extracted file as a mod file handle.
+            ModInstaller::Installation installation;
+            recomp::mods::ModOpenError open_error;
+            std::unique_ptr<recomp::mods::ZipModFileHandle> extracted_file_handle = std::make_unique<recomp::mods::ZipModFileHandle>(target_write_path, open_error);
+            if (open_error != recomp::mods::ModOpenError::Good) {
+                result.error_messages.emplace_back("Invalid mod (" + target_path.filename().string() + ") in " + path.filename().string() + ".");
+                extracted_file_handle.reset();
+                std::filesystem::remove(target_write_path, ec);
+                continue;
+            }
+
+            // Check for the existence of the manifest file.
+            bool exists = false;
+            std::vector<char> manifest_bytes = extracted_file_handle->read_file(ManifestFilename, exists);
+            if (exists) {
+                // Parse the manifest file to check for its validity.
+                std::string error;
+                recomp::mods::ModManifest manifest;
+                open_error = parse_manifest(manifest, manifest_bytes, error);
+                exists = (open_error == recomp::mods::ModOpenError::Good);
+
+                if (exists) {
+                    installation.mod_id = manifest.mod_id;
+                    installation.display_name = manifest.display_name;
+                    installation.mod_version = manifest.version;
+                    installation.mod_file = target_path;
                 }
+            }
+            else if (target_path.extension() == ".rtz") {
+                // When it's an rtz file, check if the texture database file exists.
+                exists = mz_zip_reader_locate_file(extracted_file_handle->archive.get(), TextureDatabaseFilename, nullptr, 0) >= 0;
 
-                if (!mz_zip_reader_extract_to_callback(zip_archive, i, &zip_write_func, &output_stream, 0)) {
-                    output_stream.close();
-                    std::filesystem::remove(target_write_path, ec);
-                    result.error_messages.emplace_back("Failed to install " + path.filename().string() + " to mod directory.");
-                    continue;
+                if (exists) {
+                    installation.mod_id = std::string((const char *)(target_path.stem().u8string().c_str()));
+                    installation.display_name = installation.mod_id;
+                    installation.mod_version = recomp::Version();
+                    installation.mod_file = target_path;
                 }
+            }
 
-                output_stream.close();
-                if (output_stream.bad()) {
-                    std::filesystem::remove(target_write_path, ec);
-                    result.error_messages.emplace_back("Failed to install " + path.filename().string() + " to mod directory.");
-                    continue;
+            if (!exists) {
+                result.error_messages.emplace_back("Invalid mod (" + target_path.filename().string() + ") in " + path.filename().string() + ".");
+                extracted_file_handle.reset();
+                std::filesystem::remove(target_write_path, ec);
+                continue;
+            }
+
+            if (std::filesystem::exists(installation.mod_file, ec)) {
+                installation.needs_overwrite_confirmation = true;
+            }
+            if (!installation.needs_overwrite_confirmation) {
+                // This check isn't really needed as additional_files will be empty at this point,
+                // but it's good to have in case this logic ever changes.
+                for (const std::filesystem::path &path : installation.additional_files) {
+                    if (std::filesystem::exists(path, ec)) {
+                        installation.needs_overwrite_confirmation = true;
+                        break;
+                    }
                 }
+            }
 
-                dynamic_lib_files.emplace_back(target_path);
+            result.pending_installations.emplace_back(installation);
+
+            // Store the first nrm found for any dynamic libraries that might be found.
+            if ((first_nrm_iterator == result.pending_installations.end()) && (target_path.extension() == ".nrm")) {
+                first_nrm_iterator = std::prev(result.pending_installations.end());
             }
         }
 
@@ -1,4 +1,5 @@
 ﻿#include "ui_mod_menu.h"
+#include "ui_mod_thumbnails.h"
 #include "ui_utils.h"
 #include "recomp_ui.h"
 #include "zelda_support.h"
@@ -32,6 +33,7 @@ static bool is_mod_enabled_or_auto(const std::string &mod_id) {
 #define COL_SECONDARY 23, 214, 232
 constexpr float modEntryHeight = 120.0f;
 constexpr float modEntryPadding = 4.0f;
+constexpr float modEntryRowHeight = modEntryHeight + modEntryPadding * 2.0f;
 
 extern const std::string mod_tab_id;
 const std::string mod_tab_id = "#tab_mods";
@@ -244,12 +246,27 @@ void ModEntrySpacer::set_target_height(float target_height, bool animate_to_targ
     }
 }
 
+// ModEntryRow
+
+ModEntryRow::ModEntryRow(Element *parent) : Element(parent) {
+    ContextId context = get_current_context();
+
+    set_width(100.0f, Unit::Percent);
+
+    spacer = context.create_element<ModEntrySpacer>(this);
+    button = context.create_element<ModEntryButton>(this, 0);
+}
+
 // ModMenu
 
 void ModMenu::refresh_mods(bool scan_mods) {
     for (const std::string &thumbnail : loaded_thumbnails) {
         recompui::release_image(thumbnail);
     }
+    loaded_thumbnails.clear();
+
+    // Thumbnails that are still loading belong to the previous scan and get discarded when they finish.
+    thumbnail_generation++;
 
     if (scan_mods) {
         recomp::mods::scan_mods();
@@ -293,30 +310,37 @@ void ModMenu::mod_toggled(bool enabled) {
         recomp::mods::enable_mod(mod_details[active_mod_index].mod_id, enabled);
         
         // Refresh enabled status for all mods in case one of them got auto-enabled due to being a dependency.
-        for (size_t i = 0; i < mod_entry_buttons.size(); i++) {
-            mod_entry_buttons[i]->set_mod_enabled(is_mod_enabled_or_auto(mod_details[i].mod_id));
-        }
+        mod_list->refresh();
     }
 }
 
 void ModMenu::mod_selected(uint32_t mod_index) {
     if (active_mod_index >= 0) {
-        mod_entry_buttons[active_mod_index]->set_selected(false);
+        ModEntryButton *prev_button = get_mod_entry_button(active_mod_index);
+        if (prev_button != nullptr) {
+            prev_button->set_selected(false);
+        }
     }
 
     active_mod_index = mod_index;
 
     if (active_mod_index >= 0) {
-        std::string thumbnail_src = generate_thumbnail_src_for_mod(mod_details[mod_index].mod_id);
+        std::string thumbnail_src = load_mod_thumbnail(mod_details[mod_index].mod_id);
         const recomp::mods::ConfigSchema &config_schema = recomp::mods::get_mod_config_schema(mod_details[active_mod_index].mod_id);
         bool toggle_checked = is_mod_enabled_or_auto(mod_details[mod_index].mod_id);
         bool auto_enabled = recomp::mods::is_mod_auto_enabled(mod_details[mod_index].mod_id);
         bool toggle_enabled = !auto_enabled && (mod_details[mod_index].runtime_toggleable || !ultramodern::is_game_started());
         bool configure_enabled = !config_schema.options.empty();
         mod_details_panel->set_mod_details(mod_details[mod_index], thumbnail_src, toggle_checked, toggle_enabled, auto_enabled, configure_enabled);
-        mod_entry_buttons[active_mod_index]->set_selected(true);
 
-        mod_details_panel->setup_mod_navigation(mod_entry_buttons[mod_index]);
+        ModEntryButton *active_button = get_mod_entry_button(mod_index);
+        if (active_button != nullptr) {
+            active_button->set_selected(true);
+            update_mod_entry_navigation(active_button, mod_index);
+        }
+        else {
+            mod_details_panel->clear_mod_navigation();
+        }
 
         // Navigation from the bottom bar.
         Button *configure_button = mod_details_panel->get_configure_button();
@@ -333,41 +357,139 @@ void ModMenu::mod_selected(uint32_t mod_index) {
             refresh_button->set_nav_manual(NavDirection::Up, mod_tab_id);
             mods_folder_button->set_nav_manual(NavDirection::Up, mod_tab_id);
         }
+    }
+}
 
-        // Navigation from the mod list.
-        if (toggle_enabled) {
-            mod_entry_buttons[active_mod_index]->set_nav(NavDirection::Right, enable_toggle);
-        }
-        else if (configure_enabled) {
-            mod_entry_buttons[active_mod_index]->set_nav(NavDirection::Right, configure_button);
+void ModMenu::update_mod_entry_navigation(ModEntryButton *button, size_t mod_index) {
+    // Navigation at the ends of the list.
+    if (mod_index == 0) {
+        button->set_nav_manual(NavDirection::Up, mod_tab_id);
+    }
+    else {
+        button->set_nav_auto(NavDirection::Up);
+    }
+
+    if (mod_index + 1 == mod_details.size()) {
+        button->set_nav(NavDirection::Down, install_mods_button);
+    }
+    else {
+        button->set_nav_auto(NavDirection::Down);
+    }
+
+    // Only the active mod can navigate into the details panel.
+    if (static_cast<int32_t>(mod_index) != active_mod_index) {
+        button->set_nav_auto(NavDirection::Right);
+        return;
+    }
+
+    const recomp::mods::ConfigSchema &config_schema = recomp::mods::get_mod_config_schema(mod_details[mod_index].mod_id);
+    bool auto_enabled = recomp::mods::is_mod_auto_enabled(mod_details[mod_index].mod_id);
+    bool toggle_enabled = !auto_enabled && (mod_details[mod_index].runtime_toggleable || !ultramodern::is_game_started());
+    bool configure_enabled = !config_schema.options.empty();
+
+    mod_details_panel->setup_mod_navigation(button);
+
+    if (toggle_enabled) {
+        button->set_nav(NavDirection::Right, mod_details_panel->get_enable_toggle());
+    }
+    else if (configure_enabled) {
+        button->set_nav(NavDirection::Right, mod_details_panel->get_configure_button());
+    }
+    else {
+        button->set_nav_none(NavDirection::Right);
+    }
+}
+
+std::string ModMenu::load_mod_thumbnail(const std::string &mod_id) {
+    // Thumbnails are only loaded once a row showing the mod is created, rather than for every mod up front.
+    // Decoding happens in the background and the image shows up once it's been uploaded in process_event.
+    std::string thumbnail_name = generate_thumbnail_src_for_mod(mod_id);
+    if (!loaded_thumbnails.contains(thumbnail_name)) {
+        // Mods in the index are read on the loader thread, and not at all if their thumbnail is already cached.
+        ModIndexEntry index_entry;
+        if (find_mod_index_entry(mod_id, index_entry)) {
+            if (!index_entry.thumbnail_file.empty()) {
+                queue_mod_thumbnail_from_index(thumbnail_name, thumbnail_generation, index_entry);
+                loaded_thumbnails.emplace(thumbnail_name);
+                pending_thumbnails++;
+                queue_update();
+            }
+
+            return thumbnail_name;
         }
-        else {
-            mod_entry_buttons[active_mod_index]->set_nav_none(NavDirection::Right);
+
+        std::vector<char> thumbnail = recomp::mods::get_mod_thumbnail(mod_id);
+        if (!thumbnail.empty()) {
+            queue_mod_thumbnail(thumbnail_name, thumbnail_generation, mod_id, std::move(thumbnail));
+            loaded_thumbnails.emplace(thumbnail_name);
+            pending_thumbnails++;
+            queue_update();
         }
     }
+
+    return thumbnail_name;
+}
+
+ModEntryButton *ModMenu::get_mod_entry_button(size_t mod_index) {
+    if (mod_list == nullptr) {
+        return nullptr;
+    }
+
+    ModEntryRow *row = static_cast<ModEntryRow *>(mod_list->get_row(mod_index));
+    return row != nullptr ? row->get_button() : nullptr;
+}
+
+ModEntrySpacer *ModMenu::get_mod_entry_spacer(size_t mod_index) {
+    if (mod_index == mod_details.size()) {
+        return mod_list_end_spacer;
+    }
+
+    ModEntryRow *row = static_cast<ModEntryRow *>(mod_list->get_row(mod_index));
+    return row != nullptr ? row->get_spacer() : nullptr;
+}
+
+void ModMenu::bind_mod_entry(Element *row_element, size_t mod_index) {
+    constexpr float spacer_height = modEntryRowHeight;
+    ModEntryRow *row = static_cast<ModEntryRow *>(row_element);
+    ModEntryButton *button = row->get_button();
+    const recomp::mods::ModDetails &details = mod_details[mod_index];
+
+    button->set_mod_index(mod_index);
+    button->set_mod_details(details);
+    button->set_mod_thumbnail(load_mod_thumbnail(details.mod_id));
+    button->set_mod_enabled(is_mod_enabled_or_auto(details.mod_id));
+    button->set_selected(static_cast<int32_t>(mod_index) == active_mod_index);
+    update_mod_entry_navigation(button, mod_index);
+
+    // Rows can be recycled in the middle of a drag, so restore the drag state for whichever mod the row now shows.
+    bool is_drag_source = mod_dragging && mod_index == mod_drag_source_index;
+    bool is_drag_target = mod_dragging && mod_index == mod_drag_target_index;
+    button->set_display(is_drag_source ? Display::None : Display::Block);
+    row->get_spacer()->set_target_height(is_drag_target ? spacer_height : 0.0f, false);
 }
 
 void ModMenu::mod_dragged(uint32_t mod_index, EventDrag drag) {
-    constexpr float spacer_height = modEntryHeight + modEntryPadding * 2.0f;
+    constexpr float spacer_height = modEntryRowHeight;
 
     switch (drag.phase) {
     case DragPhase::Start: {
-        for (size_t i = 0; i < mod_entry_buttons.size(); i++) {
-            mod_entry_middles[i] = mod_entry_buttons[i]->get_absolute_top() + mod_entry_buttons[i]->get_client_height() / 2.0f;
+        ModEntryButton *drag_button = get_mod_entry_button(mod_index);
+        if (drag_button == nullptr) {
+            break;
         }
 
         // When the drag phase starts, we make the floating mod details visible and store the relative coordinate of the
         // mouse cursor. Instantly hide the real element and use a spacer in its place that will stay on the same size as
         // long as the cursor is hovering over this slot.
-        float width = mod_entry_buttons[mod_index]->get_client_width();
-        float height = mod_entry_buttons[mod_index]->get_client_height();
-        float left = mod_entry_buttons[mod_index]->get_absolute_left() - get_absolute_left();
-        float top = mod_entry_buttons[mod_index]->get_absolute_top() - (height / 2.0f); // TODO: Figure out why this adjustment is even necessary.
-        mod_entry_buttons[mod_index]->set_display(Display::None);
-        mod_entry_buttons[mod_index]->set_focused(false);
+        float width = drag_button->get_client_width();
+        float height = drag_button->get_client_height();
+        float left = drag_button->get_absolute_left() - get_absolute_left();
+        float top = drag_button->get_absolute_top() - (height / 2.0f); // TODO: Figure out why this adjustment is even necessary.
+        drag_button->set_display(Display::None);
+        drag_button->set_focused(false);
         mod_entry_floating_view->set_display(Display::Flex);
         mod_entry_floating_view->set_mod_details(mod_details[mod_index]);
-        mod_entry_floating_view->set_mod_thumbnail(generate_thumbnail_src_for_mod(mod_details[mod_index].mod_id));
+        mod_entry_floating_view->set_mod_thumbnail(load_mod_thumbnail(mod_details[mod_index].mod_id));
         mod_entry_floating_view->set_mod_enabled(is_mod_enabled_or_auto(mod_details[mod_index].mod_id));
         mod_entry_floating_view->set_left(left, Unit::Px);
         mod_entry_floating_view->set_top(top, Unit::Px);
@@ -378,17 +500,24 @@ void ModMenu::mod_dragged(uint32_t mod_index, EventDrag drag) {
         mod_drag_view_coordinates[0] = left;
         mod_drag_view_coordinates[1] = top;
         
+        mod_dragging = true;
+        mod_drag_source_index = mod_index;
         mod_drag_target_index = mod_index;
-        mod_entry_spacers[mod_drag_target_index]->set_target_height(spacer_height, false);
+        get_mod_entry_spacer(mod_drag_target_index)->set_target_height(spacer_height, false);
         break;
     }
     case DragPhase::Move: {
-        // Binary search for the drag area.
+        if (!mod_dragging) {
+            break;
+        }
+
+        // Binary search for the drag area. Rows have a fixed height, so their positions can be computed
+        // even when they aren't currently instantiated.
         uint32_t low = 0;
-        uint32_t high = mod_entry_buttons.size();
+        uint32_t high = mod_details.size();
         while (low < high) {
             uint32_t mid = low + (high - low) / 2;
-            if (drag.y < mod_entry_middles[mid]) {
+            if (drag.y < mod_list->get_row_middle(mid)) {
                 high = mid;
             }
             else {
@@ -402,37 +531,46 @@ void ModMenu::mod_dragged(uint32_t mod_index, EventDrag drag) {
         mod_entry_floating_view->set_left(mod_drag_view_coordinates[0] + delta_x, Unit::Px);
         mod_entry_floating_view->set_top(mod_drag_view_coordinates[1] + delta_y, Unit::Px);
         if (mod_drag_target_index != new_index) {
-            mod_entry_spacers[mod_drag_target_index]->set_target_height(0.0f, true);
-            mod_entry_spacers[new_index]->set_target_height(spacer_height, true);
+            ModEntrySpacer *old_spacer = get_mod_entry_spacer(mod_drag_target_index);
+            ModEntrySpacer *new_spacer = get_mod_entry_spacer(new_index);
+            if (old_spacer != nullptr) {
+                old_spacer->set_target_height(0.0f, true);
+            }
+            if (new_spacer != nullptr) {
+                new_spacer->set_target_height(spacer_height, true);
+            }
             mod_drag_target_index = new_index;
         }
 
         break;
     }
     case DragPhase::End: {
+        if (!mod_dragging) {
+            break;
+        }
+
         // Dragging has ended, hide the floating view.
-        mod_entry_buttons[mod_index]->set_display(Display::Block);
-        mod_entry_buttons[mod_index]->set_selected(false);
-        mod_entry_spacers[mod_drag_target_index]->set_target_height(0.0f, false);
+        ModEntrySpacer *target_spacer = get_mod_entry_spacer(mod_drag_target_index);
+        if (target_spacer != nullptr) {
+            target_spacer->set_target_height(0.0f, false);
+        }
         mod_entry_floating_view->set_display(Display::None);
+        mod_dragging = false;
 
-        // Result needs a small substraction when dragging downwards.
-        if (mod_drag_target_index > mod_index) {
+        // Result needs a small substraction when dragging downwards. The source index is used instead of the
+        // row's index, as the row may have been recycled for a different mod while scrolling during the drag.
+        if (mod_drag_target_index > mod_drag_source_index) {
             mod_drag_target_index--;
         }
 
         // Re-order the mods and update all the details on the menu.
-        recomp::mods::set_mod_index(game_mod_id, mod_details[mod_index].mod_id, mod_drag_target_index);
+        recomp::mods::set_mod_index(game_mod_id, mod_details[mod_drag_source_index].mod_id, mod_drag_target_index);
         mod_details = recomp::mods::get_all_mod_details(game_mod_id);
-        for (size_t i = 0; i < mod_entry_buttons.size(); i++) {
-            mod_entry_buttons[i]->set_mod_details(mod_details[i]);
-            mod_entry_buttons[i]->set_mod_thumbnail(generate_thumbnail_src_for_mod(mod_details[i].mod_id));
-            mod_entry_buttons[i]->set_mod_enabled(is_mod_enabled_or_auto(mod_details[i].mod_id));
-        }
-
-        mod_entry_buttons[mod_drag_target_index]->set_selected(true);
         active_mod_index = mod_drag_target_index;
 
+        // Rebind the visible rows, which also restores the dragged row and moves the selection.
+        mod_list->refresh();
+
         break;
     }
     default:
@@ -550,40 +688,12 @@ void ModMenu::mod_hd_textures_enabled_changed(uint32_t value) {
 }
 
 void ModMenu::create_mod_list() {
-    ContextId context = get_current_context();
-    
-    // Clear the contents of the list scroll.
-    list_scroll_container->clear_children();
-    mod_entry_buttons.clear();
-    mod_entry_spacers.clear();
-
-    Toggle* enable_toggle = mod_details_panel->get_enable_toggle();
-
-    // Create the child elements for the list scroll.
-    for (size_t mod_index = 0; mod_index < mod_details.size(); mod_index++) {
-        const std::vector<char> &thumbnail = recomp::mods::get_mod_thumbnail(mod_details[mod_index].mod_id);
-        std::string thumbnail_name = generate_thumbnail_src_for_mod(mod_details[mod_index].mod_id);
-        if (!thumbnail.empty()) {
-            recompui::queue_image_from_bytes_file(thumbnail_name, thumbnail);
-            loaded_thumbnails.emplace(thumbnail_name);
-        }
-
-        ModEntrySpacer *spacer = context.create_element<ModEntrySpacer>(list_scroll_container);
-        mod_entry_spacers.emplace_back(spacer);
+    // The list only creates rows for the mods that are in view, which get bound through bind_mod_entry.
+    active_mod_index = -1;
+    mod_list->set_item_count(mod_details.size());
 
-        ModEntryButton *mod_entry = context.create_element<ModEntryButton>(list_scroll_container, mod_index);
-        mod_entry->set_mod_selected_callback([this](uint32_t mod_index){ mod_selected(mod_index); });
-        mod_entry->set_mod_drag_callback([this](uint32_t mod_index, recompui::EventDrag drag){ mod_dragged(mod_index, drag); });
-        mod_entry->set_mod_details(mod_details[mod_index]);
-        mod_entry->set_mod_thumbnail(thumbnail_name);
-        mod_entry->set_mod_enabled(is_mod_enabled_or_auto(mod_details[mod_index].mod_id));
-        mod_entry_buttons.emplace_back(mod_entry);
-    }
-
-    if (!mod_entry_buttons.empty()) {
-        mod_entry_buttons.front()->set_nav_manual(NavDirection::Up, mod_tab_id);
-        mod_entry_buttons.back()->set_nav(NavDirection::Down, install_mods_button);
-        install_mods_button->set_nav(NavDirection::Up, mod_entry_buttons.back());
+    if (!mod_details.empty()) {
+        install_mods_button->set_nav_auto(NavDirection::Up);
     }
     else {
         install_mods_button->set_nav_manual(NavDirection::Up, mod_tab_id);
@@ -594,12 +704,6 @@ void ModMenu::create_mod_list() {
         recompui::set_config_tabset_mod_nav();
     }       
 
-    // Add one extra spacer at the bottom.
-    ModEntrySpacer *spacer = context.create_element<ModEntrySpacer>(list_scroll_container);
-    mod_entry_spacers.emplace_back(spacer);
-
-    mod_entry_middles.resize(mod_entry_buttons.size());
-
     bool mods_available = !mod_details.empty();
     body_container->set_display(mods_available ? Display::Flex : Display::None);
     body_empty_container->set_display(mods_available ? Display::None : Display::Flex);
@@ -615,6 +719,31 @@ void ModMenu::process_event(const Event &e) {
             mods_dirty = false;
             mod_scan_queued = false;
         }
+        if (pending_thumbnails > 0) {
+            ModThumbnail thumbnail;
+            while (get_loaded_mod_thumbnail(thumbnail)) {
+                pending_thumbnails--;
+                if (thumbnail.generation != thumbnail_generation || !loaded_thumbnails.contains(thumbnail.src) || thumbnail.bytes.empty()) {
+                    continue;
+                }
+
+                if (thumbnail.is_file) {
+                    recompui::queue_image_from_bytes_file(thumbnail.src, thumbnail.bytes);
+                }
+                else {
+                    recompui::queue_image_from_bytes_rgba32(thumbnail.src, thumbnail.bytes, thumbnail.width, thumbnail.height);
+                }
+
+                // Any image that was already showing the thumbnail got a transparent placeholder, so release it to
+                // make those images load the real texture.
+                recompui::release_image(thumbnail.src);
+            }
+
+            // Keep polling until every requested thumbnail has been uploaded.
+            if (pending_thumbnails > 0) {
+                queue_update();
+            }
+        }
         if (ultramodern::is_game_started()) {
             install_mods_button->set_enabled(false);
             refresh_button->set_enabled(false);
@@ -629,6 +758,8 @@ void ModMenu::process_event(const Event &e) {
     }
 }
 
+static void queue_mod_list_refresh(bool scan_mods);
+
 ModMenu::ModMenu(Element *parent) : Element(parent) {
     game_mod_id = "sf64";
 
@@ -656,7 +787,17 @@ ModMenu::ModMenu(Element *parent) : Element(parent) {
             list_container->set_background_color(Color{ 0, 0, 0, 89 });
             list_container->set_border_bottom_left_radius(16.0f);
             {
-                list_scroll_container = context.create_element<ScrollContainer>(list_container, ScrollDirection::Vertical);
+                mod_list = context.create_element<VirtualList>(list_container, modEntryRowHeight,
+                    [this](Element *parent) -> Element* {
+                        ModEntryRow *row = get_current_context().create_element<ModEntryRow>(parent);
+                        row->get_button()->set_mod_selected_callback([this](uint32_t mod_index){ mod_selected(mod_index); });
+                        row->get_button()->set_mod_drag_callback([this](uint32_t mod_index, recompui::EventDrag drag){ mod_dragged(mod_index, drag); });
+                        return row;
+                    },
+                    [this](Element *row, size_t mod_index) { bind_mod_entry(row, mod_index); });
+
+                // One extra spacer at the bottom for dropping a mod at the end of the list.
+                mod_list_end_spacer = context.create_element<ModEntrySpacer>(mod_list);
             } // list_container
 
             mod_details_panel = context.create_element<ModDetailsPanel>(body_container);
@@ -692,7 +833,7 @@ ModMenu::ModMenu(Element *parent) : Element(parent) {
             footer_spacer->set_flex(1.0f, 0.0f);
 
             refresh_button = context.create_element<Button>(footer_container, "Refresh", recompui::ButtonStyle::Primary);
-            refresh_button->add_pressed_callback([this](){ refresh_mods(true); });
+            refresh_button->add_pressed_callback([](){ update_mod_list(true); });
             refresh_button->set_nav_manual(NavDirection::Up, mod_tab_id);
 
             mods_folder_button = context.create_element<Button>(footer_container, "Open Mods Folder", recompui::ButtonStyle::Primary);
@@ -718,6 +859,9 @@ ModMenu::ModMenu(Element *parent) : Element(parent) {
     sub_menu_context.close();
 
     context.open();
+
+    // Mods that were added, removed or modified in the mods folder need a scan by the runtime before they show up.
+    set_mod_index_changed_callback([]() { queue_mod_list_refresh(true); });
 }
 
 ModMenu::~ModMenu() {
@@ -727,7 +871,7 @@ ModMenu::~ModMenu() {
 
 recompui::ModMenu* mod_menu;
 
-void update_mod_list(bool scan_mods) {
+static void queue_mod_list_refresh(bool scan_mods) {
     if (mod_menu) {
         recompui::ContextId ui_context = recompui::get_config_context_id();
         bool opened = ui_context.open_if_not_already();
@@ -741,6 +885,17 @@ void update_mod_list(bool scan_mods) {
     }
 }
 
+void update_mod_list(bool scan_mods) {
+    if (scan_mods) {
+        // The runtime's scan opens every mod one after another, so it only runs once the mod index has found changes
+        // in the mods folder, see the callback set in the ModMenu constructor.
+        refresh_mod_index();
+    }
+    else {
+        queue_mod_list_refresh(false);
+    }
+}
+
 void process_game_started() {
     if (mod_menu) {
         recompui::ContextId ui_context = recompui::get_config_context_id();
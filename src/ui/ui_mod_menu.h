@@ -3,6 +3,7 @@
 
 #include "librecomp/mods.hpp"
 #include "elements/ui_scroll_container.h"
+#include "elements/ui_virtual_list.h"
 #include "ui_config_sub_menu.h"
 #include "ui_mod_details_panel.h"
 
@@ -37,6 +38,7 @@ class ModEntryButton : public Element {
 public:
     ModEntryButton(Element *parent, uint32_t mod_index);
     virtual ~ModEntryButton();
+    void set_mod_index(uint32_t mod_index) { this->mod_index = mod_index; }
     void set_mod_selected_callback(std::function<void(uint32_t)> callback);
     void set_mod_drag_callback(std::function<void(uint32_t, EventDrag)> callback);
     void set_mod_details(const recomp::mods::ModDetails &details);
@@ -69,12 +71,24 @@ public:
     void set_target_height(float target_height, bool animate_to_target);
 };
 
+class ModEntryRow : public Element {
+public:
+    ModEntryRow(Element *parent);
+    ModEntrySpacer *get_spacer() { return spacer; }
+    ModEntryButton *get_button() { return button; }
+protected:
+    std::string_view get_type_name() override { return "ModEntryRow"; }
+private:
+    ModEntrySpacer *spacer = nullptr;
+    ModEntryButton *button = nullptr;
+};
+
 class ModMenu : public Element {
 public:
     ModMenu(Element *parent);
     virtual ~ModMenu();
     void set_mods_dirty(bool scan_mods) { mods_dirty = true; mod_scan_queued = scan_mods; }
-    Element* get_first_mod_entry() { return !mod_entry_buttons.empty() ? mod_entry_buttons[0] : nullptr; }
+    Element* get_first_mod_entry() { return get_mod_entry_button(0); }
     Element* get_mod_configure_button() { return mod_details_panel != nullptr ? mod_details_panel->get_configure_button() : nullptr; }
 protected:
     std::string_view get_type_name() override { return "ModMenu"; }
@@ -92,11 +106,17 @@ private:
     void mod_number_option_changed(const std::string &id, double value);
     void mod_hd_textures_enabled_changed(uint32_t value);
     void create_mod_list();
+    void bind_mod_entry(Element *row, size_t mod_index);
+    void update_mod_entry_navigation(ModEntryButton *button, size_t mod_index);
+    std::string load_mod_thumbnail(const std::string &mod_id);
+    ModEntryButton *get_mod_entry_button(size_t mod_index);
+    ModEntrySpacer *get_mod_entry_spacer(size_t mod_index);
     void process_event(const Event &e) override;
 
     Container *body_container = nullptr;
     Container *list_container = nullptr;
-    ScrollContainer *list_scroll_container = nullptr;
+    VirtualList *mod_list = nullptr;
+    ModEntrySpacer *mod_list_end_spacer = nullptr;
     ModDetailsPanel *mod_details_panel = nullptr;
     Container *body_empty_container = nullptr;
     Container *footer_container = nullptr;
@@ -104,15 +124,16 @@ private:
     Button *refresh_button = nullptr;
     Button *mods_folder_button = nullptr;
     int32_t active_mod_index = -1;
-    std::vector<ModEntryButton *> mod_entry_buttons;
-    std::vector<ModEntrySpacer *> mod_entry_spacers;
-    std::vector<float> mod_entry_middles;
     ModEntryView *mod_entry_floating_view = nullptr;
     float mod_drag_start_coordinates[2] = {};
     float mod_drag_view_coordinates[2] = {};
+    bool mod_dragging = false;
+    uint32_t mod_drag_source_index = 0;
     uint32_t mod_drag_target_index = 0;
     std::vector<recomp::mods::ModDetails> mod_details{};
     std::unordered_set<std::string> loaded_thumbnails;
+    uint32_t thumbnail_generation = 0;
+    uint32_t pending_thumbnails = 0;
     std::string game_mod_id;
     bool mods_dirty = false;
     bool mod_scan_queued = false;
@@ -0,0 +1,322 @@
+#include "ui_mod_thumbnails.h"
+#include "zelda_config.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include <concurrentqueue.h>
+
+// The decoder is compiled into this file with internal linkage, so it doesn't depend on any other library providing
+// the stb_image implementation or clash with one that does.
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+namespace recompui {
+    static const uint32_t ThumbnailCacheMagic = 0x4D485452; // 'RTHM'
+    static const uint32_t ThumbnailCacheVersion = 1;
+    static const std::u8string ThumbnailCacheExtension = u8".rgba";
+    static const std::u8string TemporaryExtension = u8".tmp";
+    // Thumbnails are keyed either by the mod file's index entry or by the thumbnail's bytes. The key type is part of
+    // the cache file's name so entries of one type never evict the other.
+    static const std::string IndexKeyPrefix = "index_";
+    static const std::string BytesKeyPrefix = "bytes_";
+
+    struct ThumbnailCacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    struct ThumbnailRequest {
+        std::string src;
+        uint32_t generation;
+        std::string mod_id;
+        std::vector<char> bytes;
+        // If set, the bytes are read from the mod's archive on the loader thread and only if the thumbnail isn't
+        // cached already.
+        bool from_index = false;
+        ModIndexEntry index_entry;
+    };
+
+    static uint64_t hash_bytes(const void *data, size_t size, uint64_t hash = 0xCBF29CE484222325ULL) {
+        // FNV-1a, which is plenty for telling apart versions of the same mod's thumbnail.
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ULL;
+        }
+
+        return hash;
+    }
+
+    static uint64_t hash_thumbnail_bytes(const std::vector<char> &bytes) {
+        return hash_bytes(bytes.data(), bytes.size());
+    }
+
+    static uint64_t hash_index_entry(const ModIndexEntry &entry) {
+        // The mod file's path, size and modification time identify the thumbnail without having to read it.
+        std::u8string path = entry.path.u8string();
+        uint64_t hash = hash_bytes(path.data(), path.size());
+        hash = hash_bytes(&entry.file_size, sizeof(entry.file_size), hash);
+        hash = hash_bytes(&entry.write_time, sizeof(entry.write_time), hash);
+        return hash_bytes(entry.thumbnail_file.data(), entry.thumbnail_file.size(), hash);
+    }
+
+    static std::filesystem::path get_thumbnail_cache_directory(const std::string &mod_id) {
+        // Mod IDs are used as folder names, so replace anything that isn't safe to use in a path.
+        std::string folder_name = mod_id;
+        for (char &c : folder_name) {
+            bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-' || c == '.';
+            if (!safe) {
+                c = '_';
+            }
+        }
+
+        return zelda64::get_app_folder_path() / "cache" / "thumbnails" / folder_name;
+    }
+
+    static bool read_cached_thumbnail(const std::filesystem::path &path, ModThumbnail &thumbnail) {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream.good()) {
+            return false;
+        }
+
+        ThumbnailCacheHeader header;
+        stream.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (!stream.good() || header.magic != ThumbnailCacheMagic || header.version != ThumbnailCacheVersion) {
+            return false;
+        }
+
+        if (header.width == 0 || header.height == 0 || header.width > ModThumbnailSize || header.height > ModThumbnailSize) {
+            return false;
+        }
+
+        thumbnail.width = header.width;
+        thumbnail.height = header.height;
+        thumbnail.bytes.resize(size_t(header.width) * header.height * 4);
+        stream.read(thumbnail.bytes.data(), thumbnail.bytes.size());
+        return !stream.fail();
+    }
+
+    static bool has_prefix(const std::string &name, const std::string &prefix) {
+        return name.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    static void write_cached_thumbnail(const std::filesystem::path &path, const std::string &key_prefix, const ModThumbnail &thumbnail) {
+        std::error_code ec;
+        std::filesystem::path directory = path.parent_path();
+        std::filesystem::create_directories(directory, ec);
+        if (ec) {
+            return;
+        }
+
+        // Remove the thumbnails cached under the same key type for previous versions of the mod, along with any
+        // entries from before the key type was part of the name.
+        for (const auto &entry : std::filesystem::directory_iterator(directory, ec)) {
+            std::string name = entry.path().filename().string();
+            bool same_key_type = has_prefix(name, key_prefix);
+            bool untyped = !has_prefix(name, IndexKeyPrefix) && !has_prefix(name, BytesKeyPrefix);
+            if (entry.path() != path && (same_key_type || untyped)) {
+                std::filesystem::remove(entry.path(), ec);
+            }
+        }
+
+        // Write to a temporary file first so an interrupted write never leaves a truncated thumbnail in the cache.
+        std::filesystem::path temporary_path = path;
+        temporary_path += TemporaryExtension;
+        {
+            std::ofstream stream(temporary_path, std::ios::binary);
+            ThumbnailCacheHeader header{ ThumbnailCacheMagic, ThumbnailCacheVersion, thumbnail.width, thumbnail.height };
+            stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            stream.write(thumbnail.bytes.data(), thumbnail.bytes.size());
+            if (!stream.good()) {
+                stream.close();
+                std::filesystem::remove(temporary_path, ec);
+                return;
+            }
+        }
+
+        std::filesystem::rename(temporary_path, path, ec);
+        if (ec) {
+            std::filesystem::remove(temporary_path, ec);
+        }
+    }
+
+    static void downscale_rgba32(const uint8_t *src, uint32_t src_width, uint32_t src_height, uint8_t *dst, uint32_t dst_width, uint32_t dst_height) {
+        // Box filter that averages every source pixel covered by a destination pixel. Colors are weighted by alpha so
+        // transparent pixels don't bleed into the edges of the image.
+        for (uint32_t dy = 0; dy < dst_height; dy++) {
+            uint32_t y0 = uint64_t(dy) * src_height / dst_height;
+            uint32_t y1 = std::max<uint32_t>(y0 + 1, uint64_t(dy + 1) * src_height / dst_height);
+            for (uint32_t dx = 0; dx < dst_width; dx++) {
+                uint32_t x0 = uint64_t(dx) * src_width / dst_width;
+                uint32_t x1 = std::max<uint32_t>(x0 + 1, uint64_t(dx + 1) * src_width / dst_width);
+                uint64_t r = 0, g = 0, b = 0, a = 0;
+                for (uint32_t y = y0; y < y1; y++) {
+                    const uint8_t *row = src + (size_t(y) * src_width + x0) * 4;
+                    for (uint32_t x = x0; x < x1; x++, row += 4) {
+                        r += uint32_t(row[0]) * row[3];
+                        g += uint32_t(row[1]) * row[3];
+                        b += uint32_t(row[2]) * row[3];
+                        a += row[3];
+                    }
+                }
+
+                uint64_t count = uint64_t(x1 - x0) * (y1 - y0);
+                uint8_t *out = dst + (size_t(dy) * dst_width + dx) * 4;
+                if (a > 0) {
+                    out[0] = uint8_t((r + a / 2) / a);
+                    out[1] = uint8_t((g + a / 2) / a);
+                    out[2] = uint8_t((b + a / 2) / a);
+                }
+                else {
+                    out[0] = out[1] = out[2] = 0;
+                }
+                out[3] = uint8_t((a + count / 2) / count);
+            }
+        }
+    }
+
+    static bool decode_thumbnail(const std::vector<char> &bytes, ModThumbnail &thumbnail) {
+        int width, height, channels;
+        uint8_t *pixels = stbi_load_from_memory(reinterpret_cast<const uint8_t *>(bytes.data()), int(bytes.size()), &width, &height, &channels, 4);
+        if (pixels == nullptr) {
+            return false;
+        }
+
+        uint32_t src_width = uint32_t(width);
+        uint32_t src_height = uint32_t(height);
+        uint32_t largest = std::max(src_width, src_height);
+        if (largest <= ModThumbnailSize) {
+            thumbnail.width = src_width;
+            thumbnail.height = src_height;
+            thumbnail.bytes.assign(reinterpret_cast<const char *>(pixels), reinterpret_cast<const char *>(pixels) + size_t(src_width) * src_height * 4);
+        }
+        else {
+            // Keep the aspect ratio of the original image.
+            thumbnail.width = std::max<uint32_t>(1, uint64_t(src_width) * ModThumbnailSize / largest);
+            thumbnail.height = std::max<uint32_t>(1, uint64_t(src_height) * ModThumbnailSize / largest);
+            thumbnail.bytes.resize(size_t(thumbnail.width) * thumbnail.height * 4);
+            downscale_rgba32(pixels, src_width, src_height, reinterpret_cast<uint8_t *>(thumbnail.bytes.data()), thumbnail.width, thumbnail.height);
+        }
+
+        stbi_image_free(pixels);
+        return true;
+    }
+
+    static ModThumbnail load_thumbnail(ThumbnailRequest &request) {
+        ModThumbnail thumbnail;
+        thumbnail.src = std::move(request.src);
+        thumbnail.generation = request.generation;
+
+        uint64_t hash = request.from_index ? hash_index_entry(request.index_entry) : hash_thumbnail_bytes(request.bytes);
+        const std::string &key_prefix = request.from_index ? IndexKeyPrefix : BytesKeyPrefix;
+        char cache_name[64];
+        snprintf(cache_name, sizeof(cache_name), "%s%016llx_%u", key_prefix.c_str(), (unsigned long long)(hash), ModThumbnailSize);
+        std::filesystem::path cache_path = get_thumbnail_cache_directory(request.mod_id) / cache_name;
+        cache_path += ThumbnailCacheExtension;
+
+        if (read_cached_thumbnail(cache_path, thumbnail)) {
+            return thumbnail;
+        }
+
+        if (request.from_index && !read_mod_index_file(request.index_entry, request.index_entry.thumbnail_file, request.bytes)) {
+            // Leaving the bytes empty tells the menu there's nothing to upload.
+            thumbnail.bytes.clear();
+            return thumbnail;
+        }
+
+        if (decode_thumbnail(request.bytes, thumbnail)) {
+            write_cached_thumbnail(cache_path, key_prefix, thumbnail);
+        }
+        else {
+            // Formats that can't be decoded here (e.g. DDS) are handed to the renderer untouched.
+            thumbnail.width = 0;
+            thumbnail.height = 0;
+            thumbnail.bytes = std::move(request.bytes);
+            thumbnail.is_file = true;
+        }
+
+        return thumbnail;
+    }
+
+    class ThumbnailLoader {
+    private:
+        std::mutex request_mutex;
+        std::condition_variable request_cv;
+        std::deque<ThumbnailRequest> requests;
+        moodycamel::ConcurrentQueue<ModThumbnail> results;
+        std::thread thread;
+        bool stopping = false;
+
+        void thread_func() {
+            while (true) {
+                ThumbnailRequest request;
+                {
+                    std::unique_lock lock{ request_mutex };
+                    request_cv.wait(lock, [this]() { return stopping || !requests.empty(); });
+                    if (stopping) {
+                        return;
+                    }
+
+                    request = std::move(requests.front());
+                    requests.pop_front();
+                }
+
+                results.enqueue(load_thumbnail(request));
+            }
+        }
+    public:
+        ~ThumbnailLoader() {
+            if (thread.joinable()) {
+                {
+                    std::lock_guard lock{ request_mutex };
+                    stopping = true;
+                }
+
+                request_cv.notify_one();
+                thread.join();
+            }
+        }
+
+        void queue(ThumbnailRequest &&request) {
+            {
+                std::lock_guard lock{ request_mutex };
+                requests.emplace_back(std::move(request));
+
+                // The thread is only started once a thumbnail is actually requested.
+                if (!thread.joinable()) {
+                    thread = std::thread([this]() { thread_func(); });
+                }
+            }
+
+            request_cv.notify_one();
+        }
+
+        bool try_get_result(ModThumbnail &thumbnail) {
+            return results.try_dequeue(thumbnail);
+        }
+    };
+
+    static ThumbnailLoader thumbnail_loader;
+
+    void queue_mod_thumbnail(const std::string &src, uint32_t generation, const std::string &mod_id, std::vector<char> &&thumbnail_bytes) {
+        thumbnail_loader.queue(ThumbnailRequest{ .src = src, .generation = generation, .mod_id = mod_id, .bytes = std::move(thumbnail_bytes) });
+    }
+
+    void queue_mod_thumbnail_from_index(const std::string &src, uint32_t generation, const ModIndexEntry &entry) {
+        thumbnail_loader.queue(ThumbnailRequest{ .src = src, .generation = generation, .mod_id = entry.mod_id, .from_index = true, .index_entry = entry });
+    }
+
+    bool get_loaded_mod_thumbnail(ModThumbnail &thumbnail) {
+        return thumbnail_loader.try_get_result(thumbnail);
+    }
+};
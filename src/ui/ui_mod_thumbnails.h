@@ -0,0 +1,39 @@
+#ifndef RECOMPUI_MOD_THUMBNAILS_H
+#define RECOMPUI_MOD_THUMBNAILS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ui_mod_index.h"
+
+namespace recompui {
+    // Largest dimension in pixels that mod thumbnails are downscaled to. Thumbnails are displayed at 120dp at most,
+    // so this leaves headroom for high DPI displays.
+    constexpr uint32_t ModThumbnailSize = 256;
+
+    struct ModThumbnail {
+        std::string src;
+        uint32_t generation = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        // RGBA32 pixels, or the original file bytes if the image couldn't be decoded.
+        std::vector<char> bytes;
+        bool is_file = false;
+    };
+
+    // Queues a mod thumbnail to be decoded and downscaled on a background thread. The downscaled image is stored in an
+    // on-disk cache keyed by the mod ID, the hash of the thumbnail and the target size, so later requests for the same
+    // thumbnail skip decoding entirely.
+    void queue_mod_thumbnail(const std::string &src, uint32_t generation, const std::string &mod_id, std::vector<char> &&thumbnail_bytes);
+
+    // Same as queue_mod_thumbnail, but for a mod found in the mod index. The cache is keyed by the mod file instead of
+    // the thumbnail's contents, so a cached thumbnail is used without opening the mod at all.
+    void queue_mod_thumbnail_from_index(const std::string &src, uint32_t generation, const ModIndexEntry &entry);
+
+    // Retrieves a thumbnail that has finished loading. Must be called from the UI thread, which is responsible for
+    // uploading the image. Thumbnails that couldn't be read have no bytes.
+    bool get_loaded_mod_thumbnail(ModThumbnail &thumbnail);
+};
+
+#endif
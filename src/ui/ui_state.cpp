@@ -4,6 +4,7 @@
 #else
 #include <SDL2/SDL_video.h>
 #endif
+#include <algorithm>
 #include <chrono>
 
 #include "rt64_render_hooks.h"
@@ -25,6 +26,7 @@
 #include "ui_elements.h"
 #include "ui_mod_menu.h"
 #include "ui_mod_installer.h"
+#include "ui_mod_index.h"
 #include "ui_renderer.h"
 
 bool can_focus(Rml::Element* element) {
@@ -155,12 +157,137 @@ struct ContextDetails {
     Rml::ElementDocument* document;
 };
 
+// Font sizes used by the stylesheet and the menus, in dp.
+static const float prewarm_font_sizes[] = { 15.0f, 18.0f, 20.0f, 28.0f, 32.0f, 36.0f, 40.0f, 52.0f, 56.0f, 68.0f };
+
+struct PrewarmFontFace {
+    const char* family;
+    Rml::Style::FontStyle style;
+    Rml::Style::FontWeight weight;
+    bool prompt_glyphs;
+};
+
+static const PrewarmFontFace prewarm_font_faces[] = {
+    { "chiaro", Rml::Style::FontStyle::Normal, Rml::Style::FontWeight::Normal, false },
+    { "chiaro", Rml::Style::FontStyle::Normal, Rml::Style::FontWeight::Bold, false },
+    { "latolatin", Rml::Style::FontStyle::Normal, Rml::Style::FontWeight::Normal, false },
+    { "latolatin", Rml::Style::FontStyle::Normal, Rml::Style::FontWeight::Bold, false },
+    { "promptfont", Rml::Style::FontStyle::Normal, Rml::Style::FontWeight::Normal, true },
+};
+
+// Codepoint ranges that promptfont.h defines glyphs for, outside of ASCII.
+static const std::pair<char32_t, char32_t> prompt_glyph_ranges[] = {
+    { 0x2194, 0x2219 }, { 0x2264, 0x2284 }, { 0x2316, 0x2316 }, { 0x23CD, 0x23D2 }, { 0x23F4, 0x23F7 },
+    { 0x2423, 0x243F }, { 0x2460, 0x246B }, { 0x248F, 0x248F }, { 0x24F5, 0x24FF }, { 0x2605, 0x2605 },
+    { 0x2620, 0x2620 }, { 0x2639, 0x263A }, { 0x2661, 0x2665 }, { 0x2673, 0x2685 }, { 0x2691, 0x2699 },
+    { 0x2717, 0x2717 }, { 0x2753, 0x2757 }, { 0x278A, 0x2791 }, { 0x27F0, 0x27FC }, { 0x2B1B, 0x2B1B },
+    { 0xE000, 0xE011 }, { 0xFF10, 0xFF3A },
+};
+
+// Number of glyphs measured at a time, and how long the UI thread spends prewarming per frame.
+static constexpr size_t prewarm_glyphs_per_slice = 16;
+static constexpr std::chrono::microseconds prewarm_frame_budget{ 1000 };
+
+// Rasterizes the glyphs that the menus commonly use into RmlUi's font cache, which would otherwise happen the first
+// time a menu shows text at a given size. RmlUi isn't thread-safe, so this runs on the UI thread a few glyphs at a time
+// every frame instead of stalling a single frame. The atlas textures themselves still get uploaded lazily when first
+// rendered.
+class FontPrewarmer {
+    struct Job {
+        const PrewarmFontFace* face;
+        int size_px;
+        const Rml::String* glyphs;
+    };
+
+    std::vector<Rml::String> ascii_slices;
+    std::vector<Rml::String> prompt_slices;
+    std::vector<Job> jobs;
+    size_t next_job = 0;
+
+    static void add_slices(std::vector<Rml::String>& slices, const std::vector<char32_t>& codepoints) {
+        for (size_t i = 0; i < codepoints.size(); i += prewarm_glyphs_per_slice) {
+            Rml::String slice;
+            for (size_t j = i; j < std::min(i + prewarm_glyphs_per_slice, codepoints.size()); j++) {
+                slice += Rml::StringUtilities::ToUTF8(static_cast<Rml::Character>(codepoints[j]));
+            }
+            slices.emplace_back(std::move(slice));
+        }
+    }
+public:
+    void start(float dp_ratio) {
+        std::vector<char32_t> ascii_codepoints;
+        for (char32_t c = 0x20; c < 0x7F; c++) {
+            ascii_codepoints.push_back(c);
+        }
+
+        std::vector<char32_t> prompt_codepoints = ascii_codepoints;
+        for (const auto& [first, last] : prompt_glyph_ranges) {
+            for (char32_t codepoint = first; codepoint <= last; codepoint++) {
+                prompt_codepoints.push_back(codepoint);
+            }
+        }
+
+        ascii_slices.clear();
+        prompt_slices.clear();
+        add_slices(ascii_slices, ascii_codepoints);
+        add_slices(prompt_slices, prompt_codepoints);
+
+        jobs.clear();
+        next_job = 0;
+        for (const PrewarmFontFace& face : prewarm_font_faces) {
+            for (float size_dp : prewarm_font_sizes) {
+                // RmlUi truncates the computed font size when picking a face handle, so do the same here.
+                int size_px = static_cast<int>(size_dp * dp_ratio);
+                if (size_px <= 0) {
+                    continue;
+                }
+
+                for (const Rml::String& slice : face.prompt_glyphs ? prompt_slices : ascii_slices) {
+                    jobs.emplace_back(Job{ &face, size_px, &slice });
+                }
+            }
+        }
+    }
+
+    // Measures slices until the budget runs out. Must be called on the UI thread.
+    void step(std::chrono::microseconds budget) {
+        if (next_job >= jobs.size()) {
+            return;
+        }
+
+        Rml::FontEngineInterface* font_engine = Rml::GetFontEngineInterface();
+        if (font_engine == nullptr) {
+            next_job = jobs.size();
+            return;
+        }
+
+        const Rml::String language;
+        Rml::TextShapingContext shaping_context{ language };
+        auto deadline = std::chrono::steady_clock::now() + budget;
+        do {
+            const Job& job = jobs[next_job++];
+            Rml::FontFaceHandle handle = font_engine->GetFontFaceHandle(job.face->family, job.face->style, job.face->weight, job.size_px);
+            if (handle != 0) {
+                // Measuring the string loads every glyph in it that isn't cached yet.
+                font_engine->GetStringWidth(handle, *job.glyphs, shaping_context);
+            }
+        } while (next_job < jobs.size() && std::chrono::steady_clock::now() < deadline);
+
+        if (next_job >= jobs.size()) {
+            jobs.clear();
+            ascii_slices.clear();
+            prompt_slices.clear();
+        }
+    }
+};
+
 class UIState {
     Rml::Element* prev_focused = nullptr;
     bool mouse_is_active_changed = false;
     std::unique_ptr<recompui::MenuController> launcher_menu_controller{};
     std::unique_ptr<recompui::MenuController> config_menu_controller{};
     std::vector<ContextDetails> shown_contexts{};
+    FontPrewarmer font_prewarmer;
 public:
     bool mouse_is_active_initialized = false;
     bool mouse_is_active = false;
@@ -244,6 +371,14 @@ public:
         render_interface.reset();
     }
 
+    void start_font_prewarm(float dp_ratio) {
+        font_prewarmer.start(dp_ratio);
+    }
+
+    void step_font_prewarm() {
+        font_prewarmer.step(prewarm_frame_budget);
+    }
+
     void update_primary_input(bool mouse_moved, bool non_mouse_interacted) {
         mouse_is_active_changed = false;
         if (non_mouse_interacted) {
@@ -357,6 +492,7 @@ public:
         //     context.close();
         // }
 
+        context.set_shown(true);
         document->PullToFront();
         document->Show();
         recompui::Element* default_element = context.get_autofocus_element();
@@ -373,11 +509,13 @@ public:
         }
         shown_contexts.erase(remove_it, shown_contexts.end());
 
+        context.set_shown(false);
         context.get_document()->Hide();
     }
     
     void hide_all_contexts() {
         for (auto& context : shown_contexts) {
+            context.context.set_shown(false);
             context.document->Hide();
         }
 
@@ -452,6 +590,15 @@ void init_hook(plume::RenderInterface* interface, plume::RenderDevice* device) {
 #endif
     ui_state = std::make_unique<UIState>(window, interface, device);
     ui_state->create_menus();
+
+    // Rasterize glyphs for the scale the UI will be drawn at over the first frames.
+    int width, height;
+    recompui::get_window_size(width, height);
+    ui_state->start_font_prewarm(height / 1080.0f);
+
+    // Index the mods folder in the background so the mod menu can skip opening mods whose thumbnails are cached. This
+    // also records the mod files the runtime scanned at startup, which later refreshes are compared against.
+    recompui::refresh_mod_index();
 }
 
 moodycamel::ConcurrentQueue<SDL_Event> ui_event_queue{};
@@ -564,6 +711,8 @@ void draw_hook(plume::RenderCommandList* command_list, plume::RenderFramebuffer*
 
     std::lock_guard lock{ ui_state_mutex };
 
+    ui_state->step_font_prewarm();
+
     SDL_Event cur_event{};
 
     bool mouse_moved = false;
@@ -779,6 +928,8 @@ void draw_hook(plume::RenderCommandList* command_list, plume::RenderFramebuffer*
 }
 
 void deinit_hook() {
+    // The mod index can queue a mod list refresh when it finishes, so it has to be stopped before the menus are gone.
+    recompui::wait_for_mod_index();
     recompui::destroy_all_contexts();
 
     std::lock_guard lock {ui_state_mutex};